@@ -0,0 +1,44 @@
+#include <graphics/camera.h>
+#include <graphics/renderer/renderer.h>
+#include <math/vec.h>
+
+#include <dll_defines.h>
+
+#include <iostream>
+
+#if defined(RENDERER_OPENGL)
+#error "The benchmark draws no frame on its own: set RENDERER_TYPE to the renderer to file or to the rasterizer"
+#endif
+
+int main()
+{
+    // Initialize a camera object
+    Camera main_camera = Camera{1.0f, 1000.0f, 512, 512};
+    main_camera.set_position(Vec3f::zero());
+    // Initialize a renderer object
+    Renderer& global_renderer = Renderer::get_instance();
+    global_renderer.initialize(main_camera, Vec3f::zero());
+    // Compare tracing every camera ray with reading the first hits from a rasterized visibility buffer, on the default scene
+    // A first frame is computed beforehand, so that both modes are measured with warm caches
+    auto constexpr frame_count = 5u;
+    global_renderer.measure_frame_time(1);
+    auto const traced_frame_time = global_renderer.measure_frame_time(frame_count);
+    global_renderer.set_hybrid_visibility(true);
+    auto const hybrid_frame_time = global_renderer.measure_frame_time(frame_count);
+    auto const visibility_hit_count = global_renderer.get_visibility_buffer_hit_count();
+    global_renderer.set_hybrid_visibility(false);
+    std::cout << "Frame time (ms): " << traced_frame_time << " tracing every camera ray, " << hybrid_frame_time << " reading the first hits from the visibility buffer ("
+              << visibility_hit_count << " / " << main_camera.get_width() * main_camera.get_height() << " camera rays not traced), speed-up " << traced_frame_time / hybrid_frame_time << std::endl;
+    // Compare single-ray and grouped traversal on a field of spheres too large for the caches, for several group sizes
+    auto constexpr sphere_count = 200000;
+    auto constexpr ray_count = 256u;
+    for (auto const group_size : {64u, 256u})
+    {
+        auto const benchmark = global_renderer.benchmark_traversal(sphere_count, ray_count, group_size);
+        std::cout << "Traversal of " << sphere_count << " spheres (million ray-object tests per second): " << benchmark.single_ray_throughput << " for single rays, " << benchmark.grouped_throughput
+                  << " for groups of " << group_size << " rays" << (benchmark.are_hits_identical ? "" : " (the closest hits differ)") << std::endl;
+    }
+    // Release created objects
+    global_renderer.release();
+    return 0;
+}
@@ -1,8 +1,18 @@
 #include "resource_manager.h"
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 std::string Resource_Manager::read_file(std::string const& filepath)
 {
     std::string contents;
@@ -18,3 +28,52 @@ std::string Resource_Manager::read_file(std::string const& filepath)
     }
     return contents;
 }
+
+std::intptr_t Resource_Manager::open_file_for_random_access(std::string const& filepath)
+{
+#if defined(_WIN32)
+    auto const handle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    return (handle == INVALID_HANDLE_VALUE) ? -1 : reinterpret_cast<std::intptr_t>(handle);
+#else
+    return static_cast<std::intptr_t>(open(filepath.c_str(), O_RDONLY));
+#endif
+}
+
+bool Resource_Manager::read_file_range(std::intptr_t file_handle, std::uint64_t offset, std::size_t size, void* out_data)
+{
+    if (file_handle < 0)
+        return false;
+    auto* out_bytes = static_cast<char*>(out_data);
+    // Positional reads may return fewer bytes than requested, so keep reading until the whole range is filled
+    while (size > 0)
+    {
+#if defined(_WIN32)
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFull);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD read_count = 0;
+        auto const request_count = static_cast<DWORD>((std::min)(size, static_cast<std::size_t>(1u << 30)));
+        if (!ReadFile(reinterpret_cast<HANDLE>(file_handle), out_bytes, request_count, &read_count, &overlapped) || read_count == 0)
+            return false;
+#else
+        auto const read_count = pread(static_cast<int>(file_handle), out_bytes, size, static_cast<off_t>(offset));
+        if (read_count <= 0)
+            return false;
+#endif
+        out_bytes += read_count;
+        offset += read_count;
+        size -= read_count;
+    }
+    return true;
+}
+
+void Resource_Manager::close_file(std::intptr_t file_handle)
+{
+    if (file_handle < 0)
+        return;
+#if defined(_WIN32)
+    CloseHandle(reinterpret_cast<HANDLE>(file_handle));
+#else
+    close(static_cast<int>(file_handle));
+#endif
+}
@@ -2,6 +2,7 @@
 
 #include <dll_defines.h>
 
+#include <cstdint>
 #include <string>
 
 class Resource_Manager
@@ -19,4 +20,27 @@ class Resource_Manager
      * @return The contents of the file, as a string.
      */
     DECLSPECIFIER std::string read_file(std::string const& filepath);
+
+    /**
+     * @brief Opens the file at the given path for positional reads, which can then be performed concurrently from several threads.
+     * @param[in] filepath. Path at which to find the file (including extension).
+     * @return A handle to the opened file, or -1 if the file could not be opened.
+     */
+    DECLSPECIFIER std::intptr_t open_file_for_random_access(std::string const& filepath);
+
+    /**
+     * @brief Reads a range of bytes from a file opened for random access, without modifying any shared file position.
+     * @param[in] file_handle. Handle returned by open_file_for_random_access.
+     * @param[in] offset. Offset, in bytes from the start of the file, at which to start reading.
+     * @param[in] size. Number of bytes to read.
+     * @param[out] out_data. Buffer of at least the given size in which to store the read bytes.
+     * @return True if all requested bytes were read, false otherwise.
+     */
+    DECLSPECIFIER bool read_file_range(std::intptr_t file_handle, std::uint64_t offset, std::size_t size, void* out_data);
+
+    /**
+     * @brief Closes a file opened for random access.
+     * @param[in] file_handle. Handle returned by open_file_for_random_access.
+     */
+    DECLSPECIFIER void close_file(std::intptr_t file_handle);
 };
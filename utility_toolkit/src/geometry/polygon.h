@@ -2,6 +2,7 @@
 
 #include "primitive.h"
 
+#include <algorithm>
 #include <array>
 
 namespace geometry
@@ -39,6 +40,29 @@ template <unsigned N> class Polygon : public Primitive
         return Vec2f{u, v};
     }
 
+    void compute_bounds(Vec3f& out_min, Vec3f& out_max) const override
+    {
+        out_min = m_vertices[0];
+        out_max = m_vertices[0];
+        for (auto i = 1u; i < N; i++)
+        {
+            auto const& vertex = m_vertices[i];
+            out_min = Vec3f{(std::min)(out_min.x(), vertex.x()), (std::min)(out_min.y(), vertex.y()), (std::min)(out_min.z(), vertex.z())};
+            out_max = Vec3f{(std::max)(out_max.x(), vertex.x()), (std::max)(out_max.y(), vertex.y()), (std::max)(out_max.z(), vertex.z())};
+        }
+    }
+
+    void tessellate(unsigned int /*segment_count*/, std::vector<Vec3f>& out_vertices) const override
+    {
+        // Split the (convex) polygon into a fan of triangles around its first vertex, which keeps its winding
+        for (auto i = 1u; i + 1 < N; i++)
+        {
+            out_vertices.push_back(m_vertices[0]);
+            out_vertices.push_back(m_vertices[i]);
+            out_vertices.push_back(m_vertices[i + 1]);
+        }
+    }
+
     void compute_intersection_with(Ray const& ray, culling::Type culling, std::vector<float>& out_intersections) const override
     {
         // Compute the intersection with the plane within which the polygon is located
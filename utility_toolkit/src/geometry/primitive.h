@@ -27,6 +27,21 @@ class Primitive
      */
     virtual Vec2f compute_uv_from_position_on_primitive(Vec3f const& position) const = 0;
 
+    /**
+     * @brief Computes the axis-aligned box bounding this primitive.
+     * @param[out] out_min. Minimum corner of the box.
+     * @param[out] out_max. Maximum corner of the box.
+     */
+    virtual void compute_bounds(Vec3f& out_min, Vec3f& out_max) const = 0;
+
+    /**
+     * @brief Approximates this primitive with triangles, e.g. to rasterize it.
+     * Each triangle is wound so that math::cross(second - first, third - first) points along the primitive's normal, which lets rasterization cull faces as ray tracing does.
+     * @param[in] segment_count. Number of segments around curved primitives (ignored for polygons).
+     * @param[in,out] out_vertices. Vertices to which the triangles are appended, three per triangle.
+     */
+    virtual void tessellate(unsigned int segment_count, std::vector<Vec3f>& out_vertices) const = 0;
+
     /**
      * @brief Computes the intersection between this primitive and a given ray, within a given range.
      * @param[in] ray. Ray, with origin and direction.
@@ -5,6 +5,7 @@
 #include <math/math.h>
 #include <math/vec.h>
 
+#include <algorithm>
 #include <cmath>
 
 namespace geometry
@@ -20,6 +21,46 @@ Vec2f Sphere::compute_uv_from_position_on_primitive(Vec3f const& position) const
     return Vec2f{u, v};
 }
 
+void Sphere::compute_bounds(Vec3f& out_min, Vec3f& out_max) const
+{
+    out_min = m_origin - m_radius;
+    out_max = m_origin + m_radius;
+}
+
+void Sphere::tessellate(unsigned int segment_count, std::vector<Vec3f>& out_vertices) const
+{
+    // Split the sphere along meridians and parallels, each cell giving two triangles but those touching the poles, where one of them is degenerate
+    auto const meridian_count = (std::max)(segment_count, 3u);
+    auto const parallel_count = (std::max)(segment_count / 2, 2u);
+    auto const compute_vertex = [this, meridian_count, parallel_count](unsigned int meridian, unsigned int parallel) {
+        auto const polar_angle = math::pi * parallel / parallel_count;
+        auto const azimuth = 2.0f * math::pi * meridian / meridian_count;
+        return m_origin + m_radius * Vec3f{std::sin(polar_angle) * std::cos(azimuth), std::cos(polar_angle), std::sin(polar_angle) * std::sin(azimuth)};
+    };
+    for (auto parallel = 0u; parallel < parallel_count; parallel++)
+    {
+        for (auto meridian = 0u; meridian < meridian_count; meridian++)
+        {
+            auto const top_left = compute_vertex(meridian, parallel);
+            auto const top_right = compute_vertex(meridian + 1, parallel);
+            auto const bottom_right = compute_vertex(meridian + 1, parallel + 1);
+            auto const bottom_left = compute_vertex(meridian, parallel + 1);
+            if (parallel > 0)
+            {
+                out_vertices.push_back(top_left);
+                out_vertices.push_back(bottom_right);
+                out_vertices.push_back(top_right);
+            }
+            if (parallel + 1 < parallel_count)
+            {
+                out_vertices.push_back(top_left);
+                out_vertices.push_back(bottom_left);
+                out_vertices.push_back(bottom_right);
+            }
+        }
+    }
+}
+
 void Sphere::compute_intersection_with(Ray const& ray, culling::Type culling, std::vector<float>& out_intersections) const
 {
     // Compute the discriminant based on the parametric equations of ray and sphere
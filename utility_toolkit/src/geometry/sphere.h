@@ -24,6 +24,8 @@ class Sphere : public Primitive
 
     Unit_Vec3f compute_normal_from_position_on_primitive(Vec3f const& position) const override;
     Vec2f compute_uv_from_position_on_primitive(Vec3f const& position) const override;
+    void compute_bounds(Vec3f& out_min, Vec3f& out_max) const override;
+    void tessellate(unsigned int segment_count, std::vector<Vec3f>& out_vertices) const override;
     void compute_intersection_with(Ray const& ray, culling::Type culling, std::vector<float>& out_intersections) const override;
 
   private:
@@ -1,10 +1,65 @@
 #include "camera.h"
 
+#include <cmath>
+
 Camera::Camera(float near_plane, float far_plane, int width, int height)
     : Transform{}
     , m_near{near_plane}
     , m_far{far_plane}
     , m_width{width}
     , m_height{height}
+    , m_right{1.0f, 0.0f, 0.0f}
+    , m_up{0.0f, 1.0f, 0.0f}
+    , m_forward{0.0f, 0.0f, 1.0f}
+    , m_image_plane_width{1.0f}
+    , m_image_plane_height{1.0f}
+{
+}
+
+void Camera::set_orientation(Vec3f const& forward, Vec3f const& up)
+{
+    // The cross product is negated in our left-handed basis (X right, Y top, Z forward)
+    m_forward = forward.normalize();
+    m_right = math::cross(m_forward, up).normalize();
+    m_up = math::cross(m_right, m_forward);
+}
+
+void Camera::set_field_of_view(float field_of_view)
+{
+    auto const aspect_ratio = get_aspect_ratio();
+    m_image_plane_height = 2.0f * m_near * std::tan(0.5f * field_of_view);
+    m_image_plane_width = aspect_ratio * m_image_plane_height;
+}
+
+float Camera::get_field_of_view() const { return 2.0f * std::atan(0.5f * m_image_plane_height / m_near); }
+
+float Camera::compute_min_ray_depth() const
+{
+    return m_near * m_near / std::sqrt(m_near * m_near + (m_image_plane_width * m_image_plane_width + m_image_plane_height * m_image_plane_height) * 0.25f);
+}
+
+std::array<Camera, 2> Camera::create_stereo_pair(float eye_separation) const
+{
+    std::array<Camera, 2> eyes{*this, *this};
+    eyes[0].set_position(m_position - (0.5f * eye_separation) * m_right);
+    eyes[1].set_position(m_position + (0.5f * eye_separation) * m_right);
+    return eyes;
+}
+
+std::array<Camera, 6> Camera::create_cube_map_faces() const
 {
+    std::array<Camera, 6> faces{*this, *this, *this, *this, *this, *this};
+    std::array<Vec3f, 6> const forward_directions{Vec3f{1.0f, 0.0f, 0.0f},  Vec3f{-1.0f, 0.0f, 0.0f}, Vec3f{0.0f, 1.0f, 0.0f},
+                                                  Vec3f{0.0f, -1.0f, 0.0f}, Vec3f{0.0f, 0.0f, 1.0f},  Vec3f{0.0f, 0.0f, -1.0f}};
+    std::array<Vec3f, 6> const up_directions{Vec3f{0.0f, 1.0f, 0.0f},  Vec3f{0.0f, 1.0f, 0.0f}, Vec3f{0.0f, 0.0f, -1.0f},
+                                             Vec3f{0.0f, 0.0f, 1.0f}, Vec3f{0.0f, 1.0f, 0.0f}, Vec3f{0.0f, 1.0f, 0.0f}};
+    for (auto face_it = 0u; face_it < faces.size(); face_it++)
+    {
+        auto& face = faces[face_it];
+        face.set_orientation(forward_directions[face_it], up_directions[face_it]);
+        // A 90 degree field of view makes the image plane as wide and high as twice the near distance
+        face.m_image_plane_width = 2.0f * m_near;
+        face.m_image_plane_height = 2.0f * m_near;
+    }
+    return faces;
 }
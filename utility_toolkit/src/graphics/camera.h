@@ -1,9 +1,17 @@
 #pragma once
 
 #include <graphics/transform.h>
+#include <math/vec.h>
 
 #include <dll_defines.h>
 
+#include <array>
+
+/**
+ * @brief Pinhole camera, casting its rays from its position through an image plane at its near distance, along an orthonormal basis computed when the camera is oriented.
+ * The camera ray through the point (u, v) of the image plane, with u and v between -0.5 and 0.5, goes along u * width * right + v * height * up + near * forward,
+ * where width and height are the image plane's extents. By default, the camera looks along Z with Y upwards, and its image plane is one unit wide and high.
+ */
 class Camera : public Transform
 {
   public:
@@ -16,10 +24,91 @@ class Camera : public Transform
     DECLSPECIFIER float const& get_far() const { return m_far; }
     DECLSPECIFIER int const& get_width() const { return m_width; }
     DECLSPECIFIER int const& get_height() const { return m_height; }
+    DECLSPECIFIER Vec3f const& get_right() const { return m_right; }
+    DECLSPECIFIER Vec3f const& get_up() const { return m_up; }
+    DECLSPECIFIER Vec3f const& get_forward() const { return m_forward; }
+    DECLSPECIFIER float get_image_plane_width() const { return m_image_plane_width; }
+    DECLSPECIFIER float get_image_plane_height() const { return m_image_plane_height; }
+
+    /**
+     * @brief Orients the camera, computing its basis once rather than for each ray.
+     * @param[in] forward. Direction in which the camera looks.
+     * @param[in] up. Upward direction, made orthogonal to the forward one.
+     */
+    DECLSPECIFIER void set_orientation(Vec3f const& forward, Vec3f const& up);
+
+    /**
+     * @brief Sets the vertical field of view, which scales the image plane while keeping its aspect ratio.
+     * @param[in] field_of_view. Vertical angle seen by the camera, in radians.
+     */
+    DECLSPECIFIER void set_field_of_view(float field_of_view);
+
+    /**
+     * @brief Gets the vertical field of view, 2 * atan(0.5 / near) by default.
+     * @return The vertical angle seen by the camera, in radians.
+     */
+    DECLSPECIFIER float get_field_of_view() const;
+
+    /**
+     * @brief Sets the ratio of the image plane's width to its height, keeping its height.
+     * @param[in] aspect_ratio. Ratio of the width to the height, one by default.
+     */
+    DECLSPECIFIER void set_aspect_ratio(float aspect_ratio) { m_image_plane_width = aspect_ratio * m_image_plane_height; }
+
+    /**
+     * @brief Gets the ratio of the image plane's width to its height.
+     * @return The aspect ratio.
+     */
+    DECLSPECIFIER float get_aspect_ratio() const { return m_image_plane_width / m_image_plane_height; }
+
+    /**
+     * @brief Computes the direction of the camera ray through a point of the image plane.
+     * @param[in] u. Horizontal coordinate of the point, between -0.5 and 0.5.
+     * @param[in] v. Vertical coordinate of the point, between -0.5 and 0.5.
+     * @return The world-space direction of the ray, not normalized.
+     */
+    DECLSPECIFIER Vec3f compute_ray_direction(float u, float v) const { return (u * m_image_plane_width) * m_right + (v * m_image_plane_height) * m_up + m_near * m_forward; }
+
+    /**
+     * @brief Transforms a world-space position to the camera's view space, scaled so that the camera ray through the point (u, v) of the image plane goes through the point (u, v, near).
+     * Points are thus projected to the image plane as (near * x / z, near * y / z), z being their depth along the forward direction.
+     * @param[in] position. World-space position.
+     * @return The view-space position.
+     */
+    DECLSPECIFIER Vec3f to_view_space(Vec3f const& position) const
+    {
+        auto const offset = position - m_position;
+        return Vec3f{offset.dot(m_right) / m_image_plane_width, offset.dot(m_up) / m_image_plane_height, offset.dot(m_forward)};
+    }
+
+    /**
+     * @brief Computes the smallest depth of the points that camera rays reach at the near distance, i.e. those of the rays through the image plane's corners.
+     * @return The depth along the forward direction.
+     */
+    DECLSPECIFIER float compute_min_ray_depth() const;
+
+    /**
+     * @brief Creates the cameras of a stereo pair centered on this camera, offset along its right direction, with the same orientation and intrinsics.
+     * @param[in] eye_separation. Distance between the two cameras.
+     * @return The cameras of the left and right eyes, in that order.
+     */
+    DECLSPECIFIER std::array<Camera, 2> create_stereo_pair(float eye_separation) const;
+
+    /**
+     * @brief Creates the cameras of the six faces of a cube map centered on this camera's position, each seeing a square 90 degree field of view at this camera's near and far distances.
+     * The faces looking sideways keep Y upwards, the face looking along +Y has -Z upwards and the face looking along -Y has +Z upwards.
+     * @return The cameras looking along +X, -X, +Y, -Y, +Z and -Z, in that order.
+     */
+    DECLSPECIFIER std::array<Camera, 6> create_cube_map_faces() const;
 
   private:
-    float m_near; // Near plane of the camera
-    float m_far;  // Far plane of the camera
-    int m_width;  // Width of the associated framebuffer
-    int m_height; // Height of the associated framebuffer
+    float m_near;               // Near plane of the camera
+    float m_far;                // Far plane of the camera
+    int m_width;                // Width of the associated framebuffer
+    int m_height;               // Height of the associated framebuffer
+    Vec3f m_right;              // Unit direction towards the right of the image
+    Vec3f m_up;                 // Unit direction towards the top of the image
+    Vec3f m_forward;            // Unit direction in which the camera looks
+    float m_image_plane_width;  // Width of the image plane at the near distance
+    float m_image_plane_height; // Height of the image plane at the near distance
 };
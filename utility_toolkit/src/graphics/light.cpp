@@ -4,6 +4,7 @@
 #include <math/math.h>
 #include <math/vec.h>
 
+#include <algorithm>
 #include <cmath>
 
 Light::Light()
@@ -17,6 +18,9 @@ Light::Light(Light_Type type, float intensity, Vec3f const& position_or_directio
     , m_intensity{intensity}
     , m_color{color}
     , m_direction{Unit_Vec3f::zero()}
+    , m_first_axis{Vec3f::zero()}
+    , m_second_axis{Vec3f::zero()}
+    , m_bounding_radius{0.0f}
 {
     if (type == Light_Type::directional)
     {
@@ -25,9 +29,37 @@ Light::Light(Light_Type type, float intensity, Vec3f const& position_or_directio
     }
 }
 
+Light::Light(Light_Type type, float intensity, Vec3f const& position, Vec3f const& normal, Vec2f const& extent, Vec3f const& color)
+    : Transform{position}
+    , m_type{type}
+    , m_intensity{intensity}
+    , m_color{color}
+    , m_direction{normal}
+    , m_first_axis{Vec3f::zero()}
+    , m_second_axis{Vec3f::zero()}
+    , m_bounding_radius{0.0f}
+{
+    // Build an orthonormal basis of the light's surface around its normal
+    auto first_direction = Vec3f::zero();
+    auto second_direction = Vec3f::zero();
+    math::compute_orthonormal_basis(m_direction, first_direction, second_direction);
+    if (type == Light_Type::rectangle)
+    {
+        m_first_axis = extent.x() * first_direction;
+        m_second_axis = extent.y() * second_direction;
+        m_bounding_radius = extent.length();
+    }
+    else
+    {
+        m_first_axis = extent.x() * first_direction;
+        m_second_axis = extent.x() * second_direction;
+        m_bounding_radius = extent.x();
+    }
+}
+
 Unit_Vec3f Light::compute_point_to_light_direction(Vec3f const& point_position) const
 {
-    if (m_type == Light_Type::point)
+    if (is_positional())
     {
         auto const point_to_light = (m_position - point_position);
         return point_to_light.normalize();
@@ -41,7 +73,7 @@ Unit_Vec3f Light::compute_point_to_light_direction(Vec3f const& point_position)
 
 float Light::compute_point_to_light_distance(Vec3f const& point_position) const
 {
-    if (m_type == Light_Type::point)
+    if (is_positional())
     {
         auto const point_to_light = (m_position - point_position);
         return point_to_light.length();
@@ -56,8 +88,56 @@ float Light::compute_point_to_light_distance(Vec3f const& point_position) const
 Vec3f Light::compute_radiance(float const& light_distance) const
 {
     float attenuation = 1.0f;
-    if (m_type == Light_Type::point)
+    if (is_positional())
         attenuation = 1.0f / (light_distance * light_distance);
     auto const radiance = m_intensity * m_color * attenuation;
     return radiance;
 }
+
+float Light::compute_influence_radius(float radiance_threshold) const
+{
+    if (!is_positional() || radiance_threshold <= 0.0f)
+        return math::numeric_infinity();
+    // Invert the inverse-square attenuation for the brightest channel of the light's color, and account for the extent of area lights
+    auto const max_radiance = m_intensity * (std::max)(m_color.x(), (std::max)(m_color.y(), m_color.z()));
+    return std::sqrt((std::max)(max_radiance, 0.0f) / radiance_threshold) + m_bounding_radius;
+}
+
+Vec3f Light::sample_position(Vec2f const& sample, Vec3f const& point_position) const
+{
+    if (m_type == Light_Type::rectangle)
+    {
+        return m_position + (2.0f * sample.x() - 1.0f) * m_first_axis + (2.0f * sample.y() - 1.0f) * m_second_axis;
+    }
+    else if (m_type == Light_Type::disk || m_type == Light_Type::sphere)
+    {
+        // Concentric mapping of the unit square to the unit disk, which preserves stratification
+        auto const offset_x = 2.0f * sample.x() - 1.0f;
+        auto const offset_y = 2.0f * sample.y() - 1.0f;
+        if (offset_x == 0.0f && offset_y == 0.0f)
+            return m_position;
+        auto radius = 0.0f;
+        auto angle = 0.0f;
+        if (std::abs(offset_x) > std::abs(offset_y))
+        {
+            radius = offset_x;
+            angle = 0.25f * math::pi * (offset_y / offset_x);
+        }
+        else
+        {
+            radius = offset_y;
+            angle = 0.5f * math::pi - 0.25f * math::pi * (offset_x / offset_y);
+        }
+        auto const disk_x = radius * std::cos(angle);
+        auto const disk_y = radius * std::sin(angle);
+        if (m_type == Light_Type::disk)
+            return m_position + disk_x * m_first_axis + disk_y * m_second_axis;
+        // Spheres are sampled on the disk facing the point, which is what the point sees of them
+        Unit_Vec3f const facing_direction = (point_position - m_position).normalize();
+        auto first_direction = Vec3f::zero();
+        auto second_direction = Vec3f::zero();
+        math::compute_orthonormal_basis(facing_direction, first_direction, second_direction);
+        return m_position + m_bounding_radius * (disk_x * first_direction + disk_y * second_direction);
+    }
+    return m_position;
+}
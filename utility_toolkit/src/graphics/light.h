@@ -9,7 +9,10 @@ enum class DECLSPECIFIER Light_Type
 {
     ambient,
     directional,
-    point
+    point,
+    rectangle, // One-sided rectangular area light
+    disk,      // One-sided circular area light
+    sphere     // Spherical area light
 };
 
 class Light : public Transform
@@ -17,6 +20,16 @@ class Light : public Transform
   public:
     DECLSPECIFIER Light();
     DECLSPECIFIER Light(Light_Type type, float intensity, Vec3f const& position_or_direction = Vec3f::zero(), Vec3f const& color = Vec3f::one());
+    /**
+     * @brief Creates an area light.
+     * @param[in] type. Shape of the light (rectangle, disk or sphere).
+     * @param[in] intensity. Intensity of the light.
+     * @param[in] position. Center of the light.
+     * @param[in] normal. Direction towards which the light emits (unused for spheres).
+     * @param[in] extent. Half-width and half-height of a rectangle, or radius (first component) of a disk or sphere.
+     * @param[in] color. Color of the light.
+     */
+    DECLSPECIFIER Light(Light_Type type, float intensity, Vec3f const& position, Vec3f const& normal, Vec2f const& extent, Vec3f const& color = Vec3f::one());
     DECLSPECIFIER ~Light() = default;
     DECLSPECIFIER Light(Light const& other) = default;
     DECLSPECIFIER Light& operator=(Light const& other) = default;
@@ -25,6 +38,28 @@ class Light : public Transform
     DECLSPECIFIER float const& get_intensity() const { return m_intensity; }
     DECLSPECIFIER Vec3f const& get_direction() const { return m_direction; }
     DECLSPECIFIER Vec3f const& get_color() const { return m_color; }
+    DECLSPECIFIER float get_bounding_radius() const { return m_bounding_radius; }
+
+    /**
+     * @brief Checks whether the light has a surface, from which shadow rays should be sampled.
+     * @return True for rectangle, disk and sphere lights, false otherwise.
+     */
+    DECLSPECIFIER bool is_area_light() const { return m_type == Light_Type::rectangle || m_type == Light_Type::disk || m_type == Light_Type::sphere; }
+
+    /**
+     * @brief Checks whether the light's contribution is attenuated with distance, so that it can be bounded in space.
+     * @return True for point and area lights, false for ambient and directional lights.
+     */
+    DECLSPECIFIER bool is_positional() const { return m_type == Light_Type::point || is_area_light(); }
+
+    /**
+     * @brief Maps a sample of the unit square to a position on the light's surface, as seen from a given point.
+     * Stratified samples of the unit square remain stratified on the light's surface. Spheres are sampled on their silhouette disk as seen from the point.
+     * @param[in] sample. Sample in the [0,1[ x [0,1[ range.
+     * @param[in] point_position. Position of the point from which the light is seen.
+     * @return The sampled position, or the light's position for lights without a surface.
+     */
+    DECLSPECIFIER Vec3f sample_position(Vec2f const& sample, Vec3f const& point_position) const;
 
     /**
      * @brief Computes the direction from a given point to the light, which depends on the light's type.
@@ -47,9 +82,19 @@ class Light : public Transform
      */
     DECLSPECIFIER Vec3f compute_radiance(float const& light_distance) const;
 
+    /**
+     * @brief Computes the distance beyond which the light's radiance falls below the given threshold.
+     * @param[in] radiance_threshold. Radiance below which the light's contribution is considered negligible.
+     * @return The radius of influence of the light, which is infinite for lights that are not attenuated by distance or if the threshold is zero.
+     */
+    DECLSPECIFIER float compute_influence_radius(float radiance_threshold) const;
+
   protected:
-    Light_Type m_type;      // Type of light (ambient, directional, point)
-    float m_intensity;      // Intensity of the light
-    Vec3f m_color;          // Color of the light
-    Unit_Vec3f m_direction; // Direction of the light (for directional lights)
+    Light_Type m_type;       // Type of light (ambient, directional, point, rectangle, disk, sphere)
+    float m_intensity;       // Intensity of the light
+    Vec3f m_color;           // Color of the light
+    Unit_Vec3f m_direction;  // Direction of the light (for directional lights), or direction towards which it emits (for rectangle and disk lights)
+    Vec3f m_first_axis;      // First axis of the light's surface, scaled by its half-width or radius (for rectangle and disk lights)
+    Vec3f m_second_axis;     // Second axis of the light's surface, scaled by its half-height or radius (for rectangle and disk lights)
+    float m_bounding_radius; // Radius of the sphere centered on the light's position that bounds its surface
 };
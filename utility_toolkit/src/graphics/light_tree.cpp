@@ -0,0 +1,196 @@
+#include "light_tree.h"
+
+#include <math/math.h>
+
+#include <algorithm>
+
+namespace
+{
+
+auto constexpr max_lights_per_leaf = 4; // Maximum number of lights in a leaf node
+
+Vec3f component_min(Vec3f const& a, Vec3f const& b) { return Vec3f{(std::min)(a.x(), b.x()), (std::min)(a.y(), b.y()), (std::min)(a.z(), b.z())}; }
+Vec3f component_max(Vec3f const& a, Vec3f const& b) { return Vec3f{(std::max)(a.x(), b.x()), (std::max)(a.y(), b.y()), (std::max)(a.z(), b.z())}; }
+
+/**
+ * @brief Computes the squared distance from a point to an axis-aligned box.
+ * @param[in] point. The point.
+ * @param[in] box_min. Minimum corner of the box.
+ * @param[in] box_max. Maximum corner of the box.
+ * @return The squared distance, or zero if the point is inside the box.
+ */
+float compute_squared_distance_to_box(Vec3f const& point, Vec3f const& box_min, Vec3f const& box_max)
+{
+    auto const offset = component_max(component_max(box_min - point, point - box_max), Vec3f::zero());
+    return offset.dot(offset);
+}
+
+/**
+ * @brief Computes the power of a light, as its intensity weighted by the brightest channel of its color.
+ * @param[in] light. The light.
+ * @return The power of the light.
+ */
+float compute_power(Light const& light)
+{
+    auto const& color = light.get_color();
+    return light.get_intensity() * (std::max)(color.x(), (std::max)(color.y(), color.z()));
+}
+
+} // namespace
+
+void Light_Tree::build(std::vector<Light> const& lights, float radiance_threshold)
+{
+    m_nodes.clear();
+    m_bounded_lights.clear();
+    m_unbounded_lights.clear();
+    m_radiance_threshold = radiance_threshold;
+    for (auto const& light : lights)
+    {
+        if (light.is_positional())
+            m_bounded_lights.push_back(&light);
+        else
+            m_unbounded_lights.push_back(&light);
+    }
+    if (!m_bounded_lights.empty())
+        build_node(0, static_cast<int>(m_bounded_lights.size()));
+}
+
+int Light_Tree::build_node(int first_light, int light_count)
+{
+    // Compute the node's bounds and power
+    auto const node_index = static_cast<int>(m_nodes.size());
+    m_nodes.push_back(Node{});
+    Node node;
+    node.first_light = first_light;
+    node.light_count = light_count;
+    node.position_min = Vec3f{math::numeric_infinity()};
+    node.position_max = Vec3f{-math::numeric_infinity()};
+    node.influence_min = node.position_min;
+    node.influence_max = node.position_max;
+    for (auto i = first_light; i < first_light + light_count; i++)
+    {
+        auto const& light = *m_bounded_lights[i];
+        auto const& position = light.get_position();
+        auto const influence_radius = light.compute_influence_radius(m_radiance_threshold);
+        node.position_min = component_min(node.position_min, position);
+        node.position_max = component_max(node.position_max, position);
+        node.influence_min = component_min(node.influence_min, position - influence_radius);
+        node.influence_max = component_max(node.influence_max, position + influence_radius);
+        node.power += compute_power(light);
+    }
+
+    // Split the lights in two halves along the largest axis of their bounds, unless there are few enough of them to make a leaf
+    if (light_count > max_lights_per_leaf)
+    {
+        auto const extent = node.position_max - node.position_min;
+        auto const axis = (extent.x() >= extent.y() && extent.x() >= extent.z()) ? 0u : (extent.y() >= extent.z()) ? 1u : 2u;
+        auto const begin = m_bounded_lights.begin() + first_light;
+        auto const middle = begin + light_count / 2;
+        std::nth_element(begin, middle, begin + light_count, [axis](Light const* a, Light const* b) { return a->get_position()[axis] < b->get_position()[axis]; });
+        node.first_child = build_node(first_light, light_count / 2);
+        build_node(first_light + light_count / 2, light_count - light_count / 2);
+    }
+    m_nodes[node_index] = node;
+    return node_index;
+}
+
+float Light_Tree::compute_importance(Node const& node, Vec3f const& point_position) const
+{
+    // Use the distance to the lights' bounds, but never less than the bounds' own size, so that large groups of lights are not over-estimated when the point is close to them
+    auto const extent = node.position_max - node.position_min;
+    auto const squared_distance = compute_squared_distance_to_box(point_position, node.position_min, node.position_max);
+    auto const min_squared_distance = (std::max)(0.25f * extent.dot(extent), 1e-4f);
+    return node.power / (std::max)(squared_distance, min_squared_distance);
+}
+
+void Light_Tree::select_lights(Vec3f const& point_position, Light_Selection_Mode mode, unsigned int sample_count, std::vector<Light_Sample>& out_samples) const
+{
+    out_samples.clear();
+    for (auto const* light : m_unbounded_lights)
+        out_samples.push_back(Light_Sample{light, 1.0f});
+    if (m_nodes.empty())
+        return;
+
+    if (mode == Light_Selection_Mode::all)
+    {
+        for (auto const* light : m_bounded_lights)
+            out_samples.push_back(Light_Sample{light, 1.0f});
+    }
+    else if (mode == Light_Selection_Mode::culled)
+    {
+        // Traverse the hierarchy, skipping the nodes whose lights cannot reach the point with a significant radiance
+        int node_stack[64];
+        auto stack_size = 0;
+        node_stack[stack_size++] = 0;
+        while (stack_size > 0)
+        {
+            auto const& node = m_nodes[node_stack[--stack_size]];
+            if (compute_squared_distance_to_box(point_position, node.influence_min, node.influence_max) > 0.0f)
+                continue;
+            if (node.first_child >= 0)
+            {
+                node_stack[stack_size++] = node.first_child;
+                node_stack[stack_size++] = node.first_child + 1;
+                continue;
+            }
+            for (auto i = node.first_light; i < node.first_light + node.light_count; i++)
+            {
+                auto const* light = m_bounded_lights[i];
+                auto const radiance = light->compute_radiance(light->compute_point_to_light_distance(point_position));
+                if ((std::max)(radiance.x(), (std::max)(radiance.y(), radiance.z())) >= m_radiance_threshold)
+                    out_samples.push_back(Light_Sample{light, 1.0f});
+            }
+        }
+    }
+    else if (mode == Light_Selection_Mode::stochastic)
+    {
+        // Sample lights by descending the hierarchy, choosing each child in proportion to its estimated contribution
+        for (auto sample_it = 0u; sample_it < sample_count; sample_it++)
+        {
+            auto probability = 1.0f;
+            auto const* node = &m_nodes[0];
+            while (node->first_child >= 0)
+            {
+                auto const& first_child = m_nodes[node->first_child];
+                auto const& second_child = m_nodes[node->first_child + 1];
+                auto const first_importance = compute_importance(first_child, point_position);
+                auto const second_importance = compute_importance(second_child, point_position);
+                if (!(first_importance + second_importance > 0.0f))
+                {
+                    probability = 0.0f;
+                    break;
+                }
+                auto const first_probability = first_importance / (first_importance + second_importance);
+                if (math::generate_random_01() < first_probability)
+                {
+                    node = &first_child;
+                    probability *= first_probability;
+                }
+                else
+                {
+                    node = &second_child;
+                    probability *= (1.0f - first_probability);
+                }
+            }
+            // Choose a light in the leaf in proportion to its unoccluded radiance
+            float light_importances[max_lights_per_leaf];
+            auto total_importance = 0.0f;
+            for (auto i = 0; i < node->light_count; i++)
+            {
+                auto const& light = *m_bounded_lights[node->first_light + i];
+                auto const light_to_point = point_position - light.get_position();
+                light_importances[i] = compute_power(light) / (std::max)(light_to_point.dot(light_to_point), 1e-4f);
+                total_importance += light_importances[i];
+            }
+            if (!(total_importance > 0.0f) || !(probability > 0.0f))
+                continue;
+            auto const random_importance = math::generate_random_01() * total_importance;
+            auto light_it = 0;
+            auto cumulated_importance = light_importances[0];
+            while (light_it + 1 < node->light_count && cumulated_importance <= random_importance)
+                cumulated_importance += light_importances[++light_it];
+            probability *= light_importances[light_it] / total_importance;
+            out_samples.push_back(Light_Sample{m_bounded_lights[node->first_light + light_it], 1.0f / (probability * sample_count)});
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <graphics/light.h>
+#include <math/vec.h>
+
+#include <dll_defines.h>
+
+#include <vector>
+
+/**
+ * @brief Strategies used to select the lights whose contribution is computed in a surface point.
+ */
+enum class DECLSPECIFIER Light_Selection_Mode
+{
+    all,    // Every light is evaluated
+    culled, // Lights whose attenuated radiance falls below a threshold are skipped, using the light tree to discard whole groups of lights
+    stochastic // A few lights are sampled in proportion to their estimated contribution, and weighted by the inverse of their probability
+};
+
+/**
+ * @brief A light selected for a surface point, along with the weight by which to multiply its contribution.
+ */
+struct Light_Sample
+{
+    Light const* light; // Selected light
+    float weight;       // Weight to apply to the light's contribution (one, unless the light was sampled stochastically)
+};
+
+/**
+ * @brief Bounding volume hierarchy built over the lights with a bounded influence (point and area lights), used to cull or sample them.
+ * Lights with an unbounded influence (ambient and directional lights) are kept aside and always selected.
+ */
+class Light_Tree
+{
+  public:
+    Light_Tree() = default;
+    ~Light_Tree() = default;
+    Light_Tree(Light_Tree const& other) = default;
+    Light_Tree& operator=(Light_Tree const& other) = default;
+
+    /**
+     * @brief Builds the hierarchy over the given lights.
+     * @param[in] lights. Lights over which to build the hierarchy. They must outlive the tree and not be reallocated.
+     * @param[in] radiance_threshold. Radiance below which a light's contribution is considered negligible, which bounds each light's radius of influence.
+     */
+    void build(std::vector<Light> const& lights, float radiance_threshold);
+
+    /**
+     * @brief Selects the lights whose contribution to compute in the given point.
+     * @param[in] point_position. World-space position of the surface point.
+     * @param[in] mode. Selection strategy.
+     * @param[in] sample_count. Number of lights to sample in the stochastic mode.
+     * @param[out] out_samples. Selected lights and their weights.
+     */
+    void select_lights(Vec3f const& point_position, Light_Selection_Mode mode, unsigned int sample_count, std::vector<Light_Sample>& out_samples) const;
+
+  private:
+    /**
+     * @brief Node of the hierarchy.
+     */
+    struct Node
+    {
+        Vec3f influence_min = Vec3f::zero(); // Minimum corner of the box bounding the lights' spheres of influence
+        Vec3f influence_max = Vec3f::zero(); // Maximum corner of the box bounding the lights' spheres of influence
+        Vec3f position_min = Vec3f::zero();  // Minimum corner of the box bounding the lights' positions
+        Vec3f position_max = Vec3f::zero();  // Maximum corner of the box bounding the lights' positions
+        float power = 0.0f;                  // Sum of the lights' intensities, weighted by the brightest channel of their color
+        int first_child = -1;                // Index of the first child node (the second one follows it), or -1 for leaves
+        int first_light = 0;                 // Index of the node's first light in the ordered light list
+        int light_count = 0;                 // Number of lights below the node
+    };
+
+    /**
+     * @brief Recursively builds the node covering the given range of the ordered light list.
+     * @param[in] first_light. Index of the first light of the range.
+     * @param[in] light_count. Number of lights in the range.
+     * @return The index of the built node.
+     */
+    int build_node(int first_light, int light_count);
+
+    /**
+     * @brief Estimates the contribution of the lights below a node to the given point.
+     * @param[in] node. The node.
+     * @param[in] point_position. World-space position of the surface point.
+     * @return The estimated contribution (not normalized).
+     */
+    float compute_importance(Node const& node, Vec3f const& point_position) const;
+
+    std::vector<Node> m_nodes;                    // Nodes of the hierarchy, the root being the first one
+    std::vector<Light const*> m_bounded_lights;   // Lights with a bounded influence, ordered so that each node covers a contiguous range
+    std::vector<Light const*> m_unbounded_lights; // Lights with an unbounded influence, always selected
+    float m_radiance_threshold = 0.0f;            // Radiance below which a light's contribution is considered negligible
+};
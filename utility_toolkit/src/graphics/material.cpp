@@ -1,52 +1,94 @@
 #include "material.h"
 
 #include <geometry/ray.h>
-#include <graphics/renderer/renderer.h>
 
-Vec3f Material::apply_lighting_in_point(std::vector<Light> const& lights, Unit_Vec3f const& normal_direction, Vec3f const& camera_position, Vec3f const& point_position, float shadows_near_limit, Vec2f const& uv) const
+void Material::classify()
 {
-    // Compute surface values
+    m_is_constant = m_albedo_texture.is_constant() && m_metallic_map.is_constant() && m_roughness_map.is_constant() && m_ambient_occlusion_map.is_constant();
+    if (m_is_constant)
+        m_constant_parameters = compute_surface_parameters(Vec2f::zero());
+}
+
+Surface_Parameters Material::compute_surface_parameters(Vec2f const& uv) const
+{
+    Surface_Parameters parameters;
+    parameters.albedo = get_albedo(uv);
+    parameters.metallic = get_metallic(uv);
+    parameters.roughness = get_roughness(uv);
+    parameters.ambient_occlusion = get_ambient_occlusion(uv);
+    parameters.base_reflectivity = get_base_reflectivity(parameters.albedo, parameters.metallic);
+    // TODO : make this depend on the material's properties, as the reflective intensity is set arbitrarily for now
+    parameters.reflective_intensity = std::pow(1.0f - parameters.roughness, 5.0f);
+    return parameters;
+}
+
+Vec3f Material::apply_lighting_in_point(Light_Sample const* lights, float const* light_visibilities, unsigned int light_count, Unit_Vec3f const& normal_direction, Vec3f const& camera_position,
+                                        Vec3f const& point_position, Surface_Parameters const& surface) const
+{
+    // A single point only fills the batch's lanes if it has enough lights: callers shading many points at once should share a Lighting_Batch instead
+    thread_local Lighting_Batch lighting_batch;
+    lighting_batch.clear();
+    auto const point_index = lighting_batch.add_point(lights, light_visibilities, light_count, normal_direction, camera_position, point_position, surface);
+    lighting_batch.flush();
+    // The output color is kept in linear HDR: tone mapping and gamma correction are applied once per pixel by the renderer's display transform
+    return lighting_batch.get_color(point_index);
+}
+
+void Lighting_Batch::clear()
+{
+    m_lane_count = 0;
+    m_ambient_lighting.clear();
+    m_outgoing_lighting.clear();
+}
+
+unsigned int Lighting_Batch::add_point(Light_Sample const* lights, float const* light_visibilities, unsigned int light_count, Unit_Vec3f const& normal_direction, Vec3f const& camera_position,
+                                       Vec3f const& point_position, Surface_Parameters const& surface)
+{
+    auto const point_index = static_cast<unsigned int>(m_ambient_lighting.size());
+    m_outgoing_lighting.push_back(Vec3f::zero());
     auto const view_direction = (camera_position - point_position).normalize();
-    auto const ambient_occlusion = get_ambient_occlusion(uv);
-    BRDF_Input brdf_input;
-    brdf_input.albedo = get_albedo(uv);
-    brdf_input.roughness = get_roughness(uv);
-    brdf_input.metallic = get_metallic(uv);
-    brdf_input.base_reflectivity = get_base_reflectivity(brdf_input.albedo, brdf_input.metallic);
+    auto const n_dot_v = (std::max)(normal_direction.dot(view_direction), 0.0f);
 
     // Add each light's contribution
     Vec3f ambient_lighting = Vec3f::zero();
-    Vec3f outgoing_lighting = Vec3f::zero();
-    for (auto const& light : lights)
+    for (auto light_it = 0u; light_it < light_count; light_it++)
     {
-        // Apply ambient lights
+        auto const& light_sample = lights[light_it];
+        auto const& light = *light_sample.light;
         if (light.get_type() == Light_Type::ambient)
         {
-            ambient_lighting += light.get_intensity() * brdf_input.albedo * ambient_occlusion;
+            ambient_lighting += light_sample.weight * light.get_intensity() * surface.albedo * surface.ambient_occlusion;
             continue;
         }
-
-        // Check for shadows: only compute light's contribution if it is not occluded
-        auto const point_to_light_direction = light.compute_point_to_light_direction(point_position);
-        auto const point_to_light_distance = light.compute_point_to_light_distance(point_position);
-        if (Renderer::get_instance().intersects_any_object(geometry::Ray{point_position, point_to_light_direction}, shadows_near_limit, point_to_light_distance, true))
+        // Only compute the contribution of the lights that are not fully occluded, area lights being shaded from their center and scaled by their visible fraction
+        auto const visibility = light_visibilities[light_it];
+        if (visibility <= 0.0f)
             continue;
 
-        // Compute relevant dot products
+        // Compute relevant dot products, and add the light to the batch
+        auto const point_to_light_direction = light.compute_point_to_light_direction(point_position);
+        auto const light_distance = light.compute_point_to_light_distance(point_position);
         auto const halfway_direction = (view_direction + point_to_light_direction).normalize();
-        brdf_input.h_dot_v = (std::max)(halfway_direction.dot(view_direction), 0.0f);
-        brdf_input.n_dot_h = (std::max)(normal_direction.dot(halfway_direction), 0.0f);
-        brdf_input.n_dot_v = (std::max)(normal_direction.dot(view_direction), 0.0f);
-        brdf_input.n_dot_l = (std::max)(normal_direction.dot(point_to_light_direction), 0.0f);
-
-        // Compute the Cook-Torrance bidirectional reflectance distribution function and add it to the outgoing radiance
-        auto const incident_lighting = light.compute_radiance(point_to_light_distance) * brdf_input.n_dot_l;
-        auto const reflected_lighting = brdf_cook_torrance(brdf_input);
-        outgoing_lighting += incident_lighting * reflected_lighting;
+        auto const h_dot_v = (std::max)(halfway_direction.dot(view_direction), 0.0f);
+        auto const n_dot_h = (std::max)(normal_direction.dot(halfway_direction), 0.0f);
+        auto const n_dot_l = (std::max)(normal_direction.dot(point_to_light_direction), 0.0f);
+        m_brdf_batch.set_surface(m_lane_count, surface.albedo, surface.roughness, surface.metallic, surface.base_reflectivity);
+        m_brdf_batch.set_light(m_lane_count, h_dot_v, n_dot_h, n_dot_v, n_dot_l, (light_sample.weight * visibility) * light.compute_radiance(light_distance));
+        m_lane_points[m_lane_count++] = point_index;
+        if (m_lane_count == BRDF_Batch::size)
+            flush();
     }
+    m_ambient_lighting.push_back(ambient_lighting);
+    return point_index;
+}
 
-    // Compute the output color, and apply tone mapping and gamma correction
-    auto color = ambient_lighting + outgoing_lighting;
-    color = gamma_correction(reinhard_tone_mapping(color));
-    return color;
+void Lighting_Batch::flush()
+{
+    // Evaluate the Cook-Torrance bidirectional reflectance distribution function for the pending lanes, and add them to their points
+    if (m_lane_count == 0)
+        return;
+    brdf_cook_torrance_batch(m_brdf_batch, m_lane_count);
+    for (auto lane = 0u; lane < m_lane_count; lane++)
+        m_outgoing_lighting[m_lane_points[lane]] += m_brdf_batch.get_reflected(lane);
+    m_lane_count = 0;
 }
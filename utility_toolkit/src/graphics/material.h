@@ -1,11 +1,80 @@
 #pragma once
 
 #include <graphics/light.h>
+#include <graphics/light_tree.h>
 #include <graphics/physically_based_rendering.h>
 #include <graphics/texture.h>
 
 #include <vector>
 
+/**
+ * @brief Surface parameters of a material in a given point, ready to be used as inputs to the shading methods.
+ */
+struct Surface_Parameters
+{
+    Vec3f albedo = Vec3f::zero();            // Surface color, in linear space
+    float metallic = 0.0f;                   // Metallic value, as a float between 0.0 and 1.0
+    float roughness = 0.0f;                  // Roughness value, remapped for the BRDF methods
+    float ambient_occlusion = 0.0f;          // Additional shadowing factor
+    Vec3f base_reflectivity = Vec3f::zero(); // Base reflectivity, computed as a constant for dielectrics and as albedo for metals
+    float reflective_intensity = 0.0f;       // Weight of the reflected color when tracing reflections
+};
+
+/**
+ * @brief Lights applied to surface points, gathered in batches of BRDF lanes (one lane per light of a point) and evaluated together by the vectorized BRDF kernel.
+ * A batch takes the lights of several points in turn, so that its lanes are filled even when each point has fewer lights than a batch has lanes.
+ */
+class Lighting_Batch
+{
+  public:
+    Lighting_Batch()
+        : m_brdf_batch{}
+        , m_lane_points{}
+        , m_lane_count{0}
+        , m_ambient_lighting{}
+        , m_outgoing_lighting{}
+    {
+    }
+
+    /**
+     * @brief Removes all points, to start shading a new set of points.
+     */
+    void clear();
+
+    /**
+     * @brief Adds the lights of a surface point, evaluating the lanes that fill up. Its color is only complete once flush is called.
+     * @param[in] lights. Lights selected for the surface point, with the weights to apply to their contributions.
+     * @param[in] light_visibilities. Visible fraction of each light from the surface point.
+     * @param[in] light_count. Number of lights.
+     * @param[in] normal_direction. Direction of the normal vector in the surface point.
+     * @param[in] camera_position. World-space position of the view camera.
+     * @param[in] point_position. World-space position of the surface point.
+     * @param[in] surface. Surface parameters in the surface point.
+     * @return The index of the point, from zero in the order of addition since the last clear.
+     */
+    unsigned int add_point(Light_Sample const* lights, float const* light_visibilities, unsigned int light_count, Unit_Vec3f const& normal_direction, Vec3f const& camera_position,
+                           Vec3f const& point_position, Surface_Parameters const& surface);
+
+    /**
+     * @brief Evaluates the remaining lanes, completing the colors of all added points.
+     */
+    void flush();
+
+    /**
+     * @brief Gets the color of an added point, after flush.
+     * @param[in] point_index. Index returned by add_point.
+     * @return The linear HDR color to give to the point, as a three-dimensional vector.
+     */
+    Vec3f get_color(unsigned int point_index) const { return m_ambient_lighting[point_index] + m_outgoing_lighting[point_index]; }
+
+  private:
+    BRDF_Batch m_brdf_batch;                      // Lanes not evaluated yet
+    unsigned int m_lane_points[BRDF_Batch::size]; // Index of the point of each lane
+    unsigned int m_lane_count;                    // Number of lanes not evaluated yet
+    std::vector<Vec3f> m_ambient_lighting;        // Lighting of each point by ambient lights
+    std::vector<Vec3f> m_outgoing_lighting;       // Sum of the evaluated lanes of each point
+};
+
 class Material
 {
   public:
@@ -14,7 +83,10 @@ class Material
         , m_metallic_map{metallic}
         , m_roughness_map{roughness}
         , m_ambient_occlusion_map{ambient_occlusion}
+        , m_is_constant{false}
+        , m_constant_parameters{}
     {
+        classify();
     }
 
     Vec3f get_albedo(Vec2f const& uv) const { return m_albedo_texture.sample(uv).pow(2.2f); }
@@ -25,20 +97,49 @@ class Material
     Vec3f get_base_reflectivity(Vec2f const& uv) const { return get_base_reflectivity(get_albedo(uv), get_metallic(uv)); }
 
     /**
-     * @brief Applies the given set of lights to the given point on the surface with this material.
-     * @param[in] lights. Set of lights in the scene.
+     * @brief Checks whether all of the material's textures are constant, in which case its surface parameters are precomputed and UV coordinates are not needed.
+     * @return True if the material is constant, false otherwise.
+     */
+    bool is_constant() const { return m_is_constant; }
+
+    /**
+     * @brief Gets the surface parameters in the given point, from the precomputed values for constant materials or by sampling the textures otherwise.
+     * @param[in] uv. Texture UV coordinate in the surface point (ignored for constant materials).
+     * @return The surface parameters.
+     */
+    Surface_Parameters get_surface_parameters(Vec2f const& uv) const { return m_is_constant ? m_constant_parameters : compute_surface_parameters(uv); }
+
+    /**
+     * @brief Applies the given set of lights to the given point on the surface with this material, using their visibilities computed beforehand by the renderer.
+     * @param[in] lights. Lights selected for the surface point, with the weights to apply to their contributions.
+     * @param[in] light_visibilities. Visible fraction of each light from the surface point.
+     * @param[in] light_count. Number of lights.
      * @param[in] normal_direction. Direction of the normal vector in the surface point.
      * @param[in] camera_position. World-space position of the view camera.
      * @param[in] point_position. World-space position of the surface point.
-     * @param[in] shadows_near_limit. Near limit for checking whether the surface point is occluded for each of the given lights.
-     * @param[in] uv. Texture UV coordinate in the surface point.
-     * @return The color to give to the point, as a three-dimensional vector.
+     * @param[in] surface. Surface parameters in the surface point, as given by get_surface_parameters.
+     * @return The linear HDR color to give to the point, as a three-dimensional vector.
      */
-    Vec3f apply_lighting_in_point(std::vector<Light> const& lights, Unit_Vec3f const& normal_direction, Vec3f const& camera_position, Vec3f const& point_position, float shadows_near_limit, Vec2f const& uv) const;
+    Vec3f apply_lighting_in_point(Light_Sample const* lights, float const* light_visibilities, unsigned int light_count, Unit_Vec3f const& normal_direction, Vec3f const& camera_position,
+                                  Vec3f const& point_position, Surface_Parameters const& surface) const;
 
   private:
-    Texture m_albedo_texture;        // RGB texture specifying the diffuse surface color
-    Texture m_metallic_map;          // Single-channel texture specifying the extent to which the surface is metallic (1.0) or dielectric (0.0)
-    Texture m_roughness_map;         // Single-channel texture specifying the roughness of the surface
-    Texture m_ambient_occlusion_map; // Single-channel texture specifying an additional shadowing factor for the surface
+    /**
+     * @brief Classifies the material as constant or textured, and precomputes the surface parameters of constant materials.
+     */
+    void classify();
+
+    /**
+     * @brief Computes the surface parameters in the given point by sampling the material's textures.
+     * @param[in] uv. Texture UV coordinate in the surface point.
+     * @return The surface parameters.
+     */
+    Surface_Parameters compute_surface_parameters(Vec2f const& uv) const;
+
+    Texture m_albedo_texture;                 // RGB texture specifying the diffuse surface color
+    Texture m_metallic_map;                   // Single-channel texture specifying the extent to which the surface is metallic (1.0) or dielectric (0.0)
+    Texture m_roughness_map;                  // Single-channel texture specifying the roughness of the surface
+    Texture m_ambient_occlusion_map;          // Single-channel texture specifying an additional shadowing factor for the surface
+    bool m_is_constant;                       // True if all textures are constant
+    Surface_Parameters m_constant_parameters; // Precomputed surface parameters, for constant materials
 };
@@ -16,6 +16,7 @@ class Object : Transform
         , m_primitive{primitive}
         , m_material{material}
     {
+        update_bounds();
     }
     ~Object() = default;
     Object(Object const& other) = default;
@@ -23,9 +24,24 @@ class Object : Transform
 
     geometry::Primitive const& get_primitive() const { return *m_primitive; }
     Material const& get_material() const { return m_material; }
+    Vec3f const& get_bounds_min() const { return m_bounds_min; }
+    Vec3f const& get_bounds_max() const { return m_bounds_max; }
+    void set_primitive(std::shared_ptr<geometry::Primitive> const& primitive)
+    {
+        m_primitive = primitive;
+        update_bounds();
+    }
+    void set_material(Material const& material) { m_material = material; }
 
   private:
+    /**
+     * @brief Computes the world-space box bounding the object's primitive, e.g. to cull the object from the rays that cannot reach it.
+     */
+    void update_bounds() { m_primitive->compute_bounds(m_bounds_min, m_bounds_max); }
+
     std::string m_name;                               // Name of the object
     std::shared_ptr<geometry::Primitive> m_primitive; // Geometry of the object
     Material m_material;                              // Material used to render the object
+    Vec3f m_bounds_min = Vec3f::zero();               // Minimum corner of the world-space box bounding the object
+    Vec3f m_bounds_max = Vec3f::zero();               // Maximum corner of the world-space box bounding the object
 };
@@ -15,7 +15,14 @@ constexpr float dielectric_base_reflectivity = 0.04f; // Approximation of base r
  * @param[in] color. The input color.
  * @return The tone-mapped color.
  */
-static Vec3f reinhard_tone_mapping(Vec3f const& color) { return color / (1.0f + color); }
+inline Vec3f reinhard_tone_mapping(Vec3f const& color) { return color / (1.0f + color); }
+
+/**
+ * @brief Applies Krzysztof Narkowicz's fit of the ACES filmic tone curve.
+ * @param[in] color. The input color.
+ * @return The tone-mapped color.
+ */
+inline Vec3f aces_fitted_tone_mapping(Vec3f const& color) { return (color * (2.51f * color + 0.03f)) / (color * (2.43f * color + 0.59f) + 0.14f); }
 
 /**
  * @brief Applies gamma correction to the given color.
@@ -23,14 +30,14 @@ static Vec3f reinhard_tone_mapping(Vec3f const& color) { return color / (1.0f +
  * @param[in] gamma. The value of gamma (default: 2.2).
  * @return The gamma-corrected color.
  */
-static Vec3f gamma_correction(Vec3f const& color, float gamma = 2.2f) { return color.pow(1.0f / gamma); }
+inline Vec3f gamma_correction(Vec3f const& color, float gamma = 2.2f) { return color.pow(1.0f / gamma); }
 
 /**
  * @brief Remaps roughness values in the 0-1 range to a range more suited to the BRDF methods used here.
  * @param[in] roughness_01. Roughness value between 0 and 1.
  * @return Roughness value that can be used as input to the BRDF methods used here.
  */
-static float roughness_remap(float roughness_01)
+inline float roughness_remap(float roughness_01)
 {
     auto constexpr min = 0.08f;
     auto constexpr max = 1.0f;
@@ -43,7 +50,12 @@ static float roughness_remap(float roughness_01)
  * @param[in] cos_theta. Cosine of the angle between the surface normal and view direction.
  * @return An approximation of the ratio of light that gets reflected over the light that gets refracted.
  */
-static Vec3f fresnel_schlick(Vec3f base_reflectivity, float cos_theta) { return base_reflectivity + (1.0f - base_reflectivity) * std::pow(math::clamp(1.0f - cos_theta, 0.0f, 1.0f), 5.0f); }
+inline Vec3f fresnel_schlick(Vec3f base_reflectivity, float cos_theta)
+{
+    auto const x = math::clamp(1.0f - cos_theta, 0.0f, 1.0f);
+    auto const x_squared = x * x;
+    return base_reflectivity + (1.0f - base_reflectivity) * (x_squared * x_squared * x);
+}
 
 /**
  * @brief Computes the Trowbridge-Reitz, or GGX (ground glass unknown), microfacet normal distribution function.
@@ -51,9 +63,10 @@ static Vec3f fresnel_schlick(Vec3f base_reflectivity, float cos_theta) { return
  * @param[in] roughness. Surface roughness parameter, as a float between 0.0f and 1.0f.
  * @return An approximation of the relative surface area of microfacets exactly aligned to the halfway vector.
  */
-static float normal_distribution_trowbridge_reitz_ggx(float n_dot_h, float roughness)
+inline float normal_distribution_trowbridge_reitz_ggx(float n_dot_h, float roughness)
 {
-    auto const alpha_squared = std::pow(roughness, 4);
+    auto const roughness_squared = roughness * roughness;
+    auto const alpha_squared = roughness_squared * roughness_squared;
     auto const n_dot_h_squared = n_dot_h * n_dot_h;
     auto const numerator = alpha_squared;
     auto denominator = (n_dot_h_squared * (alpha_squared - 1.0f) + 1.0f);
@@ -67,7 +80,7 @@ static float normal_distribution_trowbridge_reitz_ggx(float n_dot_h, float rough
  * @param[in] k. Remapping of the surface roughness parameter.
  * @return The geometry component.
  */
-static float geometry_schlick_ggx(float n_dot_v, float k)
+inline float geometry_schlick_ggx(float n_dot_v, float k)
 {
     auto const numerator = n_dot_v;
     auto const denominator = n_dot_v * (1.0f - k) + k;
@@ -81,7 +94,7 @@ static float geometry_schlick_ggx(float n_dot_v, float k)
  * @param[in] roughness. Surface roughness parameter, as a float between 0.0f and 1.0f.
  * @return An approximation of the surface area where micro-elements of geometry overshadow each other due to obstruction and shadowing.
  */
-static float geometry_smith(float n_dot_v, float n_dot_l, float roughness)
+inline float geometry_smith(float n_dot_v, float n_dot_l, float roughness)
 {
     auto const r = (roughness + 1.0f);
     auto const k = (r * r) / 8.0f;
@@ -89,12 +102,13 @@ static float geometry_smith(float n_dot_v, float n_dot_l, float roughness)
     auto const geometry_shadowing = geometry_schlick_ggx(n_dot_l, k);
     return geometry_obstruction * geometry_shadowing;
 }
+
 /**
  * @brief Lambertian diffuse factor.
  * @param[in] albedo. Surface color.
  * @return The diffuse part of the Cook-Torrance BRDF.
  */
-static Vec3f diffuse_lambert(Vec3f const& albedo) { return albedo / math::pi; }
+inline Vec3f diffuse_lambert(Vec3f const& albedo) { return albedo / math::pi; }
 
 /**
  * @brief Cook-Torrance specular factor.
@@ -105,7 +119,7 @@ static Vec3f diffuse_lambert(Vec3f const& albedo) { return albedo / math::pi; }
  * @param[in] n_dot_v. Dot product of the surface normal direction and view direction.
  * @return The specular part of the Cook-Torrance BRDF.
  */
-static Vec3f specular_cook_torrance(float normal_distribution, float geometry, Vec3f const& fresnel, float n_dot_l, float n_dot_v)
+inline Vec3f specular_cook_torrance(float normal_distribution, float geometry, Vec3f const& fresnel, float n_dot_l, float n_dot_v)
 {
     auto denominator = 4.0f * n_dot_l * n_dot_v;
     if (denominator == 0.0f)
@@ -133,7 +147,7 @@ struct BRDF_Input
  * @param[in] input. Set of input parameters.
  * @return The result of the BRDF, as a three-dimensional vector.
  */
-static Vec3f brdf_cook_torrance(BRDF_Input const& input)
+inline Vec3f brdf_cook_torrance(BRDF_Input const& input)
 {
     auto const& normal_distribution_function = normal_distribution_trowbridge_reitz_ggx;
     auto const& geometry_function = geometry_smith;
@@ -150,3 +164,159 @@ static Vec3f brdf_cook_torrance(BRDF_Input const& input)
 
     return refracted_ratio * diffuse_function(input.albedo) + specular_function(normal_distribution, geometry, fresnel, input.n_dot_l, input.n_dot_v);
 }
+
+/**
+ * @brief Samples an incident direction following the Cook-Torrance BRDF, as a mixture of GGX sampling of the halfway direction (specular lobe) and cosine-weighted sampling (diffuse lobe).
+ * @param[in,out] input. Surface parameters on input, completed with the dot products of the sampled direction on output.
+ * @param[in] normal_direction. Direction of the surface normal.
+ * @param[in] view_direction. Direction from the surface point towards the viewer.
+ * @param[in] lobe_sample. Random value in the [0,1[ range used to choose between the two lobes.
+ * @param[in] direction_sample. Random values in the [0,1[ x [0,1[ range used to sample the direction in the chosen lobe.
+ * @param[out] out_direction. The sampled incident direction.
+ * @param[out] out_weight. The BRDF times the cosine term, divided by the probability density of the sampled direction.
+ * @return True if the sampled direction lies above the surface, false otherwise (in which case the path should be terminated).
+ */
+inline bool sample_brdf_cook_torrance(BRDF_Input& input, Unit_Vec3f const& normal_direction, Unit_Vec3f const& view_direction, float lobe_sample, Vec2f const& direction_sample, Unit_Vec3f& out_direction, Vec3f& out_weight)
+{
+    auto first_axis = Vec3f::zero();
+    auto second_axis = Vec3f::zero();
+    math::compute_orthonormal_basis(normal_direction, first_axis, second_axis);
+    auto const alpha = input.roughness * input.roughness;
+    auto const alpha_squared = alpha * alpha;
+    // Metals have no diffuse lobe, so always sample their specular lobe
+    auto const specular_probability = math::linear_interpolation(0.5f, 1.0f, input.metallic);
+    auto const phi = 2.0f * math::pi * direction_sample.x();
+    if (lobe_sample < specular_probability)
+    {
+        auto const cos_theta = std::sqrt((1.0f - direction_sample.y()) / (1.0f + (alpha_squared - 1.0f) * direction_sample.y()));
+        auto const sin_theta = std::sqrt((std::max)(1.0f - cos_theta * cos_theta, 0.0f));
+        auto const halfway_direction = (sin_theta * std::cos(phi)) * first_axis + (sin_theta * std::sin(phi)) * second_axis + cos_theta * normal_direction;
+        out_direction = (2.0f * view_direction.dot(halfway_direction) * halfway_direction - view_direction).normalize();
+    }
+    else
+    {
+        auto const radius = std::sqrt(direction_sample.y());
+        out_direction = ((radius * std::cos(phi)) * first_axis + (radius * std::sin(phi)) * second_axis + std::sqrt(1.0f - direction_sample.y()) * normal_direction).normalize();
+    }
+
+    // Evaluate the BRDF and the mixture's probability density for the sampled direction
+    input.n_dot_l = normal_direction.dot(out_direction);
+    input.n_dot_v = (std::max)(normal_direction.dot(view_direction), 0.0f);
+    if (input.n_dot_l <= 0.0f || input.n_dot_v <= 0.0f)
+        return false;
+    auto const halfway_direction = (view_direction + out_direction).normalize();
+    input.h_dot_v = (std::max)(halfway_direction.dot(view_direction), 0.0f);
+    input.n_dot_h = (std::max)(normal_direction.dot(halfway_direction), 0.0f);
+    auto const specular_density = normal_distribution_trowbridge_reitz_ggx(input.n_dot_h, input.roughness) * input.n_dot_h / (4.0f * (std::max)(input.h_dot_v, 0.0001f));
+    auto const diffuse_density = input.n_dot_l / math::pi;
+    auto const density = specular_probability * specular_density + (1.0f - specular_probability) * diffuse_density;
+    if (!(density > 0.0f))
+        return false;
+    out_weight = brdf_cook_torrance(input) * (input.n_dot_l / density);
+    return true;
+}
+
+/**
+ * @brief Structure-of-arrays batch of inputs to the Cook-Torrance BRDF, evaluated across several lanes at once.
+ * Each lane holds a surface point, a light direction and the light's incident radiance, so that a batch can gather several lights for the same point, or several points for the same light.
+ */
+struct BRDF_Batch
+{
+    static constexpr unsigned int size = 8; // Number of lanes in a batch
+
+    // Surface parameters
+    alignas(32) float albedo_r[size];
+    alignas(32) float albedo_g[size];
+    alignas(32) float albedo_b[size];
+    alignas(32) float roughness[size];
+    alignas(32) float metallic[size];
+    alignas(32) float base_reflectivity_r[size];
+    alignas(32) float base_reflectivity_g[size];
+    alignas(32) float base_reflectivity_b[size];
+    // Dot products between the normal, view, light and halfway directions
+    alignas(32) float h_dot_v[size];
+    alignas(32) float n_dot_h[size];
+    alignas(32) float n_dot_v[size];
+    alignas(32) float n_dot_l[size];
+    // Incident radiance of the light
+    alignas(32) float radiance_r[size];
+    alignas(32) float radiance_g[size];
+    alignas(32) float radiance_b[size];
+    // Output reflected radiance, i.e. BRDF * radiance * n_dot_l
+    alignas(32) float reflected_r[size];
+    alignas(32) float reflected_g[size];
+    alignas(32) float reflected_b[size];
+
+    void set_surface(unsigned int lane, Vec3f const& albedo, float roughness_value, float metallic_value, Vec3f const& base_reflectivity)
+    {
+        albedo_r[lane] = albedo.x();
+        albedo_g[lane] = albedo.y();
+        albedo_b[lane] = albedo.z();
+        roughness[lane] = roughness_value;
+        metallic[lane] = metallic_value;
+        base_reflectivity_r[lane] = base_reflectivity.x();
+        base_reflectivity_g[lane] = base_reflectivity.y();
+        base_reflectivity_b[lane] = base_reflectivity.z();
+    }
+
+    void set_light(unsigned int lane, float h_dot_v_value, float n_dot_h_value, float n_dot_v_value, float n_dot_l_value, Vec3f const& radiance)
+    {
+        h_dot_v[lane] = h_dot_v_value;
+        n_dot_h[lane] = n_dot_h_value;
+        n_dot_v[lane] = n_dot_v_value;
+        n_dot_l[lane] = n_dot_l_value;
+        radiance_r[lane] = radiance.x();
+        radiance_g[lane] = radiance.y();
+        radiance_b[lane] = radiance.z();
+    }
+
+    Vec3f get_reflected(unsigned int lane) const { return Vec3f{reflected_r[lane], reflected_g[lane], reflected_b[lane]}; }
+};
+
+/**
+ * @brief Computes the reflected radiance for the first lanes of the given batch, using the same terms as brdf_cook_torrance (GGX, Smith and Fresnel-Schlick).
+ * The loop body is branch-free arithmetic on flat arrays, so that it is vectorized by the compiler. To keep it so, the dot products are expected to be clamped to the 0-1 range by the caller,
+ * and the specular denominator is offset by a small epsilon instead of being tested against zero.
+ * @param[in,out] batch. Batch whose inputs to read and whose outputs to write.
+ * @param[in] count. Number of lanes to evaluate, from the first one.
+ */
+inline void brdf_cook_torrance_batch(BRDF_Batch& batch, unsigned int count)
+{
+    auto constexpr one_on_pi = 1.0f / math::pi;
+    for (auto lane = 0u; lane < count; lane++)
+    {
+        // Normal distribution function (GGX)
+        auto const roughness = batch.roughness[lane];
+        auto const roughness_squared = roughness * roughness;
+        auto const alpha_squared = roughness_squared * roughness_squared;
+        auto const n_dot_h = batch.n_dot_h[lane];
+        auto const distribution_denominator = n_dot_h * n_dot_h * (alpha_squared - 1.0f) + 1.0f;
+        auto const normal_distribution = alpha_squared / (math::pi * distribution_denominator * distribution_denominator);
+
+        // Geometry function (Smith with Schlick-GGX)
+        auto const r = roughness + 1.0f;
+        auto const k = (r * r) * 0.125f;
+        auto const n_dot_v = batch.n_dot_v[lane];
+        auto const n_dot_l = batch.n_dot_l[lane];
+        auto const geometry = (n_dot_v / (n_dot_v * (1.0f - k) + k)) * (n_dot_l / (n_dot_l * (1.0f - k) + k));
+
+        // Fresnel equation (Schlick)
+        auto const x = 1.0f - batch.h_dot_v[lane];
+        auto const x_squared = x * x;
+        auto const fresnel_weight = x_squared * x_squared * x;
+        auto const fresnel_r = batch.base_reflectivity_r[lane] + (1.0f - batch.base_reflectivity_r[lane]) * fresnel_weight;
+        auto const fresnel_g = batch.base_reflectivity_g[lane] + (1.0f - batch.base_reflectivity_g[lane]) * fresnel_weight;
+        auto const fresnel_b = batch.base_reflectivity_b[lane] + (1.0f - batch.base_reflectivity_b[lane]) * fresnel_weight;
+
+        // Combine the diffuse and specular parts, and apply the incident radiance
+        auto const specular_denominator = 4.0f * n_dot_l * n_dot_v + 0.0001f;
+        auto const specular_weight = normal_distribution * geometry / specular_denominator;
+        auto const diffuse_weight = (1.0f - batch.metallic[lane]) * one_on_pi;
+        auto const brdf_r = (1.0f - fresnel_r) * diffuse_weight * batch.albedo_r[lane] + specular_weight * fresnel_r;
+        auto const brdf_g = (1.0f - fresnel_g) * diffuse_weight * batch.albedo_g[lane] + specular_weight * fresnel_g;
+        auto const brdf_b = (1.0f - fresnel_b) * diffuse_weight * batch.albedo_b[lane] + specular_weight * fresnel_b;
+        batch.reflected_r[lane] = brdf_r * batch.radiance_r[lane] * n_dot_l;
+        batch.reflected_g[lane] = brdf_g * batch.radiance_g[lane] * n_dot_l;
+        batch.reflected_b[lane] = brdf_b * batch.radiance_b[lane] * n_dot_l;
+    }
+}
@@ -0,0 +1,141 @@
+#include "camera_ray_table.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <emmintrin.h>
+
+namespace
+{
+
+/**
+ * @brief Checks whether two vectors have exactly the same components.
+ * @param[in] first. First vector.
+ * @param[in] second. Second vector.
+ * @return True if all components are equal, false otherwise.
+ */
+bool are_equal(Vec3f const& first, Vec3f const& second) { return first.x() == second.x() && first.y() == second.y() && first.z() == second.z(); }
+
+} // namespace
+
+void Camera_Ray_Table::update(Camera const& camera, int width, int height, Camera_Ray_Table const* shared_table)
+{
+    // Share or generate the camera-space directions again only if the intrinsics changed
+    auto const are_directions_current = has_intrinsics_of(camera, width, height);
+    if (!are_directions_current)
+    {
+        m_width = width;
+        m_height = height;
+        m_padded_width = (width + 3) & ~3;
+        m_near = camera.get_near();
+        m_image_plane_width = camera.get_image_plane_width();
+        m_image_plane_height = camera.get_image_plane_height();
+        if (shared_table != nullptr && shared_table->m_camera_directions != nullptr && shared_table->has_intrinsics_of(camera, width, height))
+        {
+            m_camera_directions = shared_table->m_camera_directions;
+        }
+        else
+        {
+            // Tables sharing the previous directions keep them, so new ones are always allocated
+            auto const padded_count = static_cast<std::size_t>(m_padded_width) * height;
+            auto camera_directions = std::make_shared<std::array<std::vector<float>, 3>>();
+            for (auto& component : *camera_directions)
+                component.resize(padded_count);
+            for (auto tile_y = 0; tile_y < height; tile_y += tile_size)
+                for (auto tile_x = 0; tile_x < width; tile_x += tile_size)
+                    generate_tile(tile_x, tile_y, *camera_directions);
+            m_camera_directions = camera_directions;
+        }
+    }
+
+    // Rotate them again only if they changed or the camera turned
+    auto const is_rotation_current = are_directions_current && are_equal(camera.get_right(), m_right) && are_equal(camera.get_up(), m_up) && are_equal(camera.get_forward(), m_forward);
+    if (is_rotation_current)
+        return;
+    m_right = camera.get_right();
+    m_up = camera.get_up();
+    m_forward = camera.get_forward();
+    rotate_directions();
+}
+
+bool Camera_Ray_Table::has_intrinsics_of(Camera const& camera, int width, int height) const
+{
+    return width == m_width && height == m_height && camera.get_near() == m_near && camera.get_image_plane_width() == m_image_plane_width &&
+           camera.get_image_plane_height() == m_image_plane_height;
+}
+
+void Camera_Ray_Table::generate_tile(int tile_x, int tile_y, std::array<std::vector<float>, 3>& out_directions) const
+{
+    // Compute the points of the image plane as camera rays do, i.e. u = i / (width - 1) - 0.5, then normalize the directions with the same operations as unit vectors,
+    // so that directions are the same as when computed one at a time
+    auto const half = _mm_set1_ps(0.5f);
+    auto const one = _mm_set1_ps(1.0f);
+    auto const epsilon = _mm_set1_ps(std::numeric_limits<float>::epsilon());
+    auto const sign_mask = _mm_set1_ps(-0.0f);
+    auto const column_divisor = _mm_set1_ps(static_cast<float>(m_width - 1));
+    auto const column_offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    auto const plane_width = _mm_set1_ps(m_image_plane_width);
+    auto const near = _mm_set1_ps(m_near);
+    auto const end_x = (std::min)(tile_x + tile_size, m_padded_width);
+    auto const end_y = (std::min)(tile_y + tile_size, m_height);
+    for (auto y = tile_y; y < end_y; y++)
+    {
+        auto const v = _mm_set1_ps((y * 1.0f / (m_height - 1)) - 0.5f);
+        auto const camera_y = _mm_mul_ps(v, _mm_set1_ps(m_image_plane_height));
+        auto const row_offset = static_cast<std::size_t>(y) * m_padded_width;
+        for (auto x = tile_x; x < end_x; x += 4)
+        {
+            auto const u = _mm_sub_ps(_mm_div_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(x)), column_offsets), column_divisor), half);
+            auto const camera_x = _mm_mul_ps(u, plane_width);
+            auto const squared_length = _mm_add_ps(_mm_add_ps(_mm_mul_ps(camera_x, camera_x), _mm_mul_ps(camera_y, camera_y)), _mm_mul_ps(near, near));
+            auto const length = _mm_sqrt_ps(squared_length);
+            auto const one_on_length = _mm_div_ps(one, length);
+            // Unit vectors leave the components untouched when their length is already one, or zero
+            auto const is_scaled = _mm_and_ps(_mm_cmpgt_ps(_mm_andnot_ps(sign_mask, _mm_sub_ps(length, one)), epsilon), _mm_cmpgt_ps(length, epsilon));
+            auto const scale = _mm_or_ps(_mm_and_ps(is_scaled, one_on_length), _mm_andnot_ps(is_scaled, one));
+            _mm_storeu_ps(out_directions[0].data() + row_offset + x, _mm_mul_ps(camera_x, scale));
+            _mm_storeu_ps(out_directions[1].data() + row_offset + x, _mm_mul_ps(camera_y, scale));
+            _mm_storeu_ps(out_directions[2].data() + row_offset + x, _mm_mul_ps(near, scale));
+        }
+    }
+}
+
+void Camera_Ray_Table::rotate_directions()
+{
+    auto const pixel_count = static_cast<std::size_t>(m_width) * m_height;
+    for (auto& component : m_directions)
+        component.resize(pixel_count);
+    auto const& camera_directions = *m_camera_directions;
+    // The axes are kept as plain floats and broadcast where they are used, since containers of SSE vectors do not guarantee their alignment
+    float const right[3] = {m_right.x(), m_right.y(), m_right.z()};
+    float const up[3] = {m_up.x(), m_up.y(), m_up.z()};
+    float const forward[3] = {m_forward.x(), m_forward.y(), m_forward.z()};
+    for (auto y = 0; y < m_height; y++)
+    {
+        auto const source_offset = static_cast<std::size_t>(y) * m_padded_width;
+        auto const target_offset = static_cast<std::size_t>(y) * m_width;
+        auto x = 0;
+        for (; x + 4 <= m_width; x += 4)
+        {
+            auto const camera_x = _mm_loadu_ps(camera_directions[0].data() + source_offset + x);
+            auto const camera_y = _mm_loadu_ps(camera_directions[1].data() + source_offset + x);
+            auto const camera_z = _mm_loadu_ps(camera_directions[2].data() + source_offset + x);
+            for (auto axis_it = 0u; axis_it < 3; axis_it++)
+            {
+                auto const direction =
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(camera_x, _mm_set1_ps(right[axis_it])), _mm_mul_ps(camera_y, _mm_set1_ps(up[axis_it]))), _mm_mul_ps(camera_z, _mm_set1_ps(forward[axis_it])));
+                _mm_storeu_ps(m_directions[axis_it].data() + target_offset + x, direction);
+            }
+        }
+        for (; x < m_width; x++)
+        {
+            auto const camera_x = camera_directions[0][source_offset + x];
+            auto const camera_y = camera_directions[1][source_offset + x];
+            auto const camera_z = camera_directions[2][source_offset + x];
+            auto const direction = camera_x * m_right + camera_y * m_up + camera_z * m_forward;
+            m_directions[0][target_offset + x] = direction.x();
+            m_directions[1][target_offset + x] = direction.y();
+            m_directions[2][target_offset + x] = direction.z();
+        }
+    }
+}
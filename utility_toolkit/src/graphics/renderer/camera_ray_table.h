@@ -0,0 +1,78 @@
+#pragma once
+
+#include <graphics/camera.h>
+#include <math/vec.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Directions of the camera rays through the centers of the pixels, generated a tile at a time, four pixels at once.
+ * Directions are first generated in camera space, where they only depend on the camera's intrinsics (near distance and image plane) and on the resolution,
+ * then rotated to world space by the camera's basis. Frames whose intrinsics did not change keep the camera-space directions and only rotate them,
+ * so that moving or turning the camera never generates the directions again. Tables of several views sharing their intrinsics (e.g. the eyes of a stereo pair,
+ * or the faces of a cube map) also share their camera-space directions, which are only generated for the first of them.
+ */
+class Camera_Ray_Table
+{
+  public:
+    Camera_Ray_Table() = default;
+    ~Camera_Ray_Table() = default;
+    Camera_Ray_Table(Camera_Ray_Table const& other) = default;
+    Camera_Ray_Table& operator=(Camera_Ray_Table const& other) = default;
+
+    /**
+     * @brief Updates the directions for a camera, generating the camera-space directions again only if the camera's intrinsics or the resolution changed,
+     * and rotating them again only if they changed or if the camera turned.
+     * @param[in] camera. Camera casting the rays.
+     * @param[in] width. Width of the framebuffer, in pixels.
+     * @param[in] height. Height of the framebuffer, in pixels.
+     * @param[in] shared_table. Table already updated for another view, whose camera-space directions are shared instead of generated if its camera has the same intrinsics, or nullptr.
+     */
+    void update(Camera const& camera, int width, int height, Camera_Ray_Table const* shared_table = nullptr);
+
+    /**
+     * @brief Gets the direction of the camera ray through a pixel's center.
+     * @param[in] index. Index of the pixel, row after row.
+     * @return The world-space direction of the ray.
+     */
+    Unit_Vec3f get_direction(int index) const { return Unit_Vec3f::from_normalized({m_directions[0][index], m_directions[1][index], m_directions[2][index]}); }
+
+  private:
+    /**
+     * @brief Checks whether the camera-space directions were generated for a camera's intrinsics and a resolution.
+     * @param[in] camera. Camera casting the rays.
+     * @param[in] width. Width of the framebuffer, in pixels.
+     * @param[in] height. Height of the framebuffer, in pixels.
+     * @return True if the directions were generated for the same intrinsics and resolution, false otherwise.
+     */
+    bool has_intrinsics_of(Camera const& camera, int width, int height) const;
+
+    /**
+     * @brief Generates the normalized camera-space directions of a tile's pixels, four pixels at once.
+     * @param[in] tile_x. First column of the tile.
+     * @param[in] tile_y. First row of the tile.
+     * @param[out] out_directions. Camera-space X, Y and Z components of the directions of all pixels, stored row after row.
+     */
+    void generate_tile(int tile_x, int tile_y, std::array<std::vector<float>, 3>& out_directions) const;
+
+    /**
+     * @brief Rotates the camera-space directions of all pixels to world space, four pixels at once.
+     */
+    void rotate_directions();
+
+    static constexpr int tile_size = 16; // Width and height of the tiles of pixels generated together, a multiple of the four pixels generated at once
+
+    int m_width = 0;                                                              // Width of the framebuffer, in pixels
+    int m_height = 0;                                                             // Height of the framebuffer, in pixels
+    int m_padded_width = 0;                                                       // Number of directions per row, rounded up to a multiple of four
+    float m_near = 0.0f;                                                          // Near distance of the camera whose intrinsics generated the directions
+    float m_image_plane_width = 0.0f;                                             // Width of the image plane of the camera whose intrinsics generated the directions
+    float m_image_plane_height = 0.0f;                                            // Height of the image plane of the camera whose intrinsics generated the directions
+    Vec3f m_right = Vec3f::zero();                                                // Right direction of the camera whose basis rotated the directions
+    Vec3f m_up = Vec3f::zero();                                                   // Up direction of the camera whose basis rotated the directions
+    Vec3f m_forward = Vec3f::zero();                                              // Forward direction of the camera whose basis rotated the directions
+    std::shared_ptr<std::array<std::vector<float>, 3> const> m_camera_directions; // Camera-space X, Y and Z components of the direction of each pixel, stored row after row, shared by the tables with the same intrinsics
+    std::array<std::vector<float>, 3> m_directions;                               // World-space X, Y and Z components of the direction of each pixel, stored row after row
+};
@@ -0,0 +1,202 @@
+#include "denoiser.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+// Albedo below which colors are not divided, to avoid amplifying noise on dark surfaces
+auto constexpr min_albedo = 0.01f;
+// One-dimensional weights of the a-trous kernel
+float constexpr b3_spline_kernel[5] = {1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+
+/**
+ * @brief Approximates exp(-x) for non-negative x as (1 + x / 16)^-16, which only needs multiplications and a division, so that loops calling it can be vectorized.
+ * @param[in] x. Non-negative exponent.
+ * @return An approximation of exp(-x), decreasing from one towards zero.
+ */
+inline float approximate_negative_exp(float x)
+{
+    auto y = 1.0f + x * (1.0f / 16.0f);
+    y *= y;
+    y *= y;
+    y *= y;
+    y *= y;
+    return 1.0f / y;
+}
+
+} // namespace
+
+Denoiser::Denoiser(unsigned int iteration_count, float color_sigma, float normal_sigma, float depth_sigma, float albedo_sigma)
+    : m_iteration_count{iteration_count}
+    , m_color_sigma{color_sigma}
+    , m_normal_sigma{normal_sigma}
+    , m_depth_sigma{depth_sigma}
+    , m_albedo_sigma{albedo_sigma}
+{
+}
+
+void Denoiser::apply(Framebuffer& framebuffer, Worker_Pool& worker_pool) const
+{
+    if (!framebuffer.has_guides() || m_iteration_count == 0)
+        return;
+    auto const pixel_count = static_cast<std::size_t>(framebuffer.get_pixel_count());
+    auto const height = framebuffer.get_height();
+    auto const thread_count = worker_pool.get_thread_count();
+
+    // Divide colors by the albedo, so that only lighting is filtered
+    std::array<float*, 3> colors{framebuffer.get_red(), framebuffer.get_green(), framebuffer.get_blue()};
+    std::array<std::vector<float>, 3> first_buffer;
+    std::array<std::vector<float>, 3> second_buffer;
+    for (auto channel = 0u; channel < 3; channel++)
+    {
+        first_buffer[channel].resize(pixel_count);
+        second_buffer[channel].resize(pixel_count);
+        auto const* albedo = framebuffer.get_albedo(channel);
+        auto const* color = colors[channel];
+        auto* lighting = first_buffer[channel].data();
+        for (auto index = 0u; index < pixel_count; index++)
+            lighting[index] = color[index] / (std::max)(albedo[index], min_albedo);
+    }
+
+    // Apply the iterations, ping-ponging between the two buffers, each iteration being split over the threads by bands of rows
+    std::array<float const*, 3> input{first_buffer[0].data(), first_buffer[1].data(), first_buffer[2].data()};
+    std::array<float*, 3> output{second_buffer[0].data(), second_buffer[1].data(), second_buffer[2].data()};
+    std::vector<float> compressed_luminances(pixel_count);
+    auto color_sigma = m_color_sigma;
+    for (auto iteration_it = 0u; iteration_it < m_iteration_count; iteration_it++)
+    {
+        // Colors are compared through their luminance, compressed to the 0-1 range so that the tolerance does not depend on the dynamic range of the lighting
+        for (auto index = 0u; index < pixel_count; index++)
+        {
+            auto const luminance = (std::max)(0.2126f * input[0][index] + 0.7152f * input[1][index] + 0.0722f * input[2][index], 0.0f);
+            compressed_luminances[index] = luminance / (1.0f + luminance);
+        }
+        auto const step = 1 << iteration_it;
+        auto const rows_per_thread = (height + static_cast<int>(thread_count) - 1) / static_cast<int>(thread_count);
+        worker_pool.run([&](unsigned int thread_index) {
+            auto const first_row = static_cast<int>(thread_index) * rows_per_thread;
+            auto const end_row = (std::min)(first_row + rows_per_thread, height);
+            if (first_row < end_row)
+                filter_rows(framebuffer, input.data(), compressed_luminances.data(), output.data(), step, color_sigma, first_row, end_row);
+        });
+        for (auto channel = 0u; channel < 3; channel++)
+        {
+            auto* const previous_input = const_cast<float*>(input[channel]);
+            input[channel] = output[channel];
+            output[channel] = previous_input;
+        }
+        color_sigma *= 0.5f;
+    }
+
+    // Multiply the filtered lighting back by the albedo
+    for (auto channel = 0u; channel < 3; channel++)
+    {
+        auto const* albedo = framebuffer.get_albedo(channel);
+        auto const* lighting = input[channel];
+        auto* color = colors[channel];
+        for (auto index = 0u; index < pixel_count; index++)
+            color[index] = lighting[index] * (std::max)(albedo[index], min_albedo);
+    }
+}
+
+void Denoiser::filter_rows(Framebuffer const& framebuffer, float const* const* input, float const* compressed_luminances, float* const* output, int step, float color_sigma, int first_row, int end_row) const
+{
+    auto const width = framebuffer.get_width();
+    auto const height = framebuffer.get_height();
+    auto const* normal_x = framebuffer.get_normal(0);
+    auto const* normal_y = framebuffer.get_normal(1);
+    auto const* normal_z = framebuffer.get_normal(2);
+    auto const* albedo_r = framebuffer.get_albedo(0);
+    auto const* albedo_g = framebuffer.get_albedo(1);
+    auto const* albedo_b = framebuffer.get_albedo(2);
+    auto const* depth = framebuffer.get_depth();
+    auto const* object_ids = framebuffer.get_object_ids();
+    auto const* input_r = input[0];
+    auto const* input_g = input[1];
+    auto const* input_b = input[2];
+    auto const inverse_color_variance = 1.0f / (color_sigma * color_sigma);
+    auto const inverse_normal_variance = 1.0f / (m_normal_sigma * m_normal_sigma);
+    auto const inverse_albedo_variance = 1.0f / (m_albedo_sigma * m_albedo_sigma);
+    auto const inverse_depth_sigma = 1.0f / (m_depth_sigma * step);
+
+    // Accumulate the taps of each row in row-wide sums, one tap offset at a time, so that the inner loops run over contiguous pixels without branches.
+    // Weights are computed in a first loop and applied to each channel in separate loops, each loop touching few enough arrays to be vectorized
+    std::vector<float> tap_weights(width);
+    std::vector<float> sum_r(width);
+    std::vector<float> sum_g(width);
+    std::vector<float> sum_b(width);
+    std::vector<float> sum_weights(width);
+    for (auto row = first_row; row < end_row; row++)
+    {
+        std::fill(sum_r.begin(), sum_r.end(), 0.0f);
+        std::fill(sum_g.begin(), sum_g.end(), 0.0f);
+        std::fill(sum_b.begin(), sum_b.end(), 0.0f);
+        std::fill(sum_weights.begin(), sum_weights.end(), 0.0f);
+        auto const center_offset = row * width;
+        for (auto tap_y = -2; tap_y <= 2; tap_y++)
+        {
+            auto const tap_row = row + tap_y * step;
+            if (tap_row < 0 || tap_row >= height)
+                continue;
+            for (auto tap_x = -2; tap_x <= 2; tap_x++)
+            {
+                // Only visit the pixels whose tap lies inside the framebuffer, taps outside of it being dropped by the normalization
+                auto const column_offset = tap_x * step;
+                auto const first_column = (std::max)(0, -column_offset);
+                auto const end_column = (std::min)(width, width - column_offset);
+                auto const kernel_weight = b3_spline_kernel[tap_y + 2] * b3_spline_kernel[tap_x + 2];
+                auto const tap_offset = tap_row * width + column_offset;
+                auto* const weights = tap_weights.data();
+                for (auto column = first_column; column < end_column; column++)
+                {
+                    auto const p = center_offset + column;
+                    auto const q = tap_offset + column;
+                    auto const difference_luminance = compressed_luminances[q] - compressed_luminances[p];
+                    auto const difference_nx = normal_x[q] - normal_x[p];
+                    auto const difference_ny = normal_y[q] - normal_y[p];
+                    auto const difference_nz = normal_z[q] - normal_z[p];
+                    auto const difference_ar = albedo_r[q] - albedo_r[p];
+                    auto const difference_ag = albedo_g[q] - albedo_g[p];
+                    auto const difference_ab = albedo_b[q] - albedo_b[p];
+                    auto const color_distance = difference_luminance * difference_luminance;
+                    auto const normal_distance = difference_nx * difference_nx + difference_ny * difference_ny + difference_nz * difference_nz;
+                    auto const albedo_distance = difference_ar * difference_ar + difference_ag * difference_ag + difference_ab * difference_ab;
+                    auto const depth_distance = std::abs(depth[q] - depth[p]);
+                    auto const same_object = static_cast<float>(object_ids[q] == object_ids[p]);
+                    auto const exponent = color_distance * inverse_color_variance + normal_distance * inverse_normal_variance + albedo_distance * inverse_albedo_variance + depth_distance * inverse_depth_sigma;
+                    weights[column] = kernel_weight * same_object * approximate_negative_exp(exponent);
+                }
+                auto* const row_sum_r = sum_r.data();
+                auto* const row_sum_g = sum_g.data();
+                auto* const row_sum_b = sum_b.data();
+                auto* const row_sum_weights = sum_weights.data();
+                auto const* const tap_r = input_r + tap_offset;
+                auto const* const tap_g = input_g + tap_offset;
+                auto const* const tap_b = input_b + tap_offset;
+                for (auto column = first_column; column < end_column; column++)
+                    row_sum_r[column] += weights[column] * tap_r[column];
+                for (auto column = first_column; column < end_column; column++)
+                    row_sum_g[column] += weights[column] * tap_g[column];
+                for (auto column = first_column; column < end_column; column++)
+                    row_sum_b[column] += weights[column] * tap_b[column];
+                for (auto column = first_column; column < end_column; column++)
+                    row_sum_weights[column] += weights[column];
+            }
+        }
+        // The center tap always has a positive weight, so the sum of weights never vanishes
+        auto* const output_r = output[0] + center_offset;
+        auto* const output_g = output[1] + center_offset;
+        auto* const output_b = output[2] + center_offset;
+        for (auto column = 0; column < width; column++)
+        {
+            auto const inverse_weight = 1.0f / sum_weights[column];
+            output_r[column] = sum_r[column] * inverse_weight;
+            output_g[column] = sum_g[column] * inverse_weight;
+            output_b[column] = sum_b[column] * inverse_weight;
+        }
+    }
+}
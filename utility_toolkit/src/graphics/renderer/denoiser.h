@@ -0,0 +1,56 @@
+#pragma once
+
+#include <graphics/renderer/framebuffer.h>
+#include <graphics/renderer/worker_pool.h>
+
+#include <dll_defines.h>
+
+/**
+ * @brief Post-process denoiser implementing the edge-avoiding a-trous wavelet filter (Dammertz et al.), guided by the framebuffer's depth, normal, albedo and object id AOVs.
+ * Colors are divided by the albedo before filtering, so that only the lighting is blurred and texture detail is kept, then multiplied back.
+ * Each iteration applies a 5x5 B3-spline kernel whose taps are spread by a step doubling at each iteration, each tap being weighted by its similarity to the center pixel
+ * in luminance, normal, depth and albedo, and discarded if it belongs to another object.
+ */
+class Denoiser
+{
+  public:
+    /**
+     * @brief Creates a denoiser with the given filter parameters.
+     * @param[in] iteration_count. Number of a-trous iterations, the filter covering a (4 * 2^iteration_count + 1)-wide footprint.
+     * @param[in] color_sigma. Tolerance on the difference of compressed luminances of (albedo-divided) colors, halved at each iteration.
+     * @param[in] normal_sigma. Tolerance on the difference of normals.
+     * @param[in] depth_sigma. Tolerance on the difference of depths, in world units per pixel of tap distance.
+     * @param[in] albedo_sigma. Tolerance on the difference of albedos.
+     */
+    DECLSPECIFIER Denoiser(unsigned int iteration_count = 5, float color_sigma = 0.5f, float normal_sigma = 0.3f, float depth_sigma = 0.05f, float albedo_sigma = 0.1f);
+    DECLSPECIFIER ~Denoiser() = default;
+    DECLSPECIFIER Denoiser(Denoiser const& other) = default;
+    DECLSPECIFIER Denoiser& operator=(Denoiser const& other) = default;
+
+    /**
+     * @brief Denoises the colors of the given framebuffer in place. Does nothing if the framebuffer does not store all of its guiding AOVs.
+     * @param[in,out] framebuffer. Framebuffer whose colors to denoise.
+     * @param[in,out] worker_pool. Worker threads over which to split the rows of each iteration.
+     */
+    DECLSPECIFIER void apply(Framebuffer& framebuffer, Worker_Pool& worker_pool) const;
+
+  private:
+    /**
+     * @brief Applies one a-trous iteration to a range of rows.
+     * @param[in] framebuffer. Framebuffer providing the guiding AOVs.
+     * @param[in] input. Planar input colors (red, green, blue).
+     * @param[in] compressed_luminances. Luminance of the input colors, compressed to the 0-1 range.
+     * @param[out] output. Planar output colors (red, green, blue).
+     * @param[in] step. Distance between the kernel's taps, in pixels.
+     * @param[in] color_sigma. Tolerance on the difference of colors for this iteration.
+     * @param[in] first_row. First row to filter.
+     * @param[in] end_row. Row after the last row to filter.
+     */
+    void filter_rows(Framebuffer const& framebuffer, float const* const* input, float const* compressed_luminances, float* const* output, int step, float color_sigma, int first_row, int end_row) const;
+
+    unsigned int m_iteration_count; // Number of a-trous iterations
+    float m_color_sigma;            // Tolerance on the difference of colors, for the first iteration
+    float m_normal_sigma;           // Tolerance on the difference of normals
+    float m_depth_sigma;            // Tolerance on the difference of depths, per pixel of tap distance
+    float m_albedo_sigma;           // Tolerance on the difference of albedos
+};
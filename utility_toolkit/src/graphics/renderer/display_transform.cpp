@@ -0,0 +1,52 @@
+#include "display_transform.h"
+
+#include <graphics/physically_based_rendering.h>
+#include <math/math.h>
+
+#include <algorithm>
+#include <cmath>
+
+Display_Transform::Display_Transform(Tone_Curve tone_curve, float gamma)
+    : m_tone_curve{tone_curve}
+    , m_lut{}
+    , m_lut_8_bit{}
+{
+    for (auto i = 0u; i < lut_size; i++)
+    {
+        // Recover the linear value from the index, then apply the tone curve and gamma correction
+        auto const index_value = i * 1.0f / (lut_size - 1);
+        auto const compressed_value = (std::min)(index_value * index_value, 1.0f - math::numeric_epsilon());
+        auto const linear_value = Vec3f{compressed_value / (1.0f - compressed_value)};
+        auto const tone_mapped_value = (tone_curve == Tone_Curve::aces_fit) ? aces_fitted_tone_mapping(linear_value) : reinhard_tone_mapping(linear_value);
+        auto const display_value = math::clamp(gamma_correction(tone_mapped_value, gamma).x(), 0.0f, 1.0f);
+        m_lut[i] = display_value;
+        m_lut_8_bit[i] = static_cast<unsigned char>(display_value * 255.0f + 0.5f);
+    }
+}
+
+Vec3f Display_Transform::apply(Vec3f const& color) const { return Vec3f{m_lut[compute_lut_index(color.x())], m_lut[compute_lut_index(color.y())], m_lut[compute_lut_index(color.z())]}; }
+
+void Display_Transform::apply(float const* red, float const* green, float const* blue, std::size_t pixel_count, unsigned char* out_rgb) const
+{
+    // Process the pixels in blocks: first compute the indices of each channel in tight loops that get vectorized, then read the table
+    int red_indices[block_size];
+    int green_indices[block_size];
+    int blue_indices[block_size];
+    for (auto block_start = std::size_t{0}; block_start < pixel_count; block_start += block_size)
+    {
+        auto const count = static_cast<unsigned int>((std::min)(pixel_count - block_start, std::size_t{block_size}));
+        for (auto i = 0u; i < count; i++)
+            red_indices[i] = compute_lut_index(red[block_start + i]);
+        for (auto i = 0u; i < count; i++)
+            green_indices[i] = compute_lut_index(green[block_start + i]);
+        for (auto i = 0u; i < count; i++)
+            blue_indices[i] = compute_lut_index(blue[block_start + i]);
+        auto* block_rgb = out_rgb + 3 * block_start;
+        for (auto i = 0u; i < count; i++)
+        {
+            block_rgb[3 * i] = m_lut_8_bit[red_indices[i]];
+            block_rgb[3 * i + 1] = m_lut_8_bit[green_indices[i]];
+            block_rgb[3 * i + 2] = m_lut_8_bit[blue_indices[i]];
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <math/vec.h>
+
+#include <dll_defines.h>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+/**
+ * @brief Tone curves available to map linear HDR colors to the displayable 0-1 range.
+ */
+enum class DECLSPECIFIER Tone_Curve
+{
+    reinhard,
+    aces_fit
+};
+
+/**
+ * @brief Output stage converting the linear HDR colors of the framebuffer to display colors, applied once per pixel after shading.
+ * Tone mapping, gamma correction and quantization are baked into lookup tables, indexed by the square root of the compressed channel value x / (1 + x)
+ * (the square root spreads the entries over dark values, where gamma correction is steepest), so that the per-pixel cost is a division, a square root and a table read per channel.
+ */
+class Display_Transform
+{
+  public:
+    Display_Transform(Tone_Curve tone_curve = Tone_Curve::reinhard, float gamma = 2.2f);
+    ~Display_Transform() = default;
+    Display_Transform(Display_Transform const& other) = default;
+    Display_Transform& operator=(Display_Transform const& other) = default;
+
+    Tone_Curve get_tone_curve() const { return m_tone_curve; }
+
+    /**
+     * @brief Converts a single linear HDR color to a display color.
+     * @param[in] color. The linear HDR color.
+     * @return The display color, with components in the 0-1 range.
+     */
+    Vec3f apply(Vec3f const& color) const;
+
+    /**
+     * @brief Converts planar linear HDR channels to interleaved 8-bit RGB display values.
+     * @param[in] red. Red channel of each pixel.
+     * @param[in] green. Green channel of each pixel.
+     * @param[in] blue. Blue channel of each pixel.
+     * @param[in] pixel_count. Number of pixels to convert.
+     * @param[out] out_rgb. Output buffer of at least 3 * pixel_count bytes.
+     */
+    void apply(float const* red, float const* green, float const* blue, std::size_t pixel_count, unsigned char* out_rgb) const;
+
+  private:
+    static constexpr unsigned int lut_size = 4096;  // Number of entries in each lookup table
+    static constexpr unsigned int block_size = 256; // Number of pixels whose lookup table indices are computed together when converting planar channels
+
+    /**
+     * @brief Computes the lookup table index of a linear HDR channel value.
+     * @param[in] value. The linear HDR channel value.
+     * @return The index, in the 0 to (lut_size - 1) range.
+     */
+    static int compute_lut_index(float value)
+    {
+        // Negative values are clamped to zero, and the compression maps [0, +inf[ to [0, 1[
+        auto const positive_value = (value > 0.0f) ? value : 0.0f;
+        return static_cast<int>(std::sqrt(positive_value / (1.0f + positive_value)) * (lut_size - 1) + 0.5f);
+    }
+
+    Tone_Curve m_tone_curve;                         // Tone curve baked into the lookup tables
+    std::array<float, lut_size> m_lut;               // Display value, in the 0-1 range, for each compressed input value
+    std::array<unsigned char, lut_size> m_lut_8_bit; // Quantized display value for each compressed input value
+};
@@ -0,0 +1,178 @@
+#include "edit_footprints.h"
+
+#include <cmath>
+
+namespace
+{
+
+Vec3f component_min(Vec3f const& a, Vec3f const& b) { return Vec3f{(std::min)(a.x(), b.x()), (std::min)(a.y(), b.y()), (std::min)(a.z(), b.z())}; }
+Vec3f component_max(Vec3f const& a, Vec3f const& b) { return Vec3f{(std::max)(a.x(), b.x()), (std::max)(a.y(), b.y()), (std::max)(a.z(), b.z())}; }
+
+/**
+ * @brief Checks whether two axis-aligned boxes overlap.
+ * @param[in] a_min. Minimum corner of the first box.
+ * @param[in] a_max. Maximum corner of the first box.
+ * @param[in] b_min. Minimum corner of the second box.
+ * @param[in] b_max. Maximum corner of the second box.
+ * @return True if the boxes overlap, false otherwise.
+ */
+bool boxes_overlap(Vec3f const& a_min, Vec3f const& a_max, Vec3f const& b_min, Vec3f const& b_max)
+{
+    return a_min.x() <= b_max.x() && b_min.x() <= a_max.x() && a_min.y() <= b_max.y() && b_min.y() <= a_max.y() && a_min.z() <= b_max.z() && b_min.z() <= a_max.z();
+}
+
+/**
+ * @brief Checks whether an object's box may occlude shadow rays cast from a footprint's hit points towards a light, i.e. whether it overlaps the box bounding both the hit points and the light.
+ * @param[in] footprint. Footprint whose hit points cast the shadow rays.
+ * @param[in] light. Light towards which the shadow rays are cast.
+ * @param[in] box_min. Minimum corner of the object's box.
+ * @param[in] box_max. Maximum corner of the object's box.
+ * @return True if the object may occlude the shadow rays, false otherwise.
+ */
+bool may_occlude_light(Edit_Footprint const& footprint, Light const& light, Vec3f const& box_min, Vec3f const& box_max)
+{
+    if (light.is_positional())
+    {
+        auto const& position = light.get_position();
+        auto const radius = light.get_bounding_radius();
+        return boxes_overlap(component_min(footprint.shading_min, position - radius), component_max(footprint.shading_max, position + radius), box_min, box_max);
+    }
+    if (light.get_type() == Light_Type::directional)
+    {
+        // Sweep the hit points towards the light, far enough to pass the object's box
+        auto const sweep_length = (box_max - footprint.shading_min).length() + (footprint.shading_max - box_min).length();
+        auto const sweep = -light.get_direction() * sweep_length;
+        return boxes_overlap(component_min(footprint.shading_min, footprint.shading_min + sweep), component_max(footprint.shading_max, footprint.shading_max + sweep), box_min, box_max);
+    }
+    return false;
+}
+
+} // namespace
+
+void Edit_Footprints::resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_tile_column_count = (width + tile_size - 1) / tile_size;
+    m_tile_row_count = (height + tile_size - 1) / tile_size;
+    m_footprints.assign(static_cast<std::size_t>(height) * m_tile_column_count, Edit_Footprint{});
+}
+
+int Edit_Footprints::compute_dirty_tiles(Scene const& scene, Scene_Changes const& changes, Camera const& camera, std::vector<unsigned char>& out_dirty_tiles) const
+{
+    out_dirty_tiles.assign(static_cast<std::size_t>(m_tile_row_count) * m_tile_column_count, changes.is_global ? 1 : 0);
+    if (changes.is_global)
+        return static_cast<int>(out_dirty_tiles.size());
+    auto const& objects = scene.get_objects();
+    auto const& lights = scene.get_lights();
+
+    // Gather the masks of the changed objects and lights, and mark the tiles in which moved objects may now be seen directly
+    auto changed_object_mask = std::uint64_t{0};
+    auto changed_light_mask = std::uint64_t{0};
+    for (auto const index : changes.shaded_objects)
+        changed_object_mask |= Edit_Footprint::get_bit(index);
+    for (auto const index : changes.lights)
+        changed_light_mask |= Edit_Footprint::get_bit(index);
+    std::vector<Vec3f> moved_boxes;
+    for (auto const index : changes.moved_objects)
+    {
+        changed_object_mask |= Edit_Footprint::get_bit(index);
+        auto box_min = Vec3f::zero();
+        auto box_max = Vec3f::zero();
+        objects[index].get_primitive().compute_bounds(box_min, box_max);
+        mark_projected_box(box_min, box_max, camera, out_dirty_tiles);
+        moved_boxes.push_back(box_min);
+        moved_boxes.push_back(box_max);
+    }
+
+    // Mark the tiles that the changed objects and lights contributed to, or may now contribute to
+    auto const selection_mode = scene.get_light_selection_mode();
+    auto const radiance_threshold = scene.get_light_radiance_threshold();
+    auto const is_affected = [&](Edit_Footprint const& footprint) {
+        if ((footprint.object_mask & changed_object_mask) != 0 || (footprint.light_mask & changed_light_mask) != 0)
+            return true;
+        if (!footprint.has_shading_points())
+            return false;
+        // Moved objects may now appear in reflections, or occlude the lights of the hit points
+        if (!moved_boxes.empty() && footprint.has_secondary_rays)
+            return true;
+        for (auto box_it = 0u; box_it < moved_boxes.size(); box_it += 2)
+            for (auto light_it = 0u; light_it < lights.size(); light_it++)
+                if ((footprint.light_mask & Edit_Footprint::get_bit(light_it)) != 0 && may_occlude_light(footprint, lights[light_it], moved_boxes[box_it], moved_boxes[box_it + 1]))
+                    return true;
+        // Changed lights may now be selected by hit points that did not select them, every light being selected for every point in the all mode
+        for (auto const index : changes.lights)
+        {
+            if (selection_mode == Light_Selection_Mode::stochastic)
+                return true;
+            if (selection_mode == Light_Selection_Mode::culled)
+            {
+                auto const& light = lights[index];
+                auto const influence_radius = light.compute_influence_radius(radiance_threshold);
+                if (!light.is_positional() || std::isinf(influence_radius))
+                    return true;
+                auto const& position = light.get_position();
+                if (boxes_overlap(footprint.shading_min, footprint.shading_max, position - influence_radius, position + influence_radius))
+                    return true;
+            }
+        }
+        return false;
+    };
+    for (auto row = 0; row < m_height; row++)
+    {
+        for (auto tile_column = 0; tile_column < m_tile_column_count; tile_column++)
+        {
+            auto& is_dirty = out_dirty_tiles[(row / tile_size) * m_tile_column_count + tile_column];
+            if (!is_dirty && is_affected(m_footprints[row * m_tile_column_count + tile_column]))
+                is_dirty = 1;
+        }
+    }
+    auto dirty_tile_count = 0;
+    for (auto const is_dirty : out_dirty_tiles)
+        dirty_tile_count += is_dirty;
+    return dirty_tile_count;
+}
+
+void Edit_Footprints::clear_tiles(std::vector<unsigned char> const& tiles)
+{
+    for (auto row = 0; row < m_height; row++)
+        for (auto tile_column = 0; tile_column < m_tile_column_count; tile_column++)
+            if (tiles[(row / tile_size) * m_tile_column_count + tile_column])
+                m_footprints[row * m_tile_column_count + tile_column] = Edit_Footprint{};
+}
+
+void Edit_Footprints::mark_projected_box(Vec3f const& box_min, Vec3f const& box_max, Camera const& camera, std::vector<unsigned char>& dirty_tiles) const
+{
+    // Project the box's corners through the near plane, as camera rays are cast, the whole framebuffer being affected if the box crosses the plane
+    auto const near_plane = camera.get_near();
+    auto column_min = (std::numeric_limits<float>::max)();
+    auto column_max = (std::numeric_limits<float>::lowest)();
+    auto row_min = (std::numeric_limits<float>::max)();
+    auto row_max = (std::numeric_limits<float>::lowest)();
+    for (auto corner = 0u; corner < 8; corner++)
+    {
+        auto const position = Vec3f{(corner & 1) ? box_max.x() : box_min.x(), (corner & 2) ? box_max.y() : box_min.y(), (corner & 4) ? box_max.z() : box_min.z()};
+        auto const direction = camera.to_view_space(position);
+        if (direction.z() <= near_plane)
+        {
+            std::fill(dirty_tiles.begin(), dirty_tiles.end(), 1);
+            return;
+        }
+        auto const column = (near_plane * direction.x() / direction.z() + 0.5f) * (m_width - 1);
+        auto const row = (near_plane * direction.y() / direction.z() + 0.5f) * (m_height - 1);
+        column_min = (std::min)(column_min, column);
+        column_max = (std::max)(column_max, column);
+        row_min = (std::min)(row_min, row);
+        row_max = (std::max)(row_max, row);
+    }
+    // Widen the covered pixels by one, camera rays being jittered within their pixel
+    auto const first_column = (std::max)(static_cast<int>(std::floor(column_min)) - 1, 0);
+    auto const last_column = (std::min)(static_cast<int>(std::ceil(column_max)) + 1, m_width - 1);
+    auto const first_row = (std::max)(static_cast<int>(std::floor(row_min)) - 1, 0);
+    auto const last_row = (std::min)(static_cast<int>(std::ceil(row_max)) + 1, m_height - 1);
+    if (first_column > last_column || first_row > last_row)
+        return;
+    for (auto tile_row = first_row / tile_size; tile_row <= last_row / tile_size; tile_row++)
+        for (auto tile_column = first_column / tile_size; tile_column <= last_column / tile_size; tile_column++)
+            dirty_tiles[tile_row * m_tile_column_count + tile_column] = 1;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <graphics/camera.h>
+#include <graphics/light.h>
+#include <graphics/light_tree.h>
+#include <graphics/scene.h>
+#include <math/vec.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Scene elements that contributed to the pixels of one row of a tile, recorded while they are sampled.
+ * Objects and lights past the 63rd share the last bit of their mask, which keeps the record conservative.
+ */
+struct Edit_Footprint
+{
+    std::uint64_t object_mask = 0;                                     // Objects hit by the pixels' rays or occluding their shadow rays, one bit per object
+    std::uint64_t light_mask = 0;                                      // Lights selected to shade the pixels' hit points, one bit per light
+    Vec3f shading_min = Vec3f{(std::numeric_limits<float>::max)()};    // Minimum corner of the box bounding the pixels' hit points
+    Vec3f shading_max = Vec3f{(std::numeric_limits<float>::lowest)()}; // Maximum corner of the box bounding the pixels' hit points
+    bool has_secondary_rays = false;                                   // Whether the pixels traced reflection or bounce rays, which a moved object may now hit
+
+    /**
+     * @brief Gets the bit standing for the object or light at the given index in the masks.
+     * @param[in] index. Index of the object or light.
+     * @return The bit.
+     */
+    static std::uint64_t get_bit(std::size_t index) { return std::uint64_t{1} << (std::min)(index, std::size_t{63}); }
+
+    /**
+     * @brief Records an object hit by a ray of the pixels or occluding one of their shadow rays.
+     * @param[in] index. Index of the object in the scene.
+     */
+    void record_object(std::size_t index) { object_mask |= get_bit(index); }
+
+    /**
+     * @brief Records a hit point shaded for the pixels, along with the lights selected for it.
+     * @param[in] position. World-space position of the hit point.
+     * @param[in] selected_lights. Lights selected for the hit point.
+     * @param[in] scene_lights. First light of the scene, from which the lights' indices are computed.
+     */
+    void record_shading_point(Vec3f const& position, std::vector<Light_Sample> const& selected_lights, Light const* scene_lights)
+    {
+        shading_min = Vec3f{(std::min)(shading_min.x(), position.x()), (std::min)(shading_min.y(), position.y()), (std::min)(shading_min.z(), position.z())};
+        shading_max = Vec3f{(std::max)(shading_max.x(), position.x()), (std::max)(shading_max.y(), position.y()), (std::max)(shading_max.z(), position.z())};
+        for (auto const& sample : selected_lights)
+            light_mask |= get_bit(static_cast<std::size_t>(sample.light - scene_lights));
+    }
+
+    /**
+     * @brief Checks whether any hit point was shaded for the pixels, i.e. whether they show anything but the background.
+     * @return True if a hit point was recorded, false otherwise.
+     */
+    bool has_shading_points() const { return shading_min.x() <= shading_max.x(); }
+};
+
+/**
+ * @brief Footprints of the scene's objects and lights in the framebuffer, from which the tiles affected by an edit of the scene are found, so that only they are rendered again.
+ * A tile is affected by an edited object or light if its pixels hit, were shadowed by or were lit by it. A moved object also affects the tiles covered by its projected bounds,
+ * the tiles tracing reflection or bounce rays, and the tiles whose shadow rays may cross its new bounds. A changed light also affects the tiles within its new radius of influence.
+ */
+class Edit_Footprints
+{
+  public:
+    Edit_Footprints() = default;
+    ~Edit_Footprints() = default;
+    Edit_Footprints(Edit_Footprints const& other) = default;
+    Edit_Footprints& operator=(Edit_Footprints const& other) = default;
+
+    /**
+     * @brief Resizes the footprints to the framebuffer's size, clearing them.
+     * @param[in] width. Width of the framebuffer, in pixels.
+     * @param[in] height. Height of the framebuffer, in pixels.
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Gets the footprint in which to record the contributions to a pixel. Different threads may record different rows concurrently.
+     * @param[in] column. Column of the pixel.
+     * @param[in] row. Row of the pixel.
+     * @return The footprint of the pixel's row of tile.
+     */
+    Edit_Footprint& get_footprint(int column, int row) { return m_footprints[row * m_tile_column_count + column / tile_size]; }
+
+    /**
+     * @brief Gets the index of the tile containing a pixel.
+     * @param[in] column. Column of the pixel.
+     * @param[in] row. Row of the pixel.
+     * @return The index of the tile.
+     */
+    int get_tile_index(int column, int row) const { return (row / tile_size) * m_tile_column_count + column / tile_size; }
+
+    /**
+     * @brief Finds the tiles affected by the given changes of the scene.
+     * @param[in] scene. Scene after the changes.
+     * @param[in] changes. Changes of the scene since the footprints were recorded.
+     * @param[in] camera. Camera with which the footprints were recorded.
+     * @param[out] out_dirty_tiles. Whether each tile is affected by the changes.
+     * @return The number of affected tiles.
+     */
+    int compute_dirty_tiles(Scene const& scene, Scene_Changes const& changes, Camera const& camera, std::vector<unsigned char>& out_dirty_tiles) const;
+
+    /**
+     * @brief Clears the footprints of the given tiles, before they are rendered again.
+     * @param[in] tiles. Whether each tile must be cleared.
+     */
+    void clear_tiles(std::vector<unsigned char> const& tiles);
+
+  private:
+    /**
+     * @brief Marks the tiles covered by the projection of a box, all of them if the box crosses the camera's near plane.
+     * @param[in] box_min. Minimum corner of the box.
+     * @param[in] box_max. Maximum corner of the box.
+     * @param[in] camera. Camera through which the box is seen.
+     * @param[in,out] dirty_tiles. Whether each tile is affected, set for the covered tiles.
+     */
+    void mark_projected_box(Vec3f const& box_min, Vec3f const& box_max, Camera const& camera, std::vector<unsigned char>& dirty_tiles) const;
+
+    static constexpr int tile_size = 8; // Width and height of the tiles rendered again after an edit
+
+    int m_width = 0;                          // Width of the framebuffer, in pixels
+    int m_height = 0;                         // Height of the framebuffer, in pixels
+    int m_tile_column_count = 0;              // Number of columns of tiles
+    int m_tile_row_count = 0;                 // Number of rows of tiles
+    std::vector<Edit_Footprint> m_footprints; // Footprint of each row of each tile, stored row after row
+};
@@ -0,0 +1,166 @@
+#include "framebuffer.h"
+
+#include <math/math.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+void Framebuffer::resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    auto const pixel_count = static_cast<std::size_t>(width) * height;
+    m_red.assign(pixel_count, 0.0f);
+    m_green.assign(pixel_count, 0.0f);
+    m_blue.assign(pixel_count, 0.0f);
+    m_sample_counts.clear();
+    m_luminance_means.clear();
+    m_luminance_squared_deviations.clear();
+    for (auto type_it = 0u; type_it < aov_type_count; type_it++)
+        set_aov_enabled(static_cast<AOV_Type>(type_it), m_enabled_aovs[type_it]);
+}
+
+void Framebuffer::resample(int width, int height)
+{
+    auto const previous_width = m_width;
+    auto const previous_height = m_height;
+    std::array<std::vector<float>, 3> previous_colors;
+    previous_colors[0].swap(m_red);
+    previous_colors[1].swap(m_green);
+    previous_colors[2].swap(m_blue);
+    resize(width, height);
+    if (previous_width <= 0 || previous_height <= 0)
+        return;
+
+    // Pixel centers are mapped between both sizes, and each new pixel interpolates the four previous pixels around its center
+    std::array<float*, 3> colors{m_red.data(), m_green.data(), m_blue.data()};
+    auto const scale_x = previous_width * 1.0f / width;
+    auto const scale_y = previous_height * 1.0f / height;
+    for (auto j = 0; j < height; j++)
+    {
+        auto const y = math::clamp((j + 0.5f) * scale_y - 0.5f, 0.0f, previous_height - 1.0f);
+        auto const y0 = static_cast<int>(y);
+        auto const y1 = (std::min)(y0 + 1, previous_height - 1);
+        auto const ty = y - y0;
+        for (auto i = 0; i < width; i++)
+        {
+            auto const x = math::clamp((i + 0.5f) * scale_x - 0.5f, 0.0f, previous_width - 1.0f);
+            auto const x0 = static_cast<int>(x);
+            auto const x1 = (std::min)(x0 + 1, previous_width - 1);
+            auto const tx = x - x0;
+            for (auto channel = 0u; channel < 3; channel++)
+            {
+                auto const* previous = previous_colors[channel].data();
+                auto const top = math::linear_interpolation(previous[y0 * previous_width + x0], previous[y0 * previous_width + x1], tx);
+                auto const bottom = math::linear_interpolation(previous[y1 * previous_width + x0], previous[y1 * previous_width + x1], tx);
+                colors[channel][j * width + i] = math::linear_interpolation(top, bottom, ty);
+            }
+        }
+    }
+}
+
+void Framebuffer::set_aov_enabled(AOV_Type type, bool enabled)
+{
+    m_enabled_aovs[static_cast<std::size_t>(type)] = enabled;
+    m_has_aovs = std::find(m_enabled_aovs.begin(), m_enabled_aovs.end(), true) != m_enabled_aovs.end();
+    auto const pixel_count = enabled ? static_cast<std::size_t>(get_pixel_count()) : 0;
+    auto const resize_channel = [&](auto& channel, auto value) {
+        channel.assign(pixel_count, value);
+        // Release the memory of disabled AOVs
+        if (!enabled)
+            channel.shrink_to_fit();
+    };
+    switch (type)
+    {
+    case AOV_Type::depth:
+        resize_channel(m_depths, 0.0f);
+        break;
+    case AOV_Type::normal:
+        for (auto& normal_axis : m_normals)
+            resize_channel(normal_axis, 0.0f);
+        break;
+    case AOV_Type::albedo:
+        for (auto& albedo_channel : m_albedos)
+            resize_channel(albedo_channel, 1.0f);
+        break;
+    case AOV_Type::object_id:
+        resize_channel(m_object_ids, -1);
+        break;
+    case AOV_Type::direct_lighting:
+        for (auto& lighting_channel : m_direct_lightings)
+            resize_channel(lighting_channel, 0.0f);
+        break;
+    }
+}
+
+void Framebuffer::write_channels(std::ostream& stream) const
+{
+    // List the stored channels along with their names
+    std::vector<std::pair<char const*, float const*>> channels{{"color.r", get_red()}, {"color.g", get_green()}, {"color.b", get_blue()}};
+    if (is_aov_enabled(AOV_Type::depth))
+        channels.push_back({"depth", get_depth()});
+    if (is_aov_enabled(AOV_Type::normal))
+        channels.insert(channels.end(), {{"normal.x", get_normal(0)}, {"normal.y", get_normal(1)}, {"normal.z", get_normal(2)}});
+    if (is_aov_enabled(AOV_Type::albedo))
+        channels.insert(channels.end(), {{"albedo.r", get_albedo(0)}, {"albedo.g", get_albedo(1)}, {"albedo.b", get_albedo(2)}});
+    std::vector<float> object_ids;
+    if (is_aov_enabled(AOV_Type::object_id))
+    {
+        object_ids.assign(m_object_ids.begin(), m_object_ids.end());
+        channels.push_back({"object_id", object_ids.data()});
+    }
+    if (is_aov_enabled(AOV_Type::direct_lighting))
+        channels.insert(channels.end(), {{"direct_lighting.r", get_direct_lighting(0)}, {"direct_lighting.g", get_direct_lighting(1)}, {"direct_lighting.b", get_direct_lighting(2)}});
+
+    // Write the header, then each channel's planar values
+    stream << "AOV\n" << m_width << " " << m_height << " " << channels.size() << "\n";
+    for (auto const& channel : channels)
+        stream << channel.first << "\n";
+    for (auto const& channel : channels)
+        stream.write(reinterpret_cast<char const*>(channel.second), static_cast<std::streamsize>(get_pixel_count()) * sizeof(float));
+}
+
+void Framebuffer::copy_pixel(int source_index, int target_index)
+{
+    m_red[target_index] = m_red[source_index];
+    m_green[target_index] = m_green[source_index];
+    m_blue[target_index] = m_blue[source_index];
+    if (is_aov_enabled(AOV_Type::depth))
+        m_depths[target_index] = m_depths[source_index];
+    if (is_aov_enabled(AOV_Type::object_id))
+        m_object_ids[target_index] = m_object_ids[source_index];
+    for (auto channel = 0u; channel < 3; channel++)
+    {
+        if (is_aov_enabled(AOV_Type::normal))
+            m_normals[channel][target_index] = m_normals[channel][source_index];
+        if (is_aov_enabled(AOV_Type::albedo))
+            m_albedos[channel][target_index] = m_albedos[channel][source_index];
+        if (is_aov_enabled(AOV_Type::direct_lighting))
+            m_direct_lightings[channel][target_index] = m_direct_lightings[channel][source_index];
+    }
+}
+
+void Framebuffer::reset_sample_statistics()
+{
+    auto const pixel_count = static_cast<std::size_t>(get_pixel_count());
+    std::fill(m_red.begin(), m_red.end(), 0.0f);
+    std::fill(m_green.begin(), m_green.end(), 0.0f);
+    std::fill(m_blue.begin(), m_blue.end(), 0.0f);
+    m_sample_counts.assign(pixel_count, 0);
+    m_luminance_means.assign(pixel_count, 0.0f);
+    m_luminance_squared_deviations.assign(pixel_count, 0.0f);
+}
+
+float Framebuffer::compute_relative_error(int index) const
+{
+    // Luminance below which errors are measured in absolute rather than relative terms, so that dark pixels do not take the whole budget
+    auto constexpr min_luminance = 0.05f;
+    auto const sample_count = m_sample_counts[index];
+    if (sample_count < 2)
+        return math::numeric_infinity();
+    auto const variance_of_mean = m_luminance_squared_deviations[index] / (static_cast<float>(sample_count) * (sample_count - 1));
+    auto const confidence_half_width = 1.96f * std::sqrt((std::max)(variance_of_mean, 0.0f));
+    return confidence_half_width / (std::max)(m_luminance_means[index], min_luminance);
+}
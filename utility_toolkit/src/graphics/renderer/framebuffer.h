@@ -0,0 +1,238 @@
+#pragma once
+
+#include <math/vec.h>
+
+#include <dll_defines.h>
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Arbitrary output variables, i.e. per-pixel channels describing the surface seen through each pixel, stored alongside the colors for compositing and post-processing.
+ */
+enum class DECLSPECIFIER AOV_Type
+{
+    depth,     // Distance from the camera to the surface (one channel)
+    normal,    // World-space normal of the surface (three channels)
+    albedo,    // Linear albedo of the surface (three channels)
+    object_id, // Index of the object in the scene, or -1 for the background (one channel)
+    direct_lighting // Light reflected by the surface from the scene's lights, without reflections and indirect lighting (three channels)
+};
+
+auto constexpr aov_type_count = 5u; // Number of values of AOV_Type
+
+/**
+ * @brief Surface data of the first intersection of a camera ray with the scene, used to guide post-processing.
+ */
+struct Primary_Hit
+{
+    Vec3f normal = Vec3f::zero();          // World-space normal of the surface, or zero if the ray hits nothing
+    Vec3f albedo = Vec3f::one();           // Linear albedo of the surface, or one if the ray hits nothing
+    float depth = 0.0f;                    // Distance from the camera to the surface, or the camera's far distance if the ray hits nothing
+    int object_id = -1;                    // Index of the intersected object in the scene, or -1 if the ray hits nothing
+    Vec3f direct_lighting = Vec3f::zero(); // Light reflected by the surface from the scene's lights, or zero if the ray hits nothing
+    Vec3f position = Vec3f::zero();        // World-space position of the surface, or zero if the ray hits nothing
+    float reflective_intensity = 0.0f;     // Weight of the mirror reflection in the surface's color, measuring how much the color depends on the view direction
+};
+
+/**
+ * @brief CPU framebuffer storing linear HDR colors in planar layout (one contiguous array per channel), so that per-pixel passes over it can be vectorized.
+ * Pixels are indexed as (row * width + column), row zero being the bottom of the image.
+ * The framebuffer can also store arbitrary output variables (AOVs) describing the surface seen through each pixel, in the same planar layout. Each AOV is allocated and written only when enabled.
+ */
+class Framebuffer
+{
+  public:
+    Framebuffer() = default;
+    ~Framebuffer() = default;
+    Framebuffer(Framebuffer const& other) = default;
+    Framebuffer& operator=(Framebuffer const& other) = default;
+
+    int get_width() const { return m_width; }
+    int get_height() const { return m_height; }
+    int get_pixel_count() const { return m_width * m_height; }
+
+    float const* get_red() const { return m_red.data(); }
+    float const* get_green() const { return m_green.data(); }
+    float const* get_blue() const { return m_blue.data(); }
+    float* get_red() { return m_red.data(); }
+    float* get_green() { return m_green.data(); }
+    float* get_blue() { return m_blue.data(); }
+
+    bool is_aov_enabled(AOV_Type type) const { return m_enabled_aovs[static_cast<std::size_t>(type)]; }
+    bool has_aovs() const { return m_has_aovs; }
+    float const* get_depth() const { return m_depths.data(); }
+    float const* get_normal(unsigned int axis) const { return m_normals[axis].data(); }
+    float const* get_albedo(unsigned int channel) const { return m_albedos[channel].data(); }
+    int const* get_object_ids() const { return m_object_ids.data(); }
+    float const* get_direct_lighting(unsigned int channel) const { return m_direct_lightings[channel].data(); }
+
+    /**
+     * @brief Checks whether the framebuffer stores the AOVs guiding the denoiser (depth, normal, albedo and object id).
+     * @return True if all guides are stored, false otherwise.
+     */
+    bool has_guides() const
+    {
+        return is_aov_enabled(AOV_Type::depth) && is_aov_enabled(AOV_Type::normal) && is_aov_enabled(AOV_Type::albedo) && is_aov_enabled(AOV_Type::object_id);
+    }
+
+    /**
+     * @brief Enables or disables the storage of an AOV, allocating or releasing its channels.
+     * @param[in] type. The AOV to enable or disable.
+     * @param[in] enabled. Whether the AOV should be stored.
+     */
+    void set_aov_enabled(AOV_Type type, bool enabled);
+
+    /**
+     * @brief Stores the enabled AOVs of a pixel. Different threads may write different pixels concurrently.
+     * @param[in] index. Index of the pixel.
+     * @param[in] hit. Surface data of the first intersection seen through the pixel.
+     */
+    void set_aovs(int index, Primary_Hit const& hit)
+    {
+        if (is_aov_enabled(AOV_Type::depth))
+            m_depths[index] = hit.depth;
+        if (is_aov_enabled(AOV_Type::normal))
+        {
+            m_normals[0][index] = hit.normal.x();
+            m_normals[1][index] = hit.normal.y();
+            m_normals[2][index] = hit.normal.z();
+        }
+        if (is_aov_enabled(AOV_Type::albedo))
+        {
+            m_albedos[0][index] = hit.albedo.x();
+            m_albedos[1][index] = hit.albedo.y();
+            m_albedos[2][index] = hit.albedo.z();
+        }
+        if (is_aov_enabled(AOV_Type::object_id))
+            m_object_ids[index] = hit.object_id;
+        if (is_aov_enabled(AOV_Type::direct_lighting))
+        {
+            m_direct_lightings[0][index] = hit.direct_lighting.x();
+            m_direct_lightings[1][index] = hit.direct_lighting.y();
+            m_direct_lightings[2][index] = hit.direct_lighting.z();
+        }
+    }
+
+    /**
+     * @brief Writes the colors and the enabled AOVs to a single multi-channel file.
+     * The file starts with the text header "AOV\n<width> <height> <channel count>\n", followed by one line per channel giving its name (e.g. "color.r", "depth", "normal.x"),
+     * then by the channels' values as little-endian 32-bit floats, one channel after the other, each channel storing its rows from the bottom one to the top one.
+     * Object ids are stored as floats, which represent them exactly.
+     * @param[out] stream. Binary stream to write to.
+     */
+    void write_channels(std::ostream& stream) const;
+
+    /**
+     * @brief Resizes the framebuffer, clearing all pixels to black.
+     * @param[in] width. New width, in pixels.
+     * @param[in] height. New height, in pixels.
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Resizes the framebuffer, filling its colors by bilinear interpolation of the previous colors, so that they can be shown until new ones are computed.
+     * Sample statistics are discarded and AOVs are cleared, like on resize.
+     * @param[in] width. New width, in pixels.
+     * @param[in] height. New height, in pixels.
+     */
+    void resample(int width, int height);
+
+    /**
+     * @brief Stores the color of a pixel. Different threads may write different pixels concurrently.
+     * @param[in] index. Index of the pixel.
+     * @param[in] color. Linear color of the pixel.
+     */
+    void set_color(int index, Vec3f const& color)
+    {
+        m_red[index] = color.x();
+        m_green[index] = color.y();
+        m_blue[index] = color.z();
+    }
+
+    /**
+     * @brief Gets the color of a pixel.
+     * @param[in] index. Index of the pixel.
+     * @return The linear color of the pixel.
+     */
+    Vec3f get_color(int index) const { return Vec3f{m_red[index], m_green[index], m_blue[index]}; }
+
+    /**
+     * @brief Copies the color and the enabled AOVs of a pixel to another pixel, e.g. to duplicate a view rendered once.
+     * @param[in] source_index. Index of the copied pixel.
+     * @param[in] target_index. Index of the written pixel.
+     */
+    void copy_pixel(int source_index, int target_index);
+
+    /**
+     * @brief Clears all pixels to black and resets their sample statistics, allocating the statistics on first use.
+     */
+    void reset_sample_statistics();
+
+    /**
+     * @brief Clears a pixel to black and resets its sample statistics, e.g. to render it again from scratch.
+     * @param[in] index. Index of the pixel.
+     */
+    void reset_sample_statistics(int index)
+    {
+        m_red[index] = 0.0f;
+        m_green[index] = 0.0f;
+        m_blue[index] = 0.0f;
+        m_sample_counts[index] = 0;
+        m_luminance_means[index] = 0.0f;
+        m_luminance_squared_deviations[index] = 0.0f;
+    }
+
+    /**
+     * @brief Adds a sample to a pixel, whose color becomes the running mean of its samples, and updates the running variance of its luminance (Welford's algorithm).
+     * Different threads may add samples to different pixels concurrently. Requires reset_sample_statistics to have been called since the last resize.
+     * @param[in] index. Index of the pixel.
+     * @param[in] color. Linear color of the sample.
+     */
+    void add_sample(int index, Vec3f const& color)
+    {
+        auto const sample_count = ++m_sample_counts[index];
+        auto const inverse_count = 1.0f / sample_count;
+        m_red[index] += (color.x() - m_red[index]) * inverse_count;
+        m_green[index] += (color.y() - m_green[index]) * inverse_count;
+        m_blue[index] += (color.z() - m_blue[index]) * inverse_count;
+        auto const luminance = 0.2126f * color.x() + 0.7152f * color.y() + 0.0722f * color.z();
+        auto const delta = luminance - m_luminance_means[index];
+        m_luminance_means[index] += delta * inverse_count;
+        m_luminance_squared_deviations[index] += delta * (luminance - m_luminance_means[index]);
+    }
+
+    /**
+     * @brief Gets the number of samples added to a pixel since the statistics were last reset.
+     * @param[in] index. Index of the pixel.
+     * @return The pixel's sample count.
+     */
+    std::uint32_t get_sample_count(int index) const { return m_sample_counts[index]; }
+
+    /**
+     * @brief Computes the half-width of the 95% confidence interval of a pixel's mean luminance, relative to the mean luminance.
+     * @param[in] index. Index of the pixel.
+     * @return The relative error of the pixel, or infinity if it has fewer than two samples.
+     */
+    float compute_relative_error(int index) const;
+
+  private:
+    int m_width = 0;                                      // Width of the framebuffer, in pixels
+    int m_height = 0;                                     // Height of the framebuffer, in pixels
+    std::vector<float> m_red;                             // Red channel of each pixel
+    std::vector<float> m_green;                           // Green channel of each pixel
+    std::vector<float> m_blue;                            // Blue channel of each pixel
+    std::vector<std::uint32_t> m_sample_counts;           // Number of samples of each pixel
+    std::vector<float> m_luminance_means;                 // Running mean of the luminance of each pixel's samples
+    std::vector<float> m_luminance_squared_deviations;    // Running sum of squared deviations from the mean of the luminance of each pixel's samples
+    std::array<bool, aov_type_count> m_enabled_aovs{};    // Whether each AOV is stored
+    bool m_has_aovs = false;                              // Whether any AOV is stored
+    std::vector<float> m_depths;                          // Depth of the surface seen through each pixel
+    std::array<std::vector<float>, 3> m_normals;          // World-space normal of the surface seen through each pixel, one array per axis
+    std::array<std::vector<float>, 3> m_albedos;          // Linear albedo of the surface seen through each pixel, one array per channel
+    std::vector<int> m_object_ids;                        // Index of the object seen through each pixel, or -1 for the background
+    std::array<std::vector<float>, 3> m_direct_lightings; // Direct lighting of the surface seen through each pixel, one array per channel
+};
+
@@ -0,0 +1,512 @@
+#include "rasterizer.h"
+
+#include <geometry/primitive.h>
+#include <math/vec.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include <emmintrin.h>
+
+namespace
+{
+
+/**
+ * @brief Splits a range of items into contiguous ranges of similar sizes, each processed by its own worker thread.
+ * @param[in] item_count. Number of items.
+ * @param[in] worker_pool. Worker threads processing the ranges, or nullptr to process the whole range on the calling thread.
+ * @param[in] process_range. Function processing the items from a first one to the one before an end one, given the index of its thread.
+ */
+void process_on_threads(std::size_t item_count, Worker_Pool* worker_pool, std::function<void(std::size_t, std::size_t, unsigned int)> const& process_range)
+{
+    if (worker_pool == nullptr || worker_pool->get_thread_count() <= 1)
+    {
+        process_range(0, item_count, 0);
+        return;
+    }
+    auto const thread_count = worker_pool->get_thread_count();
+    worker_pool->run([&](unsigned int thread_index) { process_range(item_count * thread_index / thread_count, item_count * (thread_index + 1) / thread_count, thread_index); });
+}
+
+auto constexpr min_threaded_texel_count = 1 << 14; // Number of texels of a level of the depth pyramid from which it is computed by several threads
+
+} // namespace
+
+void Rasterizer::set_scene(Scene const& scene, unsigned int sphere_segment_count)
+{
+    m_vertices.clear();
+    m_object_indices.clear();
+    m_object_first_triangles.clear();
+    m_object_bounds.clear();
+    auto const& objects = scene.get_objects();
+    for (auto object_it = 0u; object_it < objects.size(); object_it++)
+    {
+        auto const first_vertex = m_vertices.size();
+        m_object_first_triangles.push_back(first_vertex / 3);
+        objects[object_it].get_primitive().tessellate(sphere_segment_count, m_vertices);
+        m_object_indices.resize(m_vertices.size() / 3, static_cast<int>(object_it));
+        // Bound the triangles rather than the primitive, so that the bounds contain all rasterized pixels
+        auto box_min = Vec3f{(std::numeric_limits<float>::max)()};
+        auto box_max = Vec3f{(std::numeric_limits<float>::lowest)()};
+        for (auto vertex_it = first_vertex; vertex_it < m_vertices.size(); vertex_it++)
+        {
+            auto const& vertex = m_vertices[vertex_it];
+            box_min = Vec3f{(std::min)(box_min.x(), vertex.x()), (std::min)(box_min.y(), vertex.y()), (std::min)(box_min.z(), vertex.z())};
+            box_max = Vec3f{(std::max)(box_max.x(), vertex.x()), (std::max)(box_max.y(), vertex.y()), (std::max)(box_max.z(), vertex.z())};
+        }
+        m_object_bounds.push_back(box_min);
+        m_object_bounds.push_back(box_max);
+    }
+    m_object_first_triangles.push_back(m_vertices.size() / 3);
+}
+
+void Rasterizer::rasterize(Camera const& camera, int width, int height, culling::Type culling, Worker_Pool& worker_pool)
+{
+    m_width = width;
+    m_height = height;
+    m_tile_column_count = (width + tile_size - 1) / tile_size;
+    m_tile_row_count = (height + tile_size - 1) / tile_size;
+    m_camera = camera;
+    m_far_inverse_depth = 1.0f / camera.get_far();
+    auto const pixel_count = static_cast<std::size_t>(width) * height;
+    m_triangle_ids.resize(pixel_count);
+    m_barycentrics.resize(pixel_count, Vec2f::zero());
+
+    // Without occlusion culling, every object is drawn in a single pass
+    auto const object_count = m_object_bounds.size() / 2;
+    m_occlusion_statistics = Occlusion_Statistics{};
+    m_object_passes.assign(object_count, Object_Pass::remaining);
+    if (m_is_occlusion_culling_enabled)
+    {
+        // Draw the objects whose bounds cover a large part of the screen first, as occluders
+        m_projected_bounds.resize(object_count);
+        process_on_threads(object_count, &worker_pool, [this](std::size_t first_object, std::size_t end_object, unsigned int) { project_object_bounds(first_object, end_object); });
+        for (auto object_it = 0u; object_it < object_count; object_it++)
+        {
+            if (m_object_passes[object_it] == Object_Pass::occluders)
+                m_occlusion_statistics.occluder_count++;
+            else if (m_object_passes[object_it] == Object_Pass::culled)
+            {
+                m_occlusion_statistics.culled_object_count++;
+                m_occlusion_statistics.culled_triangle_count += m_object_first_triangles[object_it + 1] - m_object_first_triangles[object_it];
+            }
+        }
+    }
+    if (m_occlusion_statistics.occluder_count == 0)
+    {
+        draw_pass(camera, culling, Object_Pass::remaining, true, true, worker_pool);
+        return;
+    }
+    m_depth_pyramid.resize(1);
+    m_depth_pyramid[0].width = width;
+    m_depth_pyramid[0].height = height;
+    m_depth_pyramid[0].inverse_depths.resize(pixel_count);
+    draw_pass(camera, culling, Object_Pass::occluders, true, false, worker_pool);
+
+    // Reduce the occluders' depths into the pyramid, down to a single texel
+    while (m_depth_pyramid.back().width > 1 || m_depth_pyramid.back().height > 1)
+    {
+        auto const& below = m_depth_pyramid.back();
+        Depth_Level level;
+        level.width = (below.width + 1) / 2;
+        level.height = (below.height + 1) / 2;
+        level.inverse_depths.resize(static_cast<std::size_t>(level.width) * level.height);
+        m_depth_pyramid.push_back(std::move(level));
+        auto const level_index = m_depth_pyramid.size() - 1;
+        auto const& built = m_depth_pyramid.back();
+        auto* const level_worker_pool = (built.width * built.height >= min_threaded_texel_count) ? &worker_pool : nullptr;
+        process_on_threads(built.height, level_worker_pool, [this, level_index](std::size_t first_row, std::size_t end_row, unsigned int) { build_depth_level(level_index, first_row, end_row); });
+    }
+
+    // Cull the other objects hidden by the occluders, then draw the remaining ones on top of the occluders
+    std::vector<Occlusion_Statistics> thread_statistics(worker_pool.get_thread_count());
+    process_on_threads(object_count, &worker_pool, [this, &thread_statistics](std::size_t first_object, std::size_t end_object, unsigned int thread_it) { cull_hidden_objects(first_object, end_object, thread_statistics[thread_it]); });
+    for (auto const& statistics : thread_statistics)
+    {
+        m_occlusion_statistics.culled_object_count += statistics.culled_object_count;
+        m_occlusion_statistics.culled_triangle_count += statistics.culled_triangle_count;
+    }
+    draw_pass(camera, culling, Object_Pass::remaining, false, true, worker_pool);
+}
+
+void Rasterizer::project_object_bounds(std::size_t first_object, std::size_t end_object)
+{
+    auto const clip_depth = m_camera.compute_min_ray_depth();
+    auto const near_plane = m_camera.get_near();
+    auto const column_scale = static_cast<float>(m_width - 1);
+    auto const row_scale = static_cast<float>(m_height - 1);
+    auto const screen_area = static_cast<float>(m_width) * m_height;
+    for (auto object_it = first_object; object_it < end_object; object_it++)
+    {
+        auto const& box_min = m_object_bounds[2 * object_it];
+        auto const& box_max = m_object_bounds[2 * object_it + 1];
+        auto& pass = m_object_passes[object_it];
+        auto& bounds = m_projected_bounds[object_it];
+        std::array<Vec3f, 8> view_corners{Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero()};
+        auto nearest_depth = (std::numeric_limits<float>::max)();
+        auto farthest_depth = (std::numeric_limits<float>::lowest)();
+        for (auto corner = 0u; corner < 8; corner++)
+        {
+            auto const position = Vec3f{(corner & 1) ? box_max.x() : box_min.x(), (corner & 2) ? box_max.y() : box_min.y(), (corner & 4) ? box_max.z() : box_min.z()};
+            view_corners[corner] = m_camera.to_view_space(position);
+            nearest_depth = (std::min)(nearest_depth, view_corners[corner].z());
+            farthest_depth = (std::max)(farthest_depth, view_corners[corner].z());
+        }
+        // Objects entirely nearer than the clipping plane cannot be seen, and those crossing it may cover any pixel, so draw them as occluders
+        if (farthest_depth < clip_depth)
+        {
+            pass = Object_Pass::culled;
+            continue;
+        }
+        if (nearest_depth < clip_depth)
+        {
+            pass = Object_Pass::occluders;
+            continue;
+        }
+
+        // Project the box's corners, the columns and rows of the box's projection being reached in its corners
+        auto column_min = (std::numeric_limits<float>::max)();
+        auto column_max = (std::numeric_limits<float>::lowest)();
+        auto row_min = (std::numeric_limits<float>::max)();
+        auto row_max = (std::numeric_limits<float>::lowest)();
+        for (auto const& vertex : view_corners)
+        {
+            auto const column = (near_plane * vertex.x() / vertex.z() + 0.5f) * column_scale;
+            auto const row = (near_plane * vertex.y() / vertex.z() + 0.5f) * row_scale;
+            column_min = (std::min)(column_min, column);
+            column_max = (std::max)(column_max, column);
+            row_min = (std::min)(row_min, row);
+            row_max = (std::max)(row_max, row);
+        }
+
+        // Keep the pixel centers covered by the projection within the framebuffer, objects covering none being out of the view
+        bounds.min_x = static_cast<int>(std::ceil((std::max)(column_min, 0.0f)));
+        bounds.max_x = static_cast<int>(std::floor((std::min)(column_max, column_scale)));
+        bounds.min_y = static_cast<int>(std::ceil((std::max)(row_min, 0.0f)));
+        bounds.max_y = static_cast<int>(std::floor((std::min)(row_max, row_scale)));
+        bounds.nearest_inverse_depth = 1.0f / nearest_depth;
+        if (bounds.min_x > bounds.max_x || bounds.min_y > bounds.max_y)
+        {
+            pass = Object_Pass::culled;
+            continue;
+        }
+        auto const covered_area = static_cast<float>(bounds.max_x - bounds.min_x + 1) * (bounds.max_y - bounds.min_y + 1);
+        pass = (covered_area >= m_occluder_min_screen_ratio * screen_area) ? Object_Pass::occluders : Object_Pass::remaining;
+    }
+}
+
+void Rasterizer::build_depth_level(std::size_t level, std::size_t first_row, std::size_t end_row)
+{
+    auto const& below = m_depth_pyramid[level - 1];
+    auto& built = m_depth_pyramid[level];
+    for (auto row = first_row; row < end_row; row++)
+    {
+        // A last row or column of odd size is paired with itself
+        auto const* const first_source = below.inverse_depths.data() + 2 * row * below.width;
+        auto const* const second_source = below.inverse_depths.data() + (std::min)(2 * static_cast<int>(row) + 1, below.height - 1) * below.width;
+        auto* const target = built.inverse_depths.data() + row * built.width;
+        // Reduce eight source columns into four texels at once, keeping the farthest depth, i.e. the smallest reciprocal depth
+        auto column = 0;
+        for (; 2 * column + 8 <= below.width; column += 4)
+        {
+            auto const first_half = _mm_min_ps(_mm_loadu_ps(first_source + 2 * column), _mm_loadu_ps(second_source + 2 * column));
+            auto const second_half = _mm_min_ps(_mm_loadu_ps(first_source + 2 * column + 4), _mm_loadu_ps(second_source + 2 * column + 4));
+            auto const even_columns = _mm_shuffle_ps(first_half, second_half, _MM_SHUFFLE(2, 0, 2, 0));
+            auto const odd_columns = _mm_shuffle_ps(first_half, second_half, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(target + column, _mm_min_ps(even_columns, odd_columns));
+        }
+        for (; column < built.width; column++)
+        {
+            auto const next_column = (std::min)(2 * column + 1, below.width - 1);
+            target[column] = (std::min)({first_source[2 * column], first_source[next_column], second_source[2 * column], second_source[next_column]});
+        }
+    }
+}
+
+void Rasterizer::cull_hidden_objects(std::size_t first_object, std::size_t end_object, Occlusion_Statistics& out_statistics)
+{
+    for (auto object_it = first_object; object_it < end_object; object_it++)
+    {
+        if (m_object_passes[object_it] != Object_Pass::remaining)
+            continue;
+        // Pick the finest level in which the bounds span a few texels along each side
+        auto const& bounds = m_projected_bounds[object_it];
+        auto level = 0u;
+        while (level + 1 < m_depth_pyramid.size() && (((bounds.max_x >> level) - (bounds.min_x >> level)) >= max_tested_texel_span || ((bounds.max_y >> level) - (bounds.min_y >> level)) >= max_tested_texel_span))
+            level++;
+        auto const& depth_level = m_depth_pyramid[level];
+
+        // The object is hidden if its nearest point lies behind the farthest occluder of each texel, testing four texels at once
+        auto const nearest_inverse_depth = _mm_set1_ps(bounds.nearest_inverse_depth);
+        auto const first_column = bounds.min_x >> level;
+        auto const last_column = bounds.max_x >> level;
+        auto is_hidden = true;
+        for (auto row = bounds.min_y >> level; row <= (bounds.max_y >> level) && is_hidden; row++)
+        {
+            auto const* const texels = depth_level.inverse_depths.data() + static_cast<std::size_t>(row) * depth_level.width;
+            auto column = first_column;
+            for (; column + 3 <= last_column && is_hidden; column += 4)
+                is_hidden = (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(texels + column), nearest_inverse_depth)) == 0);
+            for (; column <= last_column && is_hidden; column++)
+                is_hidden = (texels[column] > bounds.nearest_inverse_depth);
+        }
+        if (!is_hidden)
+            continue;
+        m_object_passes[object_it] = Object_Pass::culled;
+        out_statistics.culled_object_count++;
+        out_statistics.culled_triangle_count += m_object_first_triangles[object_it + 1] - m_object_first_triangles[object_it];
+    }
+}
+
+void Rasterizer::draw_pass(Camera const& camera, culling::Type culling, Object_Pass pass, bool is_first_pass, bool is_last_pass, Worker_Pool& worker_pool)
+{
+    // Set up and bin the triangles, each thread handling a contiguous range of them into its own bins, which keeps the triangles' order within each set
+    auto const thread_count = worker_pool.get_thread_count();
+    auto const tile_count = static_cast<std::size_t>(m_tile_column_count) * m_tile_row_count;
+    m_setup_triangles.resize(thread_count);
+    m_bins.resize(thread_count);
+    for (auto& bins : m_bins)
+    {
+        bins.resize(tile_count);
+        for (auto& bin : bins)
+            bin.clear();
+    }
+    auto const triangle_count = get_triangle_count();
+    worker_pool.run([&](unsigned int thread_index) {
+        auto const first_triangle = triangle_count * thread_index / thread_count;
+        auto const end_triangle = triangle_count * (thread_index + 1) / thread_count;
+        setup_triangles(camera, culling, pass, first_triangle, end_triangle, thread_index);
+    });
+
+    // Rasterize the tiles, each thread taking the next one left
+    std::atomic<int> next_tile{0};
+    worker_pool.run([&](unsigned int) { rasterize_tiles(next_tile, is_first_pass, is_last_pass); });
+}
+
+void Rasterizer::setup_triangles(Camera const& camera, culling::Type culling, Object_Pass pass, std::size_t first_triangle, std::size_t end_triangle, unsigned int bin_set)
+{
+    m_setup_triangles[bin_set].clear();
+    auto const& camera_position = camera.get_position();
+    auto const near_plane = camera.get_near();
+    auto const column_scale = static_cast<float>(m_width - 1);
+    auto const row_scale = static_cast<float>(m_height - 1);
+    // Camera rays start at the near distance, which the ray through a corner of the framebuffer reaches at the smallest depth
+    auto const clip_depth = camera.compute_min_ray_depth();
+    for (auto triangle = first_triangle; triangle < end_triangle; triangle++)
+    {
+        // Skip the objects drawn in other passes at once, so that culled objects never reach the setup
+        auto const object = m_object_indices[triangle];
+        if (m_object_passes[object] != pass)
+        {
+            triangle = m_object_first_triangles[object + 1] - 1;
+            continue;
+        }
+
+        // Cull the triangle if it faces the camera in a way that is impacted by culling, as camera rays do
+        auto const* vertices = m_vertices.data() + 3 * triangle;
+        auto const facing = math::cross(vertices[1] - vertices[0], vertices[2] - vertices[0]).dot(vertices[0] - camera_position);
+        if ((culling == culling::Type::BackFace && facing >= 0.0f) || (culling == culling::Type::FrontFace && facing <= 0.0f))
+            continue;
+
+        // Clip the triangle against the clipping plane, which leaves a polygon of up to four vertices
+        std::array<Vec3f, 4> clipped{Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero()};
+        auto clipped_count = 0u;
+        for (auto vertex_it = 0u; vertex_it < 3; vertex_it++)
+        {
+            auto const current = camera.to_view_space(vertices[vertex_it]);
+            auto const next = camera.to_view_space(vertices[(vertex_it + 1) % 3]);
+            if (current.z() >= clip_depth)
+                clipped[clipped_count++] = current;
+            if ((current.z() >= clip_depth) != (next.z() >= clip_depth))
+                clipped[clipped_count++] = current + (next - current) * ((clip_depth - current.z()) / (next.z() - current.z()));
+        }
+
+        // Project the polygon's vertices to the screen, then set up the fan of triangles it splits into
+        std::array<Vec3f, 4> projected{Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero()};
+        for (auto vertex_it = 0u; vertex_it < clipped_count; vertex_it++)
+        {
+            auto const& vertex = clipped[vertex_it];
+            auto const inverse_depth = 1.0f / vertex.z();
+            projected[vertex_it] = Vec3f{(near_plane * vertex.x() * inverse_depth + 0.5f) * column_scale, (near_plane * vertex.y() * inverse_depth + 0.5f) * row_scale, inverse_depth};
+        }
+        for (auto vertex_it = 1u; vertex_it + 1 < clipped_count; vertex_it++)
+            setup_projected_triangle({projected[0], projected[vertex_it], projected[vertex_it + 1]}, static_cast<std::int32_t>(triangle), bin_set);
+    }
+}
+
+void Rasterizer::setup_projected_triangle(std::array<Vec3f, 3> const& vertices, std::int32_t triangle, unsigned int bin_set)
+{
+    // Orient the triangle counter-clockwise, so that its edge functions are positive inside of it
+    auto area = (vertices[1].x() - vertices[0].x()) * (vertices[2].y() - vertices[0].y()) - (vertices[2].x() - vertices[0].x()) * (vertices[1].y() - vertices[0].y());
+    if (area == 0.0f)
+        return;
+    std::array<Vec3f const*, 3> ordered{&vertices[0], &vertices[1], &vertices[2]};
+    if (area < 0.0f)
+    {
+        std::swap(ordered[1], ordered[2]);
+        area = -area;
+    }
+
+    // Clamp the bounding box to the framebuffer, pixel centers lying on integer coordinates
+    Setup_Triangle setup;
+    auto const min_x = (std::min)({ordered[0]->x(), ordered[1]->x(), ordered[2]->x()});
+    auto const max_x = (std::max)({ordered[0]->x(), ordered[1]->x(), ordered[2]->x()});
+    auto const min_y = (std::min)({ordered[0]->y(), ordered[1]->y(), ordered[2]->y()});
+    auto const max_y = (std::max)({ordered[0]->y(), ordered[1]->y(), ordered[2]->y()});
+    setup.min_x = static_cast<int>(std::ceil((std::max)(min_x, 0.0f)));
+    setup.max_x = static_cast<int>(std::floor((std::min)(max_x, static_cast<float>(m_width - 1))));
+    setup.min_y = static_cast<int>(std::ceil((std::max)(min_y, 0.0f)));
+    setup.max_y = static_cast<int>(std::floor((std::min)(max_y, static_cast<float>(m_height - 1))));
+    if (setup.min_x > setup.max_x || setup.min_y > setup.max_y)
+        return;
+
+    // Compute the edge functions, the edge from the k-th vertex to the next one being zero on the vertex after them,
+    // and the plane equation of the reciprocal depth, interpolated with the barycentric coordinates given by the edge functions
+    setup.depth_x_factor = 0.0f;
+    setup.depth_y_factor = 0.0f;
+    setup.depth_constant = 0.0f;
+    for (auto edge_it = 0u; edge_it < 3; edge_it++)
+    {
+        auto const& start = *ordered[edge_it];
+        auto const& end = *ordered[(edge_it + 1) % 3];
+        setup.edge_x_factors[edge_it] = start.y() - end.y();
+        setup.edge_y_factors[edge_it] = end.x() - start.x();
+        setup.edge_constants[edge_it] = start.x() * end.y() - start.y() * end.x();
+        auto const opposite_inverse_depth = ordered[(edge_it + 2) % 3]->z() / area;
+        setup.depth_x_factor += setup.edge_x_factors[edge_it] * opposite_inverse_depth;
+        setup.depth_y_factor += setup.edge_y_factors[edge_it] * opposite_inverse_depth;
+        setup.depth_constant += setup.edge_constants[edge_it] * opposite_inverse_depth;
+    }
+    setup.triangle = triangle;
+
+    // Bin the triangle into the tiles overlapped by its bounding box
+    auto& setup_triangles = m_setup_triangles[bin_set];
+    auto& bins = m_bins[bin_set];
+    auto const setup_index = static_cast<std::uint32_t>(setup_triangles.size());
+    setup_triangles.push_back(setup);
+    for (auto tile_row = setup.min_y / tile_size; tile_row <= setup.max_y / tile_size; tile_row++)
+        for (auto tile_column = setup.min_x / tile_size; tile_column <= setup.max_x / tile_size; tile_column++)
+            bins[tile_row * m_tile_column_count + tile_column].push_back(setup_index);
+}
+
+Vec2f Rasterizer::compute_barycentrics(int triangle, Vec3f const& direction) const
+{
+    // Solve origin + t * direction = first + b1 * first_edge + b2 * second_edge with Cramer's rule (Moller-Trumbore)
+    auto const* vertices = m_vertices.data() + 3 * triangle;
+    auto const first_edge = vertices[1] - vertices[0];
+    auto const second_edge = vertices[2] - vertices[0];
+    auto const direction_cross_edge = math::cross(direction, second_edge);
+    auto const determinant = first_edge.dot(direction_cross_edge);
+    if (determinant == 0.0f)
+        return Vec2f::zero();
+    auto const origin_offset = m_camera.get_position() - vertices[0];
+    auto const offset_cross_edge = math::cross(origin_offset, first_edge);
+    return Vec2f{origin_offset.dot(direction_cross_edge) / determinant, direction.dot(offset_cross_edge) / determinant};
+}
+
+void Rasterizer::rasterize_tiles(std::atomic<int>& next_tile, bool is_first_pass, bool is_last_pass)
+{
+    alignas(16) float tile_inverse_depths[tile_size * tile_size];
+    alignas(16) std::int32_t tile_triangle_ids[tile_size * tile_size];
+    auto const tile_count = m_tile_column_count * m_tile_row_count;
+    auto const zero = _mm_setzero_ps();
+    auto const column_offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    for (auto tile = next_tile++; tile < tile_count; tile = next_tile++)
+    {
+        auto const tile_x = (tile % m_tile_column_count) * tile_size;
+        auto const tile_y = (tile / m_tile_column_count) * tile_size;
+        auto const tile_width = (std::min)(tile_size, m_width - tile_x);
+        auto const tile_height = (std::min)(tile_size, m_height - tile_y);
+        std::fill(tile_inverse_depths, tile_inverse_depths + tile_size * tile_size, m_far_inverse_depth);
+        std::fill(tile_triangle_ids, tile_triangle_ids + tile_size * tile_size, -1);
+        // Start from the triangles drawn by the previous pass, if any
+        if (!is_first_pass)
+        {
+            auto const& depth_buffer = m_depth_pyramid[0].inverse_depths;
+            for (auto row_it = 0; row_it < tile_height; row_it++)
+            {
+                auto const source = static_cast<std::size_t>(tile_y + row_it) * m_width + tile_x;
+                std::copy(depth_buffer.begin() + source, depth_buffer.begin() + source + tile_width, tile_inverse_depths + row_it * tile_size);
+                std::copy(m_triangle_ids.begin() + source, m_triangle_ids.begin() + source + tile_width, tile_triangle_ids + row_it * tile_size);
+            }
+        }
+
+        // Go through the bins of the threads in order, so that triangles are drawn in the order in which they were tessellated
+        for (auto bin_set = 0u; bin_set < m_bins.size(); bin_set++)
+        {
+            for (auto const setup_index : m_bins[bin_set][tile])
+            {
+                auto const& setup = m_setup_triangles[bin_set][setup_index];
+                auto const first_x = (std::max)(setup.min_x, tile_x);
+                auto const last_x = (std::min)(setup.max_x, tile_x + tile_size - 1);
+                auto const first_y = (std::max)(setup.min_y, tile_y);
+                auto const last_y = (std::min)(setup.max_y, tile_y + tile_size - 1);
+                // Start at the group of four pixels containing the first column
+                auto const aligned_first_x = tile_x + ((first_x - tile_x) & ~3);
+                auto const triangle_id = _mm_set1_epi32(setup.triangle);
+                for (auto y = first_y; y <= last_y; y++)
+                {
+                    // Each function is evaluated from the same expression in each pixel, so that triangles sharing an edge get exactly opposite values and leave no gap
+                    auto const row = static_cast<float>(y);
+                    __m128 edge_x_factors[3];
+                    __m128 edge_row_terms[3];
+                    for (auto edge_it = 0u; edge_it < 3; edge_it++)
+                    {
+                        edge_x_factors[edge_it] = _mm_set1_ps(setup.edge_x_factors[edge_it]);
+                        edge_row_terms[edge_it] = _mm_set1_ps(setup.edge_y_factors[edge_it] * row + setup.edge_constants[edge_it]);
+                    }
+                    auto const depth_x_factor = _mm_set1_ps(setup.depth_x_factor);
+                    auto const depth_row_term = _mm_set1_ps(setup.depth_y_factor * row + setup.depth_constant);
+                    auto* const depth_row = tile_inverse_depths + (y - tile_y) * tile_size;
+                    auto* const id_row = tile_triangle_ids + (y - tile_y) * tile_size;
+                    for (auto x = aligned_first_x; x <= last_x; x += 4)
+                    {
+                        auto const columns = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), column_offsets);
+                        // A pixel is covered if it lies inside of or on all edges
+                        auto covered = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                        for (auto edge_it = 0u; edge_it < 3; edge_it++)
+                        {
+                            auto const edge = _mm_add_ps(_mm_mul_ps(edge_x_factors[edge_it], columns), edge_row_terms[edge_it]);
+                            covered = _mm_and_ps(covered, _mm_cmpge_ps(edge, zero));
+                        }
+                        // Keep the pixels nearer than the stored ones, with the larger reciprocal depth
+                        auto const inverse_depth = _mm_add_ps(_mm_mul_ps(depth_x_factor, columns), depth_row_term);
+                        auto const stored_inverse_depth = _mm_load_ps(depth_row + (x - tile_x));
+                        covered = _mm_and_ps(covered, _mm_cmpgt_ps(inverse_depth, stored_inverse_depth));
+                        if (_mm_movemask_ps(covered) == 0)
+                            continue;
+                        _mm_store_ps(depth_row + (x - tile_x), _mm_or_ps(_mm_and_ps(covered, inverse_depth), _mm_andnot_ps(covered, stored_inverse_depth)));
+                        auto const covered_ids = _mm_castps_si128(covered);
+                        auto const stored_ids = _mm_load_si128(reinterpret_cast<__m128i const*>(id_row + (x - tile_x)));
+                        _mm_store_si128(reinterpret_cast<__m128i*>(id_row + (x - tile_x)), _mm_or_si128(_mm_and_si128(covered_ids, triangle_id), _mm_andnot_si128(covered_ids, stored_ids)));
+                    }
+                }
+            }
+        }
+
+        // Copy the tile's pixels that lie within the framebuffer, along with their depths if another pass follows,
+        // otherwise intersecting each pixel's camera ray with its triangle's plane to get the barycentric coordinates
+        for (auto row_it = 0; row_it < tile_height; row_it++)
+        {
+            auto const source = row_it * tile_size;
+            auto const target = static_cast<std::size_t>(tile_y + row_it) * m_width + tile_x;
+            std::copy(tile_triangle_ids + source, tile_triangle_ids + source + tile_width, m_triangle_ids.begin() + target);
+            if (!is_last_pass)
+            {
+                std::copy(tile_inverse_depths + source, tile_inverse_depths + source + tile_width, m_depth_pyramid[0].inverse_depths.begin() + target);
+                continue;
+            }
+            auto const v = ((tile_y + row_it) * 1.0f / (m_height - 1)) - 0.5f;
+            for (auto column_it = 0; column_it < tile_width; column_it++)
+            {
+                auto const triangle = tile_triangle_ids[source + column_it];
+                if (triangle < 0)
+                    continue;
+                auto const u = ((tile_x + column_it) * 1.0f / (m_width - 1)) - 0.5f;
+                m_barycentrics[target + column_it] = compute_barycentrics(triangle, m_camera.compute_ray_direction(u, v));
+            }
+        }
+    }
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <graphics/camera.h>
+#include <graphics/culling.h>
+#include <graphics/renderer/worker_pool.h>
+#include <graphics/scene.h>
+#include <math/vec.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Tile-binned software rasterizer writing a visibility buffer: for each pixel of the framebuffer, the nearest triangle of the tessellated scene through the pixel's center,
+ * along with the barycentric coordinates of the point hit by the pixel's camera ray.
+ * Triangles are clipped against the nearest plane reached by camera rays at the camera's near distance, so that no surface that camera rays can hit is clipped,
+ * then set up and binned into tiles by all threads, each thread handling a contiguous range of triangles.
+ * Each tile is then rasterized by a single thread into a tile-local depth buffer, with half-space edge functions evaluated four pixels at a time,
+ * going through the bins in triangle order so that the result does not depend on the number of threads. As with the ray-polygon test, pixels lying exactly on an edge are covered,
+ * those shared by two triangles being kept by the first one drawn.
+ * Depths are tested as reciprocal view-space depths, which are affine in screen space.
+ * With occlusion culling, objects whose projected bounds cover a large part of the screen are drawn first as occluders, and their depths are reduced into a hierarchical depth pyramid
+ * storing the farthest depth of each block of pixels. The bounds of the other objects are then tested against it, and only the objects that may be visible are set up and drawn on top.
+ */
+class Rasterizer
+{
+  public:
+    Rasterizer() = default;
+    ~Rasterizer() = default;
+    Rasterizer(Rasterizer const& other) = default;
+    Rasterizer& operator=(Rasterizer const& other) = default;
+
+    /**
+     * @brief Numbers of objects and triangles culled by the last rasterization.
+     */
+    struct Occlusion_Statistics
+    {
+        std::size_t occluder_count = 0;        // Number of objects drawn first as occluders
+        std::size_t culled_object_count = 0;   // Number of objects skipped before setup, being hidden by the occluders or out of the view
+        std::size_t culled_triangle_count = 0; // Number of triangles of the culled objects
+    };
+
+    /**
+     * @brief Tessellates the objects of the scene into the triangles to rasterize.
+     * @param[in] scene. Scene whose objects to tessellate.
+     * @param[in] sphere_segment_count. Number of segments around the spheres.
+     */
+    void set_scene(Scene const& scene, unsigned int sphere_segment_count);
+
+    /**
+     * @brief Enables or disables the culling of the objects hidden by large occluders, which is disabled by default.
+     * @param[in] is_enabled. Whether to cull hidden objects before setting up their triangles.
+     * @param[in] occluder_min_screen_ratio. Ratio of the screen that the projected bounds of an object must cover for the object to be drawn as an occluder.
+     */
+    void set_occlusion_culling(bool is_enabled, float occluder_min_screen_ratio)
+    {
+        m_is_occlusion_culling_enabled = is_enabled;
+        m_occluder_min_screen_ratio = occluder_min_screen_ratio;
+    }
+
+    /**
+     * @brief Rasterizes the triangles as seen through the given camera.
+     * @param[in] camera. Camera through which the triangles are seen, casting its rays through the points of its image plane with u and v between -0.5 and 0.5.
+     * @param[in] width. Width of the framebuffer, in pixels.
+     * @param[in] height. Height of the framebuffer, in pixels.
+     * @param[in] culling. Whether to cull front or back faces, as camera rays do.
+     * @param[in] worker_pool. Worker threads over which to split the triangles, then the tiles.
+     */
+    void rasterize(Camera const& camera, int width, int height, culling::Type culling, Worker_Pool& worker_pool);
+
+    /**
+     * @brief Gets the number of triangles of the tessellated scene.
+     * @return The number of triangles.
+     */
+    std::size_t get_triangle_count() const { return m_object_indices.size(); }
+
+    /**
+     * @brief Gets the number of objects and triangles culled by the last rasterization.
+     * @return The culling statistics, all zero if occlusion culling is disabled.
+     */
+    Occlusion_Statistics const& get_occlusion_statistics() const { return m_occlusion_statistics; }
+
+    /**
+     * @brief Gets the index in the scene of the object from which a triangle was tessellated.
+     * @param[in] triangle. Index of the triangle.
+     * @return The index of the object.
+     */
+    int get_object_index(int triangle) const { return m_object_indices[triangle]; }
+
+    /**
+     * @brief Computes the position of a point of a triangle from its barycentric coordinates.
+     * @param[in] triangle. Index of the triangle.
+     * @param[in] barycentrics. Weights of the triangle's second and third vertices.
+     * @return The world-space position of the point.
+     */
+    Vec3f compute_position(int triangle, Vec2f const& barycentrics) const
+    {
+        auto const* vertices = m_vertices.data() + 3 * triangle;
+        return vertices[0] + barycentrics.x() * (vertices[1] - vertices[0]) + barycentrics.y() * (vertices[2] - vertices[0]);
+    }
+
+    /**
+     * @brief Gets the nearest triangle seen through each pixel by the last rasterization, stored row after row.
+     * @return The index of the triangle of each pixel, or -1 if none.
+     */
+    std::int32_t const* get_triangle_ids() const { return m_triangle_ids.data(); }
+
+    /**
+     * @brief Gets the barycentric coordinates of the point of each pixel's triangle hit by the pixel's camera ray, by the last rasterization, stored row after row.
+     * @return The weights of the second and third vertices of the triangle of each pixel, undefined if the pixel has no triangle.
+     */
+    Vec2f const* get_barycentrics() const { return m_barycentrics.data(); }
+
+  private:
+    /**
+     * @brief Pass of a rasterization in which an object is drawn.
+     */
+    enum class Object_Pass : unsigned char
+    {
+        occluders, // Drawn first, its depths filling the depth pyramid
+        remaining, // Drawn after the occluders
+        culled     // Not drawn, being hidden or out of the view
+    };
+
+    /**
+     * @brief Pixels covered by the projection of an object's bounds.
+     */
+    struct Projected_Bounds
+    {
+        int min_x = 0;                      // First column of the pixels, within the framebuffer
+        int max_x = -1;                     // Last column of the pixels, within the framebuffer
+        int min_y = 0;                      // First row of the pixels, within the framebuffer
+        int max_y = -1;                     // Last row of the pixels, within the framebuffer
+        float nearest_inverse_depth = 0.0f; // Reciprocal depth of the bounds' nearest point
+    };
+
+    /**
+     * @brief Level of the hierarchical depth pyramid, each texel storing the smallest reciprocal depth, i.e. the farthest depth, of the two by two texels of the level below.
+     */
+    struct Depth_Level
+    {
+        int width = 0;                     // Number of columns of texels
+        int height = 0;                    // Number of rows of texels
+        std::vector<float> inverse_depths; // Farthest reciprocal depth of each texel, stored row after row
+    };
+
+    /**
+     * @brief Triangle projected to the screen, ready to be rasterized.
+     */
+    struct Setup_Triangle
+    {
+        std::array<float, 3> edge_x_factors; // Factor of the pixel's column in each edge function, positive inside of the triangle
+        std::array<float, 3> edge_y_factors; // Factor of the pixel's row in each edge function
+        std::array<float, 3> edge_constants; // Constant term of each edge function
+        float depth_x_factor;                // Factor of the pixel's column in the plane equation of the reciprocal depth
+        float depth_y_factor;                // Factor of the pixel's row in the plane equation of the reciprocal depth
+        float depth_constant;                // Constant term of the plane equation of the reciprocal depth
+        int min_x;                           // First column of the bounding box of the triangle, within the framebuffer
+        int max_x;                           // Last column of the bounding box of the triangle, within the framebuffer
+        int min_y;                           // First row of the bounding box of the triangle, within the framebuffer
+        int max_y;                           // Last row of the bounding box of the triangle, within the framebuffer
+        std::int32_t triangle;               // Index of the tessellated triangle, shared by the triangles into which clipping splits it
+    };
+
+    /**
+     * @brief Projects the bounds of a range of objects to the screen, and selects the pass in which each object is drawn from its projected area.
+     * @param[in] first_object. First object to project.
+     * @param[in] end_object. Object after the last one to project.
+     */
+    void project_object_bounds(std::size_t first_object, std::size_t end_object);
+
+    /**
+     * @brief Computes a range of rows of a level of the depth pyramid from the level below.
+     * @param[in] level. Index of the level, at least one.
+     * @param[in] first_row. First row to compute.
+     * @param[in] end_row. Row after the last one to compute.
+     */
+    void build_depth_level(std::size_t level, std::size_t first_row, std::size_t end_row);
+
+    /**
+     * @brief Tests the projected bounds of a range of objects drawn after the occluders against the depth pyramid, and culls the hidden ones.
+     * @param[in] first_object. First object to test.
+     * @param[in] end_object. Object after the last one to test.
+     * @param[out] out_statistics. Numbers of objects and triangles culled in the range.
+     */
+    void cull_hidden_objects(std::size_t first_object, std::size_t end_object, Occlusion_Statistics& out_statistics);
+
+    /**
+     * @brief Sets up, bins and rasterizes the triangles of the objects drawn in a pass.
+     * @param[in] camera. Camera through which the triangles are seen.
+     * @param[in] culling. Whether to cull front or back faces.
+     * @param[in] pass. Pass whose objects to draw.
+     * @param[in] is_first_pass. Whether the pass starts from an empty framebuffer, instead of the depths and triangles of the previous pass.
+     * @param[in] is_last_pass. Whether the pass computes the barycentric coordinates of the pixels, instead of storing their depths for the next pass.
+     * @param[in] worker_pool. Worker threads over which to split the triangles, then the tiles.
+     */
+    void draw_pass(Camera const& camera, culling::Type culling, Object_Pass pass, bool is_first_pass, bool is_last_pass, Worker_Pool& worker_pool);
+
+    /**
+     * @brief Clips, projects and sets up the triangles of a range drawn in the given pass, and bins them into the tiles that their bounding boxes overlap.
+     * @param[in] camera. Camera through which the triangles are seen.
+     * @param[in] culling. Whether to cull front or back faces.
+     * @param[in] pass. Pass whose triangles to set up, the others being skipped.
+     * @param[in] first_triangle. First triangle to set up.
+     * @param[in] end_triangle. Triangle after the last one to set up.
+     * @param[in] bin_set. Index of the thread's set of setup triangles and bins.
+     */
+    void setup_triangles(Camera const& camera, culling::Type culling, Object_Pass pass, std::size_t first_triangle, std::size_t end_triangle, unsigned int bin_set);
+
+    /**
+     * @brief Sets up a triangle projected to the screen, and bins it.
+     * @param[in] vertices. Columns and rows of the triangle's vertices, with their reciprocal view-space depths.
+     * @param[in] triangle. Index of the tessellated triangle.
+     * @param[in] bin_set. Index of the thread's set of setup triangles and bins.
+     */
+    void setup_projected_triangle(std::array<Vec3f, 3> const& vertices, std::int32_t triangle, unsigned int bin_set);
+
+    /**
+     * @brief Computes the barycentric coordinates of the point where a camera ray crosses a triangle's plane.
+     * @param[in] triangle. Index of the triangle.
+     * @param[in] direction. Direction of the camera ray, not necessarily normalized.
+     * @return The weights of the triangle's second and third vertices.
+     */
+    Vec2f compute_barycentrics(int triangle, Vec3f const& direction) const;
+
+    /**
+     * @brief Rasterizes tiles until none is left, each thread taking the next tile from the shared counter.
+     * @param[in,out] next_tile. Index of the next tile to rasterize, shared by the threads.
+     * @param[in] is_first_pass. Whether tiles start empty, instead of with the depths and triangles of the previous pass.
+     * @param[in] is_last_pass. Whether to compute the barycentric coordinates of the pixels, instead of storing their depths for the next pass.
+     */
+    void rasterize_tiles(std::atomic<int>& next_tile, bool is_first_pass, bool is_last_pass);
+
+    static constexpr int tile_size = 32;            // Width and height of the tiles, a multiple of the four pixels evaluated at once
+    static constexpr int max_tested_texel_span = 4; // Number of texels of the depth pyramid's level tested along each side of an object's projected bounds, at most
+
+    std::vector<Vec3f> m_vertices;                               // Vertices of the tessellated triangles, three per triangle
+    std::vector<int> m_object_indices;                           // Index in the scene of the object of each triangle
+    std::vector<std::size_t> m_object_first_triangles;           // First triangle of each object, followed by the number of triangles
+    std::vector<Vec3f> m_object_bounds;                          // Minimum and maximum corners of the box bounding each object's triangles, two per object
+    bool m_is_occlusion_culling_enabled = false;                 // Whether objects hidden by the occluders are culled before setup
+    float m_occluder_min_screen_ratio = 0.1f;                    // Ratio of the screen covered by the projected bounds of the objects drawn as occluders
+    std::vector<Object_Pass> m_object_passes;                    // Pass of the last rasterization in which each object is drawn
+    std::vector<Projected_Bounds> m_projected_bounds;            // Pixels covered by each object's bounds in the last rasterization
+    std::vector<Depth_Level> m_depth_pyramid;                    // Levels of the depth pyramid, the first one being the depth buffer of the occluders
+    Occlusion_Statistics m_occlusion_statistics;                 // Numbers of objects and triangles culled by the last rasterization
+    int m_width = 0;                                             // Width of the framebuffer, in pixels
+    int m_height = 0;                                            // Height of the framebuffer, in pixels
+    int m_tile_column_count = 0;                                 // Number of columns of tiles
+    int m_tile_row_count = 0;                                    // Number of rows of tiles
+    Camera m_camera;                                             // Camera of the last rasterization
+    float m_far_inverse_depth = 0.0f;                            // Reciprocal depth of the camera's far plane, beyond which triangles are discarded
+    std::vector<std::vector<Setup_Triangle>> m_setup_triangles;  // Triangles set up by each thread
+    std::vector<std::vector<std::vector<std::uint32_t>>> m_bins; // Setup triangles of each thread overlapping each tile, in triangle order
+    std::vector<std::int32_t> m_triangle_ids;                    // Nearest triangle of each pixel, or -1 if none
+    std::vector<Vec2f> m_barycentrics;                           // Barycentric coordinates of the hit point of each pixel in its triangle
+};
@@ -0,0 +1,83 @@
+#include "ray_queue.h"
+
+namespace
+{
+
+/**
+ * @brief Reorders an attribute array of the queue.
+ * @tparam T. Type of the attribute.
+ * @param[in,out] values. Values of the attribute, in input order on input and in output order on output.
+ * @param[in] order. Input index of each output value.
+ */
+template <typename T> void apply_order(std::vector<T>& values, std::vector<unsigned int> const& order)
+{
+    if (values.size() != order.size())
+        return;
+    std::vector<T> ordered_values;
+    ordered_values.reserve(values.size());
+    for (auto const index : order)
+        ordered_values.push_back(values[index]);
+    values.swap(ordered_values);
+}
+
+} // namespace
+
+void Ray_Queue::clear()
+{
+    rays.clear();
+    near_limits.clear();
+    far_limits.clear();
+    throughputs_r.clear();
+    throughputs_g.clear();
+    throughputs_b.clear();
+    pixel_indices.clear();
+    bounce_counts.clear();
+    stores_aovs.clear();
+    hit_objects.clear();
+    hit_distances.clear();
+    sort_keys.clear();
+}
+
+void Ray_Queue::push(geometry::Ray const& ray, float near_limit, float far_limit, Vec3f const& throughput, int pixel_index, unsigned int bounce_count, bool ray_stores_aovs)
+{
+    rays.push_back(ray);
+    near_limits.push_back(near_limit);
+    far_limits.push_back(far_limit);
+    throughputs_r.push_back(throughput.x());
+    throughputs_g.push_back(throughput.y());
+    throughputs_b.push_back(throughput.z());
+    pixel_indices.push_back(pixel_index);
+    bounce_counts.push_back(bounce_count);
+    stores_aovs.push_back(ray_stores_aovs ? 1 : 0);
+}
+
+void Ray_Queue::sort_by_key(unsigned int key_count)
+{
+    auto const count = size();
+    if (sort_keys.size() != count)
+        return;
+
+    // Count the rays of each key, then turn the counts into the first output index of each key
+    m_key_offsets.assign(key_count + 1, 0);
+    for (auto const key : sort_keys)
+        m_key_offsets[key + 1]++;
+    for (auto key = 0u; key < key_count; key++)
+        m_key_offsets[key + 1] += m_key_offsets[key];
+    m_order.resize(count);
+    for (auto index = 0u; index < count; index++)
+        m_order[m_key_offsets[sort_keys[index]]++] = index;
+
+    // Move every attribute, hit attributes being only moved if they have been computed
+    apply_order(rays, m_order);
+    apply_order(near_limits, m_order);
+    apply_order(far_limits, m_order);
+    apply_order(throughputs_r, m_order);
+    apply_order(throughputs_g, m_order);
+    apply_order(throughputs_b, m_order);
+    apply_order(pixel_indices, m_order);
+    apply_order(bounce_counts, m_order);
+    apply_order(stores_aovs, m_order);
+    apply_order(hit_objects, m_order);
+    apply_order(hit_distances, m_order);
+    apply_order(sort_keys, m_order);
+}
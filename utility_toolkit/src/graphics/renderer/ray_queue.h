@@ -0,0 +1,67 @@
+#pragma once
+
+#include <geometry/ray.h>
+#include <graphics/object.h>
+#include <math/vec.h>
+
+#include <vector>
+
+/**
+ * @brief Queue of rays processed together by the phases of the wavefront pipeline, stored as one array per attribute (structure of arrays).
+ * A phase appends rays to the queue or fills their hit attributes, and the queue can be sorted by a key between phases, so that the next phase processes similar rays together.
+ */
+struct Ray_Queue
+{
+    std::vector<geometry::Ray> rays;          // Origin and direction of each ray
+    std::vector<float> near_limits;           // Near intersection distance of each ray
+    std::vector<float> far_limits;            // Far intersection distance of each ray
+    std::vector<float> throughputs_r;         // Red weight of the radiance carried back along each ray, in its pixel's color
+    std::vector<float> throughputs_g;         // Green weight of the radiance carried back along each ray, in its pixel's color
+    std::vector<float> throughputs_b;         // Blue weight of the radiance carried back along each ray, in its pixel's color
+    std::vector<int> pixel_indices;           // Index of the pixel to which each ray contributes
+    std::vector<unsigned int> bounce_counts;  // Number of bounces of the path before each ray, zero for camera rays
+    std::vector<unsigned char> stores_aovs;   // Whether the first hit of each ray gives its pixel's AOVs
+    std::vector<Object const*> hit_objects;   // Closest object intersected by each ray, or nullptr if the ray hits nothing
+    std::vector<float> hit_distances;         // Distance from each ray's origin to its closest intersection
+    std::vector<unsigned int> sort_keys;      // Key of each ray, by which to sort the queue
+
+    unsigned int size() const { return static_cast<unsigned int>(rays.size()); }
+
+    /**
+     * @brief Removes all rays from the queue, keeping the memory of its arrays.
+     */
+    void clear();
+
+    /**
+     * @brief Appends a ray to the queue. Its hit attributes and sort key are left undefined.
+     * @param[in] ray. Ray, with origin and direction.
+     * @param[in] near_limit. Near intersection distance, at which to start looking for intersections.
+     * @param[in] far_limit. Far intersection distance, at which to stop looking for intersections.
+     * @param[in] throughput. Weight of the radiance carried back along the ray.
+     * @param[in] pixel_index. Index of the pixel to which the ray contributes.
+     * @param[in] bounce_count. Number of bounces of the path before the ray.
+     * @param[in] ray_stores_aovs. Whether the first hit of the ray gives its pixel's AOVs.
+     */
+    void push(geometry::Ray const& ray, float near_limit, float far_limit, Vec3f const& throughput, int pixel_index, unsigned int bounce_count, bool ray_stores_aovs);
+
+    /**
+     * @brief Computes the index of the octant in which a ray's direction lies, from the signs of its components.
+     * @param[in] index. Index of the ray.
+     * @return The octant, between zero and seven.
+     */
+    unsigned int compute_direction_octant(unsigned int index) const
+    {
+        auto const& direction = rays[index].get_direction();
+        return (direction.x() < 0.0f ? 1u : 0u) | (direction.y() < 0.0f ? 2u : 0u) | (direction.z() < 0.0f ? 4u : 0u);
+    }
+
+    /**
+     * @brief Sorts the rays by increasing key with a stable counting sort, moving all of their attributes.
+     * @param[in] key_count. Number of distinct keys, every key being lower than it.
+     */
+    void sort_by_key(unsigned int key_count);
+
+  private:
+    std::vector<unsigned int> m_key_offsets; // Scratch array of the counting sort, storing the first output index of each key
+    std::vector<unsigned int> m_order;       // Scratch array of the counting sort, storing the input index of each output ray
+};
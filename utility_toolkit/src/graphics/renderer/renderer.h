@@ -12,4 +12,9 @@ using Renderer = Renderer_To_File;
 #include <graphics/renderer/renderer_opengl.h>
 using Renderer = Renderer_OpenGL;
 
+#elif defined(RENDERER_RASTERIZER)
+
+#include <graphics/renderer/renderer_rasterizer.h>
+using Renderer = Renderer_Rasterizer;
+
 #endif
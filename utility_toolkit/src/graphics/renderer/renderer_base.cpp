@@ -5,12 +5,191 @@
 #include <graphics/light.h>
 #include <graphics/material.h>
 #include <graphics/object.h>
+#include <graphics/physically_based_rendering.h>
 #include <math/math.h>
 #include <math/vec.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
 #include <mutex>
+#include <random>
 #include <thread>
 
+#include <xmmintrin.h>
+
+namespace
+{
+
+/**
+ * @brief Shadow rays cast towards a light from a given point during one call to compute_light_visibilities.
+ */
+struct Light_Shadow_Rays
+{
+    unsigned int first_query;   // Index of the first query of the light in the batch of the current pass
+    unsigned int query_count;   // Number of queries of the light in the batch of the current pass
+    unsigned int visible_count; // Number of unoccluded rays over all passes
+    unsigned int traced_count;  // Number of traced rays over all passes
+    unsigned int sub_cell_x;    // Horizontal index, within each coarse cell, of the fine cell sampled by the detection pass
+    unsigned int sub_cell_y;    // Vertical index, within each coarse cell, of the fine cell sampled by the detection pass
+};
+
+auto constexpr adaptive_sampling_tile_size = 8;  // Width and height of the tiles of pixels that adaptive sampling refines together
+auto constexpr whitted_recursion_depth = 1;      // Number of mirror reflections traced by the Whitted integrator
+auto constexpr traversal_prefetch_distance = 4;  // Number of objects ahead of the tested one whose primitive is prefetched while traversing the scene
+auto constexpr view_culling_tile_size = 16;      // Width and height of the tiles of pixels whose camera rays test the same list of objects
+auto constexpr shadow_sharing_min_cosine = 0.9f; // Cosine of the largest angle between the forward directions of two views whose hits may share their light visibilities
+
+// Reflection depth of the quality levels that keep the integrators' own limits
+auto constexpr unlimited_reflection_depth = std::numeric_limits<unsigned int>::max();
+// Quality levels between which dynamic resolution scaling chooses, from the cheapest to the most expensive
+Quality_Level constexpr quality_levels[] = {
+    {0.25f, 1, 0},
+    {0.5f, 1, 1},
+    {0.75f, 1, 2},
+    {1.0f, 1, unlimited_reflection_depth},
+    {1.0f, 2, unlimited_reflection_depth},
+    {1.0f, 4, unlimited_reflection_depth},
+};
+auto constexpr quality_level_count = static_cast<unsigned int>(sizeof(quality_levels) / sizeof(quality_levels[0]));
+auto constexpr full_quality_level = 3u;        // Level rendering at full resolution and depth with a single sample, used when dynamic resolution scaling is disabled
+auto constexpr quality_drop_tolerance = 1.1f;  // Ratio of the target frame time above which the quality is lowered
+auto constexpr quality_raise_margin = 0.8f;    // Ratio of the target frame time below which the next level's predicted cost must stay to raise the quality
+auto constexpr quality_raise_frame_count = 3u; // Number of consecutive frames that must leave room for the next level before raising the quality
+auto constexpr frame_time_smoothing = 0.3f;    // Weight of the last frame in the moving average of frame times
+
+/**
+ * @brief Estimates the relative cost of rendering the first image of a frame at a quality level, proportional to its number of camera rays.
+ * @param[in] level. Quality level.
+ * @return The relative cost, one at full resolution with a single sample per pixel.
+ */
+float compute_quality_level_cost(Quality_Level const& level) { return level.resolution_scale * level.resolution_scale * level.sample_count; }
+
+/**
+ * @brief Computes the direction of a camera ray jittered at random within a pixel's footprint.
+ * @param[in] camera. Camera casting the ray.
+ * @param[in] column. Column of the pixel.
+ * @param[in] row. Row of the pixel.
+ * @param[in] width. Width of the camera's view, in pixels.
+ * @param[in] height. Height of the camera's view, in pixels.
+ * @return The world-space direction of the ray.
+ */
+Unit_Vec3f compute_jittered_ray_direction(Camera const& camera, int column, int row, int width, int height)
+{
+    auto const u = (column * 1.0f / (width - 1)) - 0.5f;
+    auto const v = (row * 1.0f / (height - 1)) - 0.5f;
+    auto const pixel_width = 1.0f / (std::max)(width - 1, 1);
+    auto const pixel_height = 1.0f / (std::max)(height - 1, 1);
+    auto const sample_u = u + (math::generate_random_01() - 0.5f) * pixel_width;
+    auto const sample_v = v + (math::generate_random_01() - 0.5f) * pixel_height;
+    return camera.compute_ray_direction(sample_u, sample_v).normalize();
+}
+
+/**
+ * @brief Checks whether two cameras render the same view, i.e. have the same position, basis and intrinsics.
+ * @param[in] first. First camera.
+ * @param[in] second. Second camera.
+ * @return True if the cameras render the same view, false otherwise.
+ */
+bool are_same_views(Camera const& first, Camera const& second)
+{
+    auto const are_equal = [](Vec3f const& first_vector, Vec3f const& second_vector) {
+        return first_vector.x() == second_vector.x() && first_vector.y() == second_vector.y() && first_vector.z() == second_vector.z();
+    };
+    return are_equal(first.get_position(), second.get_position()) && are_equal(first.get_right(), second.get_right()) && are_equal(first.get_up(), second.get_up()) &&
+           are_equal(first.get_forward(), second.get_forward()) && first.get_near() == second.get_near() && first.get_far() == second.get_far() &&
+           first.get_image_plane_width() == second.get_image_plane_width() && first.get_image_plane_height() == second.get_image_plane_height();
+}
+
+/**
+ * @brief Requests the primitive of the object at the given index, if any, to be loaded in cache, so that fetching it overlaps with the intersection tests of the preceding objects.
+ * Primitives are allocated separately from the list of objects, so the hardware prefetcher cannot predict their addresses.
+ * @param[in] objects. List of objects of the scene.
+ * @param[in] index. Index of the object whose primitive to prefetch.
+ */
+inline void prefetch_primitive(std::vector<Object> const& objects, std::size_t index)
+{
+    if (index < objects.size())
+        _mm_prefetch(reinterpret_cast<char const*>(&objects[index].get_primitive()), _MM_HINT_T0);
+}
+
+/**
+ * @brief Surface point hit by a ray of the wavefront pipeline, computed before its lights' visibilities are traced for all hits at once.
+ */
+struct Wavefront_Hit
+{
+    Vec3f position;             // World-space position of the hit point
+    Unit_Vec3f normal;          // Normal of the surface in the hit point
+    Surface_Parameters surface; // Surface parameters in the hit point
+};
+
+/**
+ * @brief Fills the surface data of a camera ray's first intersection.
+ * @param[out] out_hit. Surface data to fill.
+ * @param[in] object_id. Index of the intersected object in the scene.
+ * @param[in] distance. Distance from the ray's origin to the intersection.
+ * @param[in] position. Position of the intersection.
+ * @param[in] normal. Normal of the surface in the intersection.
+ * @param[in] surface. Surface parameters in the intersection.
+ */
+void fill_primary_hit(Primary_Hit& out_hit, std::ptrdiff_t object_id, float distance, Vec3f const& position, Vec3f const& normal, Surface_Parameters const& surface)
+{
+    out_hit.normal = normal;
+    out_hit.albedo = surface.albedo;
+    out_hit.depth = distance;
+    out_hit.object_id = static_cast<int>(object_id);
+    out_hit.position = position;
+    out_hit.reflective_intensity = surface.reflective_intensity;
+}
+
+/**
+ * @brief Fills a block of a row of blocks with a single color, clipping it to the row's width.
+ * @param[in,out] colors. Planar colors of the row of blocks, stored row after row.
+ * @param[in] first_column. Column of the block's first pixel.
+ * @param[in] block_size. Width of the block.
+ * @param[in] row_count. Number of rows of the row of blocks.
+ * @param[in] width. Number of columns of the row of blocks.
+ * @param[in] color. Color with which to fill the block.
+ */
+void fill_block(std::array<std::vector<float>, 3>& colors, int first_column, int block_size, int row_count, int width, Vec3f const& color)
+{
+    auto const end_column = (std::min)(first_column + block_size, width);
+    for (auto channel = 0u; channel < 3; channel++)
+        for (auto row_it = 0; row_it < row_count; row_it++)
+            std::fill(colors[channel].begin() + row_it * width + first_column, colors[channel].begin() + row_it * width + end_column, color[channel]);
+}
+
+/**
+ * @brief Fills a block of a row of blocks with the colors of the framebuffer, the pixels without samples taking the color of the block's first pixel.
+ * @param[in,out] colors. Planar colors of the row of blocks, stored row after row.
+ * @param[in] framebuffer. Framebuffer whose colors to copy.
+ * @param[in] first_column. Column of the block's first pixel.
+ * @param[in] first_row. Row of the block's first pixel, i.e. of the row of blocks.
+ * @param[in] block_size. Width of the block.
+ * @param[in] row_count. Number of rows of the row of blocks.
+ */
+void copy_block(std::array<std::vector<float>, 3>& colors, Framebuffer const& framebuffer, int first_column, int first_row, int block_size, int row_count)
+{
+    auto const width = framebuffer.get_width();
+    auto const end_column = (std::min)(first_column + block_size, width);
+    auto const first_index = first_row * width + first_column;
+    for (auto row_it = 0; row_it < row_count; row_it++)
+    {
+        for (auto column = first_column; column < end_column; column++)
+        {
+            auto const index = (first_row + row_it) * width + column;
+            auto const source_index = (framebuffer.get_sample_count(index) > 0) ? index : first_index;
+            colors[0][row_it * width + column] = framebuffer.get_red()[source_index];
+            colors[1][row_it * width + column] = framebuffer.get_green()[source_index];
+            colors[2][row_it * width + column] = framebuffer.get_blue()[source_index];
+        }
+    }
+}
+
+} // namespace
+
 Renderer_Base::Renderer_Base()
     : m_draw_camera{}
     , m_framebuffer_width{0}
@@ -19,9 +198,77 @@ Renderer_Base::Renderer_Base()
     , m_scene{}
     , m_culling_type{culling::Type::BackFace}
     , m_loading_threads{}
+    , m_worker_pool{}
     , m_thread_guard{}
     , m_last_loaded_row{0}
-    , m_loaded_pixels{}
+    , m_published_rectangles{}
+    , m_published_colors{}
+    , m_published_width{0}
+    , m_published_height{0}
+    , m_framebuffer{}
+    , m_display_transform{}
+    , m_integrator_type{Integrator_Type::whitted}
+    , m_samples_per_pixel{1}
+    , m_max_bounce_count{8}
+    , m_adaptive_base_sample_count{0}
+    , m_adaptive_max_sample_count{0}
+    , m_adaptive_error_threshold{0.0f}
+    , m_adaptive_noise_target{0.0f}
+    , m_active_tiles{}
+    , m_average_sample_count{0.0f}
+    , m_requested_aovs{}
+    , m_denoiser_enabled{false}
+    , m_denoiser{}
+    , m_wavefront_enabled{false}
+    , m_wavefront_tile_row_count{2}
+    , m_progressive_enabled{false}
+    , m_progressive_max_sample_count{256}
+    , m_progressive_block_size{1}
+    , m_progressive_sample_count{1}
+    , m_frame_generation{0}
+    , m_stop_requested{false}
+    , m_pending_changes_guard{}
+    , m_pending_changes_condition{}
+    , m_has_pending_camera{false}
+    , m_pending_camera{}
+    , m_pending_scene_edits{}
+    , m_has_pending_resolution{false}
+    , m_pending_width{0}
+    , m_pending_height{0}
+    , m_has_pending_target_frame_time{false}
+    , m_pending_target_frame_time{0.0f}
+    , m_output_width{0}
+    , m_output_height{0}
+    , m_target_frame_time{0.0f}
+    , m_quality_level{full_quality_level}
+    , m_smoothed_frame_time{0.0f}
+    , m_quality_raise_streak{0}
+    , m_reflection_depth_limit{unlimited_reflection_depth}
+    , m_reprojection_enabled{false}
+    , m_reprojection_refresh_ratio{0.05f}
+    , m_reprojection_max_reflective_intensity{0.2f}
+    , m_dirty_regions_enabled{false}
+    , m_are_footprints_complete{false}
+    , m_hybrid_visibility_enabled{false}
+    , m_visibility_sphere_segment_count{48}
+    , m_is_visibility_buffer_current{false}
+    , m_visibility_hit_count{0}
+    , m_camera_rays{}
+    , m_view_culling_enabled{true}
+    , m_is_view_culling_current{false}
+    , m_view_tile_offsets{}
+    , m_view_tile_objects{}
+    , m_views{}
+    , m_view_column_count{1}
+    , m_view_row_count{1}
+    , m_next_view_tile{0}
+    , m_shadow_detection_grid_size{2}
+    , m_shadow_penumbra_grid_size{8}
+    , m_shadow_ray_count{0}
+    , m_area_light_evaluations{0}
+    , m_refined_evaluations{0}
+    , m_reused_shadow_points{0}
+    , m_statistics_output_enabled{false}
 {
 }
 
@@ -31,13 +278,426 @@ void Renderer_Base::initialize(Camera const& draw_camera, Vec3f const& backgroun
     m_background_color = background_color;
     m_framebuffer_width = draw_camera.get_width();
     m_framebuffer_height = draw_camera.get_height();
+    m_framebuffer.resize(m_framebuffer_width, m_framebuffer_height);
+    m_published_width = m_framebuffer_width;
+    m_published_height = m_framebuffer_height;
+    m_output_width = m_framebuffer_width;
+    m_output_height = m_framebuffer_height;
     m_scene.setup_default_scene();
 }
 
 void Renderer_Base::release()
 {
+    // Stop progressive rendering, which would otherwise keep waiting for changes
+    {
+        std::lock_guard<std::mutex> lock{m_pending_changes_guard};
+        m_stop_requested = true;
+    }
+    m_pending_changes_condition.notify_all();
     for (auto& loading_thread : m_loading_threads)
         loading_thread.join();
+    m_loading_threads.clear();
+    m_worker_pool.stop();
+}
+
+void Renderer_Base::set_tone_curve(Tone_Curve tone_curve) { m_display_transform = Display_Transform{tone_curve}; }
+
+void Renderer_Base::set_light_selection(Light_Selection_Mode mode, float radiance_threshold, unsigned int sample_count) { m_scene.set_light_selection(mode, radiance_threshold, sample_count); }
+
+void Renderer_Base::set_integrator(Integrator_Type integrator_type, unsigned int samples_per_pixel, unsigned int max_bounce_count)
+{
+    m_integrator_type = integrator_type;
+    m_samples_per_pixel = (std::max)(samples_per_pixel, 1u);
+    m_max_bounce_count = (std::max)(max_bounce_count, 1u);
+}
+
+void Renderer_Base::set_adaptive_sampling(unsigned int base_sample_count, unsigned int max_sample_count, float error_threshold, float noise_target)
+{
+    m_adaptive_base_sample_count = (base_sample_count == 0) ? 0 : (std::max)(base_sample_count, 2u);
+    m_adaptive_max_sample_count = (std::max)(max_sample_count, m_adaptive_base_sample_count);
+    m_adaptive_error_threshold = error_threshold;
+    m_adaptive_noise_target = noise_target;
+}
+
+void Renderer_Base::set_aov_enabled(AOV_Type type, bool enabled)
+{
+    m_requested_aovs[static_cast<std::size_t>(type)] = enabled;
+    update_framebuffer_aovs();
+}
+
+void Renderer_Base::set_denoiser(bool enabled, Denoiser const& denoiser)
+{
+    m_denoiser_enabled = enabled;
+    m_denoiser = denoiser;
+    update_framebuffer_aovs();
+}
+
+void Renderer_Base::update_framebuffer_aovs()
+{
+    for (auto type_it = 0u; type_it < aov_type_count; type_it++)
+    {
+        auto const type = static_cast<AOV_Type>(type_it);
+        auto const is_guide = (type != AOV_Type::direct_lighting);
+        auto const enabled = m_requested_aovs[type_it] || (m_denoiser_enabled && is_guide);
+        if (enabled != m_framebuffer.is_aov_enabled(type))
+            m_framebuffer.set_aov_enabled(type, enabled);
+    }
+}
+
+void Renderer_Base::write_framebuffer_image(char const* path) const
+{
+    // Convert the linear framebuffer to display values, once per pixel
+    std::vector<unsigned char> display_pixels(3 * static_cast<std::size_t>(m_framebuffer.get_pixel_count()));
+    m_display_transform.apply(m_framebuffer.get_red(), m_framebuffer.get_green(), m_framebuffer.get_blue(), m_framebuffer.get_pixel_count(), display_pixels.data());
+    // Output the pixels to file, from the top row to the bottom one
+    std::ofstream ofs(path, std::ios::out | std::ios::binary);
+    ofs << "P6\n" << m_framebuffer_width << " " << m_framebuffer_height << "\n255\n";
+    auto const row_size = 3 * static_cast<std::size_t>(m_framebuffer_width);
+    for (auto row_it = m_framebuffer_height - 1; row_it >= 0; row_it--)
+        ofs.write(reinterpret_cast<char const*>(display_pixels.data() + row_it * row_size), row_size);
+}
+
+void Renderer_Base::set_wavefront_pipeline(bool enabled, unsigned int tile_row_count)
+{
+    m_wavefront_enabled = enabled;
+    m_wavefront_tile_row_count = static_cast<int>((std::max)(tile_row_count, 1u));
+}
+
+void Renderer_Base::set_progressive_rendering(bool enabled, unsigned int max_sample_count)
+{
+    m_progressive_enabled = enabled;
+    m_progressive_max_sample_count = (std::max)(max_sample_count, 1u);
+}
+
+void Renderer_Base::set_camera(Camera const& draw_camera)
+{
+    if (!m_progressive_enabled)
+    {
+        m_draw_camera = draw_camera;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_pending_changes_guard};
+        m_pending_camera = draw_camera;
+        m_has_pending_camera = true;
+        m_frame_generation++;
+    }
+    m_pending_changes_condition.notify_all();
+}
+
+void Renderer_Base::set_resolution(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return;
+    if (!m_progressive_enabled)
+    {
+        m_output_width = width;
+        m_output_height = height;
+        update_view_layout();
+        resize_framebuffer(width * m_view_column_count, height * m_view_row_count);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_pending_changes_guard};
+        m_pending_width = width;
+        m_pending_height = height;
+        m_has_pending_resolution = true;
+        m_frame_generation++;
+    }
+    m_pending_changes_condition.notify_all();
+}
+
+void Renderer_Base::set_target_frame_time(float milliseconds)
+{
+    if (!m_progressive_enabled)
+    {
+        apply_target_frame_time((std::max)(milliseconds, 0.0f));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_pending_changes_guard};
+        m_pending_target_frame_time = (std::max)(milliseconds, 0.0f);
+        m_has_pending_target_frame_time = true;
+        m_frame_generation++;
+    }
+    m_pending_changes_condition.notify_all();
+}
+
+void Renderer_Base::apply_target_frame_time(float milliseconds)
+{
+    m_target_frame_time = milliseconds;
+    m_quality_level = full_quality_level;
+    m_smoothed_frame_time = 0.0f;
+    m_quality_raise_streak = 0;
+}
+
+Quality_Level Renderer_Base::get_quality_level() const { return quality_levels[m_quality_level]; }
+
+void Renderer_Base::set_temporal_reprojection(bool enabled, float refresh_ratio, float max_reflective_intensity)
+{
+    m_reprojection_enabled = enabled;
+    m_reprojection_refresh_ratio = (std::min)((std::max)(refresh_ratio, 0.0f), 1.0f);
+    m_reprojection_max_reflective_intensity = max_reflective_intensity;
+}
+
+void Renderer_Base::set_dirty_region_rendering(bool enabled)
+{
+    m_dirty_regions_enabled = enabled;
+    m_are_footprints_complete = false;
+}
+
+void Renderer_Base::set_hybrid_visibility(bool enabled, unsigned int sphere_segment_count)
+{
+    m_hybrid_visibility_enabled = enabled;
+    m_visibility_sphere_segment_count = sphere_segment_count;
+}
+
+void Renderer_Base::update_visibility_buffer()
+{
+    m_visibility_hit_count = 0;
+    m_is_visibility_buffer_current =
+        m_hybrid_visibility_enabled && m_integrator_type == Integrator_Type::whitted && !m_progressive_enabled && m_adaptive_base_sample_count == 0 && !m_wavefront_enabled && m_views.empty();
+    if (!m_is_visibility_buffer_current)
+        return;
+    // Tessellate the scene as it is for this frame, then rasterize it on the worker threads
+    m_visibility_rasterizer.set_scene(m_scene, m_visibility_sphere_segment_count);
+    m_visibility_rasterizer.rasterize(m_draw_camera, m_framebuffer_width, m_framebuffer_height, m_culling_type, m_worker_pool);
+}
+
+void Renderer_Base::set_view_culling(bool enabled) { m_view_culling_enabled = enabled; }
+
+void Renderer_Base::set_views(std::vector<Camera> const& view_cameras, View_Layout layout)
+{
+    auto const view_count = static_cast<int>(view_cameras.size());
+    m_view_column_count = (view_count == 0) ? 1 : ((layout == View_Layout::cube_map) ? (std::min)(view_count, 3) : view_count);
+    m_view_row_count = (view_count == 0) ? 1 : (view_count + m_view_column_count - 1) / m_view_column_count;
+    m_views.clear();
+    m_views.resize(view_cameras.size());
+    for (auto view_it = 0; view_it < view_count; view_it++)
+    {
+        auto& view = m_views[view_it];
+        view.camera = view_cameras[view_it];
+        // Copy an earlier view rendered with the same camera, or else reuse the shadows of the first earlier view looking the same way
+        for (auto earlier_it = 0; earlier_it < view_it && view.copied_view < 0; earlier_it++)
+        {
+            auto const& earlier_camera = m_views[earlier_it].camera;
+            if (m_views[earlier_it].copied_view >= 0)
+                continue;
+            if (are_same_views(view.camera, earlier_camera))
+                view.copied_view = earlier_it;
+            else if (view.shadow_view < 0 && view.camera.get_forward().dot(earlier_camera.get_forward()) >= shadow_sharing_min_cosine)
+                view.shadow_view = earlier_it;
+        }
+        if (view.copied_view >= 0)
+            view.shadow_view = -1;
+        else if (view.shadow_view >= 0)
+            m_views[view.shadow_view].is_recording_shadows = true;
+    }
+    update_view_layout();
+    resize_framebuffer(m_output_width * m_view_column_count, m_output_height * m_view_row_count);
+}
+
+void Renderer_Base::update_view_layout()
+{
+    // Views are laid out from the top left, while the framebuffer's first row is its bottom one
+    for (auto view_it = 0; view_it < static_cast<int>(m_views.size()); view_it++)
+    {
+        m_views[view_it].first_column = (view_it % m_view_column_count) * m_output_width;
+        m_views[view_it].first_row = (m_view_row_count - 1 - view_it / m_view_column_count) * m_output_height;
+    }
+}
+
+void Renderer_Base::update_view_culling()
+{
+    m_is_view_culling_current = m_view_culling_enabled;
+    if (m_is_view_culling_current)
+        list_tile_objects(m_draw_camera, m_framebuffer_width, m_framebuffer_height, m_view_tile_offsets, m_view_tile_objects);
+}
+
+void Renderer_Base::list_tile_objects(Camera const& camera, int width, int height, std::vector<std::size_t>& out_tile_offsets, std::vector<std::uint32_t>& out_tile_objects) const
+{
+    auto const tile_column_count = (width + view_culling_tile_size - 1) / view_culling_tile_size;
+    auto const tile_row_count = (height + view_culling_tile_size - 1) / view_culling_tile_size;
+    auto const& camera_position = camera.get_position();
+    auto const near_plane = camera.get_near();
+    auto const far_plane = camera.get_far();
+    auto const column_scale = static_cast<float>(width - 1);
+    auto const row_scale = static_cast<float>(height - 1);
+
+    // Find the tiles whose sub-frustum each object's bounds overlap, as first and last columns and rows of tiles, empty for the objects out of the view
+    auto const& objects = m_scene.get_objects();
+    std::vector<std::array<int, 4>> object_tiles(objects.size(), std::array<int, 4>{0, -1, 0, -1});
+    for (auto object_it = 0u; object_it < objects.size(); object_it++)
+    {
+        auto const& box_min = objects[object_it].get_bounds_min();
+        auto const& box_max = objects[object_it].get_bounds_max();
+        // Camera rays only reach points ahead of the camera, between the near and far distances from it
+        auto const nearest_offset = Vec3f{math::clamp(camera_position.x(), box_min.x(), box_max.x()), math::clamp(camera_position.y(), box_min.y(), box_max.y()),
+                                          math::clamp(camera_position.z(), box_min.z(), box_max.z())} -
+                                    camera_position;
+        auto const farthest_offset = Vec3f{(std::max)(std::abs(box_min.x() - camera_position.x()), std::abs(box_max.x() - camera_position.x())),
+                                           (std::max)(std::abs(box_min.y() - camera_position.y()), std::abs(box_max.y() - camera_position.y())),
+                                           (std::max)(std::abs(box_min.z() - camera_position.z()), std::abs(box_max.z() - camera_position.z()))};
+        if (nearest_offset.length() > far_plane || farthest_offset.length() < near_plane)
+            continue;
+        std::array<Vec3f, 8> view_corners{Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero(), Vec3f::zero()};
+        auto depth_min = (std::numeric_limits<float>::max)();
+        auto depth_max = (std::numeric_limits<float>::lowest)();
+        for (auto corner = 0u; corner < 8; corner++)
+        {
+            auto const position = Vec3f{(corner & 1) ? box_max.x() : box_min.x(), (corner & 2) ? box_max.y() : box_min.y(), (corner & 4) ? box_max.z() : box_min.z()};
+            view_corners[corner] = camera.to_view_space(position);
+            depth_min = (std::min)(depth_min, view_corners[corner].z());
+            depth_max = (std::max)(depth_max, view_corners[corner].z());
+        }
+        if (depth_max <= 0.0f)
+            continue;
+        auto& tiles = object_tiles[object_it];
+        // Bounds crossing the camera's plane may project anywhere
+        if (depth_min <= 0.0f)
+        {
+            tiles = {0, tile_column_count - 1, 0, tile_row_count - 1};
+            continue;
+        }
+
+        // Project the box's corners through the near plane, as camera rays are cast, then widen the projection by a pixel on each side,
+        // since jittered camera rays cross the plane anywhere within half a pixel of the pixels' centers
+        auto column_min = (std::numeric_limits<float>::max)();
+        auto column_max = (std::numeric_limits<float>::lowest)();
+        auto row_min = (std::numeric_limits<float>::max)();
+        auto row_max = (std::numeric_limits<float>::lowest)();
+        for (auto const& corner : view_corners)
+        {
+            auto const column = (near_plane * corner.x() / corner.z() + 0.5f) * column_scale;
+            auto const row = (near_plane * corner.y() / corner.z() + 0.5f) * row_scale;
+            column_min = (std::min)(column_min, column);
+            column_max = (std::max)(column_max, column);
+            row_min = (std::min)(row_min, row);
+            row_max = (std::max)(row_max, row);
+        }
+        auto const first_column = static_cast<int>(std::floor((std::max)(column_min - 1.0f, 0.0f)));
+        auto const last_column = static_cast<int>(std::ceil((std::min)(column_max + 1.0f, column_scale)));
+        auto const first_row = static_cast<int>(std::floor((std::max)(row_min - 1.0f, 0.0f)));
+        auto const last_row = static_cast<int>(std::ceil((std::min)(row_max + 1.0f, row_scale)));
+        if (first_column > last_column || first_row > last_row)
+            continue;
+        tiles = {first_column / view_culling_tile_size, last_column / view_culling_tile_size, first_row / view_culling_tile_size, last_row / view_culling_tile_size};
+    }
+
+    // List the objects of each tile in the scene's order, which keeps the closest hit the same as when testing the whole scene
+    out_tile_offsets.assign(static_cast<std::size_t>(tile_column_count) * tile_row_count + 1, 0);
+    for (auto const& tiles : object_tiles)
+        for (auto tile_row = tiles[2]; tile_row <= tiles[3]; tile_row++)
+            for (auto tile_column = tiles[0]; tile_column <= tiles[1]; tile_column++)
+                out_tile_offsets[tile_row * tile_column_count + tile_column + 1]++;
+    for (auto tile_it = 1u; tile_it < out_tile_offsets.size(); tile_it++)
+        out_tile_offsets[tile_it] += out_tile_offsets[tile_it - 1];
+    out_tile_objects.resize(out_tile_offsets.back());
+    auto next_slots = out_tile_offsets;
+    for (auto object_it = 0u; object_it < objects.size(); object_it++)
+    {
+        auto const& tiles = object_tiles[object_it];
+        for (auto tile_row = tiles[2]; tile_row <= tiles[3]; tile_row++)
+            for (auto tile_column = tiles[0]; tile_column <= tiles[1]; tile_column++)
+                out_tile_objects[next_slots[tile_row * tile_column_count + tile_column]++] = object_it;
+    }
+}
+
+void Renderer_Base::apply_quality_level()
+{
+    auto const& level = quality_levels[m_quality_level];
+    m_reflection_depth_limit = level.reflection_depth;
+    auto const width = (std::max)(static_cast<int>(m_output_width * level.resolution_scale + 0.5f), 1);
+    auto const height = (std::max)(static_cast<int>(m_output_height * level.resolution_scale + 0.5f), 1);
+    resize_framebuffer(width, height);
+}
+
+void Renderer_Base::update_quality_level(float frame_time)
+{
+    // Smooth the measured times, the average restarting whenever the level changes since it measured another level's cost
+    m_smoothed_frame_time = (m_smoothed_frame_time > 0.0f) ? math::linear_interpolation(m_smoothed_frame_time, frame_time, frame_time_smoothing) : frame_time;
+    auto const level = m_quality_level.load();
+    auto const level_cost = compute_quality_level_cost(quality_levels[level]);
+    auto next_level = level;
+
+    // Frames over budget drop at once to the best level predicted to fit, so that the frame rate recovers quickly
+    if (m_smoothed_frame_time > m_target_frame_time * quality_drop_tolerance)
+    {
+        while (next_level > 0 && m_smoothed_frame_time * compute_quality_level_cost(quality_levels[next_level]) / level_cost > m_target_frame_time)
+            next_level--;
+        m_quality_raise_streak = 0;
+    }
+    // The quality only rises one level at a time, once several frames in a row leave enough room for it, so that the level does not oscillate around the target
+    else if (level + 1 < quality_level_count && m_smoothed_frame_time * compute_quality_level_cost(quality_levels[level + 1]) / level_cost < m_target_frame_time * quality_raise_margin)
+    {
+        if (++m_quality_raise_streak >= quality_raise_frame_count)
+            next_level = level + 1;
+    }
+    else
+    {
+        m_quality_raise_streak = 0;
+    }
+
+    if (next_level != level)
+    {
+        m_quality_level = next_level;
+        m_smoothed_frame_time = 0.0f;
+        m_quality_raise_streak = 0;
+    }
+}
+
+int Renderer_Base::get_whitted_recursion_depth() const { return static_cast<int>((std::min)(static_cast<unsigned int>(whitted_recursion_depth), m_reflection_depth_limit)); }
+
+unsigned int Renderer_Base::get_path_bounce_count() const { return (m_reflection_depth_limit < m_max_bounce_count) ? m_reflection_depth_limit + 1 : m_max_bounce_count; }
+
+void Renderer_Base::resize_framebuffer(int width, int height)
+{
+    if (width == m_framebuffer_width && height == m_framebuffer_height)
+        return;
+    m_framebuffer.resample(width, height);
+    m_framebuffer_width = width;
+    m_framebuffer_height = height;
+    // Rectangles published at the previous size can no longer be displayed, so they are replaced by the previous image upscaled to the new size
+    {
+        std::lock_guard<std::mutex> lock{m_thread_guard};
+        m_published_rectangles.clear();
+        m_published_colors.clear();
+        m_published_width = width;
+        m_published_height = height;
+    }
+    publish_framebuffer_rows(0, height);
+}
+
+void Renderer_Base::edit_scene(std::function<void(Scene&)> const& edit)
+{
+    if (!m_progressive_enabled)
+    {
+        edit(m_scene);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_pending_changes_guard};
+        m_pending_scene_edits.push_back(edit);
+        m_frame_generation++;
+    }
+    m_pending_changes_condition.notify_all();
+}
+
+void Renderer_Base::set_area_light_sampling(unsigned int detection_grid_size, unsigned int penumbra_grid_size)
+{
+    m_shadow_detection_grid_size = (std::max)(detection_grid_size, 1u);
+    auto const cells_per_coarse_cell = (std::max)((penumbra_grid_size + m_shadow_detection_grid_size - 1) / m_shadow_detection_grid_size, 1u);
+    m_shadow_penumbra_grid_size = cells_per_coarse_cell * m_shadow_detection_grid_size;
+}
+
+Shadow_Ray_Statistics Renderer_Base::get_shadow_ray_statistics() const
+{
+    Shadow_Ray_Statistics statistics;
+    statistics.ray_count = m_shadow_ray_count.load();
+    statistics.area_light_evaluations = m_area_light_evaluations.load();
+    statistics.refined_evaluations = m_refined_evaluations.load();
+    statistics.reused_point_count = m_reused_shadow_points.load();
+    return statistics;
 }
 
 std::pair<Object const*, float> Renderer_Base::compute_closest_intersection_with_scene(geometry::Ray const& ray, float near_limit, float far_limit) const
@@ -45,8 +705,33 @@ std::pair<Object const*, float> Renderer_Base::compute_closest_intersection_with
     std::vector<float> intersections;
     Object const* intersected_object = nullptr;
     float closest_intersection = far_limit;
-    for (auto const& object : m_scene.get_objects())
+    auto const& objects = m_scene.get_objects();
+    for (auto object_it = 0u; object_it < objects.size(); object_it++)
+    {
+        prefetch_primitive(objects, object_it + traversal_prefetch_distance);
+        auto const& object = objects[object_it];
+        object.get_primitive().compute_intersection_with(ray, near_limit, far_limit, m_culling_type, intersections);
+        if (intersections.size() > 0 && intersections[0] <= closest_intersection)
+        {
+            intersected_object = &object;
+            closest_intersection = intersections[0];
+        }
+    }
+    return {intersected_object, closest_intersection};
+}
+
+std::pair<Object const*, float> Renderer_Base::compute_closest_intersection_with_objects(geometry::Ray const& ray, float near_limit, float far_limit, std::uint32_t const* object_indices,
+                                                                                       std::size_t object_count) const
+{
+    thread_local std::vector<float> intersections;
+    Object const* intersected_object = nullptr;
+    float closest_intersection = far_limit;
+    auto const& objects = m_scene.get_objects();
+    for (auto index_it = 0u; index_it < object_count; index_it++)
     {
+        if (index_it + traversal_prefetch_distance < object_count)
+            prefetch_primitive(objects, object_indices[index_it + traversal_prefetch_distance]);
+        auto const& object = objects[object_indices[index_it]];
         object.get_primitive().compute_intersection_with(ray, near_limit, far_limit, m_culling_type, intersections);
         if (intersections.size() > 0 && intersections[0] <= closest_intersection)
         {
@@ -57,6 +742,86 @@ std::pair<Object const*, float> Renderer_Base::compute_closest_intersection_with
     return {intersected_object, closest_intersection};
 }
 
+void Renderer_Base::compute_closest_intersections_with_scene(geometry::Ray const* rays, float const* near_limits, float const* far_limits, unsigned int count, Object const** out_objects, float* out_distances) const
+{
+    thread_local std::vector<float> intersections;
+    for (auto ray_it = 0u; ray_it < count; ray_it++)
+    {
+        out_objects[ray_it] = nullptr;
+        out_distances[ray_it] = far_limits[ray_it];
+    }
+    // Walk the objects once for the whole group, advancing every ray by one object in turn, so that each primitive is fetched once per group rather than once per ray
+    auto const& objects = m_scene.get_objects();
+    for (auto object_it = 0u; object_it < objects.size(); object_it++)
+    {
+        prefetch_primitive(objects, object_it + traversal_prefetch_distance);
+        auto const& object = objects[object_it];
+        auto const& primitive = object.get_primitive();
+        for (auto ray_it = 0u; ray_it < count; ray_it++)
+        {
+            primitive.compute_intersection_with(rays[ray_it], near_limits[ray_it], far_limits[ray_it], m_culling_type, intersections);
+            if (intersections.size() > 0 && intersections[0] <= out_distances[ray_it])
+            {
+                out_objects[ray_it] = &object;
+                out_distances[ray_it] = intersections[0];
+            }
+        }
+    }
+}
+
+Traversal_Benchmark Renderer_Base::benchmark_traversal(std::size_t sphere_count, unsigned int ray_count, unsigned int group_size)
+{
+    m_scene.setup_sphere_field(sphere_count);
+    // Shoot the rays from the origin in random directions through the field, from a fixed seed so that every run traces the same rays
+    std::mt19937 random_engine{0};
+    std::uniform_real_distribution<float> offset_distribution{-0.5f, 0.5f};
+    std::vector<geometry::Ray> rays;
+    rays.reserve(ray_count);
+    for (auto ray_it = 0u; ray_it < ray_count; ray_it++)
+        rays.push_back(geometry::Ray{Vec3f::zero(), Vec3f{offset_distribution(random_engine), offset_distribution(random_engine), 1.0f}.normalize()});
+    std::vector<float> near_limits(ray_count, m_draw_camera.get_near());
+    std::vector<float> far_limits(ray_count, m_draw_camera.get_far());
+
+    // Trace the rays one after the other, then in groups
+    std::vector<Object const*> single_objects(ray_count);
+    auto const single_start = std::chrono::steady_clock::now();
+    for (auto ray_it = 0u; ray_it < ray_count; ray_it++)
+        single_objects[ray_it] = compute_closest_intersection_with_scene(rays[ray_it], near_limits[ray_it], far_limits[ray_it]).first;
+    auto const single_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - single_start).count();
+    std::vector<Object const*> grouped_objects(ray_count);
+    std::vector<float> grouped_distances(ray_count);
+    auto const grouped_start = std::chrono::steady_clock::now();
+    for (auto first_ray = 0u; first_ray < ray_count; first_ray += group_size)
+    {
+        auto const count = (std::min)(group_size, ray_count - first_ray);
+        compute_closest_intersections_with_scene(rays.data() + first_ray, near_limits.data() + first_ray, far_limits.data() + first_ray, count, grouped_objects.data() + first_ray,
+                                                 grouped_distances.data() + first_ray);
+    }
+    auto const grouped_time = std::chrono::duration<float>(std::chrono::steady_clock::now() - grouped_start).count();
+
+    // Every ray is tested against every object, the scene having no acceleration structure
+    auto const test_count = 1e-6f * static_cast<float>(sphere_count) * static_cast<float>(ray_count);
+    Traversal_Benchmark benchmark;
+    benchmark.single_ray_throughput = test_count / single_time;
+    benchmark.grouped_throughput = test_count / grouped_time;
+    benchmark.are_hits_identical = (single_objects == grouped_objects);
+    return benchmark;
+}
+
+float Renderer_Base::measure_frame_time(unsigned int frame_count)
+{
+    // Launch the threads of each frame and wait for them to finish processing, as the renderer to file does
+    auto const start = std::chrono::steady_clock::now();
+    for (auto frame_it = 0u; frame_it < frame_count; frame_it++)
+    {
+        launch_pixel_loading_threads();
+        for (auto& loading_thread : m_loading_threads)
+            loading_thread.join();
+        m_loading_threads.clear();
+    }
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / static_cast<float>(frame_count);
+}
+
 bool Renderer_Base::intersects_any_object(geometry::Ray const& ray, float near_limit, float far_limit, bool invert_culling, Object const* first_element_to_check) const
 {
     auto const culling_type = (invert_culling ? culling::opposite(m_culling_type) : m_culling_type);
@@ -67,8 +832,11 @@ bool Renderer_Base::intersects_any_object(geometry::Ray const& ray, float near_l
         if (intersections.size() > 0)
             return true;
     }
-    for (auto const& object : m_scene.get_objects())
+    auto const& objects = m_scene.get_objects();
+    for (auto object_it = 0u; object_it < objects.size(); object_it++)
     {
+        prefetch_primitive(objects, object_it + traversal_prefetch_distance);
+        auto const& object = objects[object_it];
         if (first_element_to_check != nullptr && &object == first_element_to_check)
             continue;
         object.get_primitive().compute_intersection_with(ray, near_limit, far_limit, culling_type, intersections);
@@ -78,9 +846,203 @@ bool Renderer_Base::intersects_any_object(geometry::Ray const& ray, float near_l
     return false;
 }
 
-Vec3f const Renderer_Base::compute_color_from_ray(geometry::Ray const& ray, float near_limit, float far_limit, float recursion_depth) const
+void Renderer_Base::trace_shadow_rays(Trace_Context& context, Shadow_Query* queries, unsigned int count, bool invert_culling) const
+{
+    auto const culling_type = (invert_culling ? culling::opposite(m_culling_type) : m_culling_type);
+    auto const& objects = m_scene.get_objects();
+    auto const& lights = m_scene.get_lights();
+    thread_local std::vector<float> intersections;
+    // Per-thread cache of the last occluder found for each light, which is likely to occlude the next shadow ray cast towards the same light
+    thread_local std::vector<Object const*> last_occluders;
+    if (last_occluders.size() != lights.size())
+        last_occluders.assign(lights.size(), nullptr);
+
+    context.shadow_ray_statistics.ray_count += count;
+
+    // Test the cached occluder of each ray's light first
+    auto unresolved_count = count;
+    for (auto i = 0u; i < count; i++)
+    {
+        auto& query = queries[i];
+        query.occluder = nullptr;
+        auto const light_index = (query.light != nullptr) ? static_cast<std::size_t>(query.light - lights.data()) : lights.size();
+        auto const* cached_occluder = (light_index < lights.size()) ? last_occluders[light_index] : nullptr;
+        if (cached_occluder == nullptr)
+            continue;
+        cached_occluder->get_primitive().compute_intersection_with(geometry::Ray{query.origin, query.direction}, query.near_limit, query.far_limit, culling_type, intersections);
+        if (intersections.size() > 0)
+        {
+            query.occluder = cached_occluder;
+            unresolved_count--;
+        }
+    }
+
+    // Test each object against all unresolved rays of the batch, stopping as soon as every ray is occluded
+    for (auto object_it = 0u; object_it < objects.size() && unresolved_count > 0; object_it++)
+    {
+        prefetch_primitive(objects, object_it + traversal_prefetch_distance);
+        auto const& primitive = objects[object_it].get_primitive();
+        for (auto i = 0u; i < count; i++)
+        {
+            auto& query = queries[i];
+            if (query.occluder != nullptr)
+                continue;
+            primitive.compute_intersection_with(geometry::Ray{query.origin, query.direction}, query.near_limit, query.far_limit, culling_type, intersections);
+            if (intersections.size() > 0)
+            {
+                query.occluder = &objects[object_it];
+                unresolved_count--;
+                auto const light_index = (query.light != nullptr) ? static_cast<std::size_t>(query.light - lights.data()) : lights.size();
+                if (light_index < lights.size())
+                    last_occluders[light_index] = query.occluder;
+            }
+        }
+    }
+
+    // Record the occluders in the current pixel's footprint, so that editing them renders the shadows again
+    if (context.edit_footprint != nullptr)
+        for (auto i = 0u; i < count; i++)
+            if (queries[i].occluder != nullptr)
+                context.edit_footprint->record_object(static_cast<std::size_t>(queries[i].occluder - objects.data()));
+}
+
+void Renderer_Base::compute_light_visibilities(Trace_Context& context, Vec3f const& point_position, float near_limit, Light_Sample const* lights, unsigned int count, float* out_visibilities) const
 {
-    auto const closest_intersection = compute_closest_intersection_with_scene(ray, near_limit, far_limit);
+    // In multi-view frames, the first hit of a pixel may reuse the visibilities of another view's hit at the same point, or record its own for other views
+    auto const* const scene_lights = m_scene.get_lights().data();
+    if (context.reused_shadows != nullptr && context.reused_shadows->find(point_position, lights, count, scene_lights, out_visibilities))
+    {
+        context.shadow_ray_statistics.reused_point_count++;
+    }
+    else
+    {
+        Shadow_Point point;
+        point.position = point_position;
+        point.near_limit = near_limit;
+        point.first_light = 0;
+        point.light_count = count;
+        compute_light_visibilities(context, &point, 1, lights, out_visibilities);
+    }
+    if (context.recorded_shadows != nullptr)
+        context.recorded_shadows->record(context.recorded_pixel, point_position, lights, count, scene_lights, out_visibilities);
+}
+
+void Renderer_Base::compute_light_visibilities(Trace_Context& context, Shadow_Point const* points, unsigned int point_count, Light_Sample const* lights, float* out_visibilities) const
+{
+    thread_local std::vector<Shadow_Query> queries;
+    thread_local std::vector<Light_Shadow_Rays> light_rays;
+    auto light_count = 0u;
+    for (auto point_it = 0u; point_it < point_count; point_it++)
+        light_count = (std::max)(light_count, points[point_it].first_light + points[point_it].light_count);
+    light_rays.assign(light_count, Light_Shadow_Rays{0, 0, 0, 0, 0, 0});
+    auto const detection_grid_size = m_shadow_detection_grid_size;
+    auto const penumbra_grid_size = m_shadow_penumbra_grid_size;
+    auto const cells_per_coarse_cell = penumbra_grid_size / detection_grid_size;
+    auto const add_query = [&](Shadow_Point const& point, Light const& light, Vec3f const& light_position) {
+        auto const point_to_light = light_position - point.position;
+        Shadow_Query query;
+        query.origin = point.position;
+        query.direction = point_to_light.normalize();
+        query.near_limit = point.near_limit;
+        query.far_limit = point_to_light.length();
+        query.light = &light;
+        queries.push_back(query);
+    };
+    auto const add_area_light_query = [&](Shadow_Point const& point, Light const& light, unsigned int cell_x, unsigned int cell_y) {
+        auto const sample = Vec2f{(cell_x + math::generate_random_01()) / penumbra_grid_size, (cell_y + math::generate_random_01()) / penumbra_grid_size};
+        add_query(point, light, light.sample_position(sample, point.position));
+    };
+    auto const count_visible_rays = [&]() {
+        for (auto light_it = 0u; light_it < light_count; light_it++)
+        {
+            auto& rays = light_rays[light_it];
+            for (auto query_it = rays.first_query; query_it < rays.first_query + rays.query_count; query_it++)
+                rays.visible_count += (queries[query_it].occluder == nullptr) ? 1 : 0;
+            rays.traced_count += rays.query_count;
+            rays.query_count = 0;
+        }
+    };
+
+    // Detection pass: one ray towards point and directional lights, and one ray per coarse cell of area lights, placed in a random fine cell of it
+    queries.clear();
+    for (auto point_it = 0u; point_it < point_count; point_it++)
+    {
+        auto const& point = points[point_it];
+        for (auto light_it = point.first_light; light_it < point.first_light + point.light_count; light_it++)
+        {
+            auto const& light = *lights[light_it].light;
+            auto& rays = light_rays[light_it];
+            rays.first_query = static_cast<unsigned int>(queries.size());
+            if (light.get_type() == Light_Type::ambient)
+                continue;
+            if (!light.is_area_light())
+            {
+                Shadow_Query query;
+                query.origin = point.position;
+                query.direction = light.compute_point_to_light_direction(point.position);
+                query.near_limit = point.near_limit;
+                query.far_limit = light.compute_point_to_light_distance(point.position);
+                query.light = &light;
+                queries.push_back(query);
+            }
+            else
+            {
+                rays.sub_cell_x = (std::min)(static_cast<unsigned int>(math::generate_random_01() * cells_per_coarse_cell), cells_per_coarse_cell - 1);
+                rays.sub_cell_y = (std::min)(static_cast<unsigned int>(math::generate_random_01() * cells_per_coarse_cell), cells_per_coarse_cell - 1);
+                for (auto coarse_y = 0u; coarse_y < detection_grid_size; coarse_y++)
+                    for (auto coarse_x = 0u; coarse_x < detection_grid_size; coarse_x++)
+                        add_area_light_query(point, light, coarse_x * cells_per_coarse_cell + rays.sub_cell_x, coarse_y * cells_per_coarse_cell + rays.sub_cell_y);
+                context.shadow_ray_statistics.area_light_evaluations++;
+            }
+            rays.query_count = static_cast<unsigned int>(queries.size()) - rays.first_query;
+        }
+    }
+    if (!queries.empty())
+    {
+        trace_shadow_rays(context, queries.data(), static_cast<unsigned int>(queries.size()), true);
+        count_visible_rays();
+    }
+
+    // Penumbra pass: sample the remaining fine cells of the area lights whose detection rays disagree
+    queries.clear();
+    if (cells_per_coarse_cell > 1)
+    {
+        for (auto point_it = 0u; point_it < point_count; point_it++)
+        {
+            auto const& point = points[point_it];
+            for (auto light_it = point.first_light; light_it < point.first_light + point.light_count; light_it++)
+            {
+                auto const& light = *lights[light_it].light;
+                auto& rays = light_rays[light_it];
+                rays.first_query = static_cast<unsigned int>(queries.size());
+                if (!light.is_area_light() || rays.visible_count == 0 || rays.visible_count == rays.traced_count)
+                    continue;
+                for (auto cell_y = 0u; cell_y < penumbra_grid_size; cell_y++)
+                    for (auto cell_x = 0u; cell_x < penumbra_grid_size; cell_x++)
+                        if (cell_x % cells_per_coarse_cell != rays.sub_cell_x || cell_y % cells_per_coarse_cell != rays.sub_cell_y)
+                            add_area_light_query(point, light, cell_x, cell_y);
+                rays.query_count = static_cast<unsigned int>(queries.size()) - rays.first_query;
+                context.shadow_ray_statistics.refined_evaluations++;
+            }
+        }
+        if (!queries.empty())
+        {
+            trace_shadow_rays(context, queries.data(), static_cast<unsigned int>(queries.size()), true);
+            count_visible_rays();
+        }
+    }
+
+    for (auto light_it = 0u; light_it < light_count; light_it++)
+    {
+        auto const& rays = light_rays[light_it];
+        out_visibilities[light_it] = (rays.traced_count > 0) ? static_cast<float>(rays.visible_count) / rays.traced_count : 1.0f;
+    }
+}
+
+Vec3f const Renderer_Base::compute_color_from_ray(Trace_Context& context, geometry::Ray const& ray, float near_limit, float far_limit, float recursion_depth, Primary_Hit* out_hit,
+                                                  std::pair<Object const*, float> const* first_intersection) const
+{
+    auto const closest_intersection = (first_intersection != nullptr) ? *first_intersection : compute_closest_intersection_with_scene(ray, near_limit, far_limit);
     auto const* intersected_object = closest_intersection.first;
     if (intersected_object != nullptr)
     {
@@ -93,16 +1055,38 @@ Vec3f const Renderer_Base::compute_color_from_ray(geometry::Ray const& ray, floa
         auto const& ray_origin = ray.get_origin();
         auto const intersection_position = ray_origin + intersection_distance * ray_direction;
         auto const intersection_normal = object_primitive.compute_normal_from_position_on_primitive(intersection_position);
-        auto const intersection_uv = object_primitive.compute_uv_from_position_on_primitive(intersection_position);
-        auto const local_color = object_material.apply_lighting_in_point(m_scene.get_lights(), intersection_normal, m_draw_camera.get_position(), intersection_position, shadows_near_limit, intersection_uv);
+        // Constant materials do not depend on UV coordinates, so skip computing them
+        auto const intersection_uv = object_material.is_constant() ? Vec2f::zero() : object_primitive.compute_uv_from_position_on_primitive(intersection_position);
+        auto const surface = object_material.get_surface_parameters(intersection_uv);
+        if (out_hit != nullptr)
+            fill_primary_hit(*out_hit, intersected_object - m_scene.get_objects().data(), intersection_distance, intersection_position, intersection_normal, surface);
+        thread_local std::vector<Light_Sample> selected_lights;
+        m_scene.select_lights(intersection_position, selected_lights);
+        if (context.edit_footprint != nullptr)
+        {
+            context.edit_footprint->record_object(static_cast<std::size_t>(intersected_object - m_scene.get_objects().data()));
+            context.edit_footprint->record_shading_point(intersection_position, selected_lights, m_scene.get_lights().data());
+        }
+        thread_local std::vector<float> light_visibilities;
+        light_visibilities.resize(selected_lights.size());
+        compute_light_visibilities(context, intersection_position, shadows_near_limit, selected_lights.data(), static_cast<unsigned int>(selected_lights.size()), light_visibilities.data());
+        auto const& camera_position = (context.view_camera != nullptr) ? context.view_camera->get_position() : m_draw_camera.get_position();
+        auto const local_color = object_material.apply_lighting_in_point(selected_lights.data(), light_visibilities.data(), static_cast<unsigned int>(selected_lights.size()), intersection_normal,
+                                                                         camera_position, intersection_position, surface);
+        if (out_hit != nullptr)
+            out_hit->direct_lighting = local_color;
 
         // If the object is reflective and we have not yet reached the recursion limit, send another ray
-        // TODO : make this depend on the material's properties, as the reflective intensity is set arbitrarily for now
         if (recursion_depth > 0)
         {
-            auto const reflective_intensity = std::powf((1.0f - object_material.get_roughness(intersection_uv)), 5.0f);
+            auto const reflective_intensity = surface.reflective_intensity;
+            if (context.edit_footprint != nullptr && reflective_intensity > 0.0f)
+                context.edit_footprint->has_secondary_rays = true;
+            // Only the pixel's first hit shares its light visibilities with the other views
+            context.reused_shadows = nullptr;
+            context.recorded_shadows = nullptr;
             auto const& reflected_ray = geometry::Ray{intersection_position, -ray_direction}.reflect(intersection_normal);
-            auto const& reflected_color = compute_color_from_ray(reflected_ray, math::distance_epsilon(intersection_distance, 2.0f), far_limit, recursion_depth - 1);
+            auto const& reflected_color = compute_color_from_ray(context, reflected_ray, math::distance_epsilon(intersection_distance, 2.0f), far_limit, recursion_depth - 1);
             return (1.0f - reflective_intensity) * local_color + reflective_intensity * reflected_color;
         }
         else
@@ -112,50 +1096,972 @@ Vec3f const Renderer_Base::compute_color_from_ray(geometry::Ray const& ray, floa
     }
     else
     {
+        if (out_hit != nullptr)
+            *out_hit = Primary_Hit{Vec3f::zero(), Vec3f::one(), far_limit, -1, Vec3f::zero()};
         return m_background_color;
     }
 }
 
-Vec3f const Renderer_Base::compute_pixel_color(float u, float v) const
+Vec3f const Renderer_Base::compute_path_radiance(Trace_Context& context, geometry::Ray const& ray, float near_limit, float far_limit, Primary_Hit* out_hit,
+                                                  std::pair<Object const*, float> const* first_intersection) const
+{
+    auto constexpr russian_roulette_min_bounce_count = 3u;
+    auto radiance = Vec3f::zero();
+    auto throughput = Vec3f::one();
+    auto path_ray = ray;
+    auto path_near_limit = near_limit;
+    thread_local std::vector<Light_Sample> selected_lights;
+    thread_local std::vector<float> light_visibilities;
+    auto const bounce_count = get_path_bounce_count();
+    for (auto bounce_it = 0u; bounce_it < bounce_count; bounce_it++)
+    {
+        auto const closest_intersection =
+            (bounce_it == 0 && first_intersection != nullptr) ? *first_intersection : compute_closest_intersection_with_scene(path_ray, path_near_limit, far_limit);
+        auto const* intersected_object = closest_intersection.first;
+        if (intersected_object == nullptr)
+        {
+            if (bounce_it == 0 && out_hit != nullptr)
+                *out_hit = Primary_Hit{Vec3f::zero(), Vec3f::one(), far_limit, -1, Vec3f::zero()};
+            radiance += throughput * m_background_color;
+            break;
+        }
+
+        // Add the direct lighting of the hit point, lights being sampled explicitly since paths cannot hit them
+        auto const& object_material = intersected_object->get_material();
+        auto const& object_primitive = intersected_object->get_primitive();
+        auto const& intersection_distance = closest_intersection.second;
+        auto const& ray_direction = path_ray.get_direction();
+        auto const& ray_origin = path_ray.get_origin();
+        auto const intersection_position = ray_origin + intersection_distance * ray_direction;
+        auto intersection_normal = object_primitive.compute_normal_from_position_on_primitive(intersection_position);
+        if (intersection_normal.dot(ray_direction) > 0.0f)
+            intersection_normal = -intersection_normal;
+        auto const intersection_uv = object_material.is_constant() ? Vec2f::zero() : object_primitive.compute_uv_from_position_on_primitive(intersection_position);
+        m_scene.select_lights(intersection_position, selected_lights);
+        if (context.edit_footprint != nullptr)
+        {
+            context.edit_footprint->record_object(static_cast<std::size_t>(intersected_object - m_scene.get_objects().data()));
+            context.edit_footprint->record_shading_point(intersection_position, selected_lights, m_scene.get_lights().data());
+        }
+        auto const surface = object_material.get_surface_parameters(intersection_uv);
+        auto const shadows_near_limit = math::distance_epsilon(intersection_distance, 1.0f, 1e-2f);
+        light_visibilities.resize(selected_lights.size());
+        compute_light_visibilities(context, intersection_position, shadows_near_limit, selected_lights.data(), static_cast<unsigned int>(selected_lights.size()), light_visibilities.data());
+        auto const direct_lighting = object_material.apply_lighting_in_point(selected_lights.data(), light_visibilities.data(), static_cast<unsigned int>(selected_lights.size()), intersection_normal,
+                                                                             ray_origin, intersection_position, surface);
+        radiance += throughput * direct_lighting;
+
+        // Continue the path in a direction sampled from the BRDF
+        if (bounce_it == 0 && out_hit != nullptr)
+        {
+            fill_primary_hit(*out_hit, intersected_object - m_scene.get_objects().data(), intersection_distance, intersection_position, intersection_normal, surface);
+            out_hit->direct_lighting = direct_lighting;
+        }
+        BRDF_Input brdf_input;
+        brdf_input.albedo = surface.albedo;
+        brdf_input.roughness = surface.roughness;
+        brdf_input.metallic = surface.metallic;
+        brdf_input.base_reflectivity = surface.base_reflectivity;
+        auto bounce_direction = Unit_Vec3f::reference();
+        auto bounce_weight = Vec3f::zero();
+        auto const lobe_sample = math::generate_random_01();
+        auto const direction_sample = Vec2f{math::generate_random_01(), math::generate_random_01()};
+        if (!sample_brdf_cook_torrance(brdf_input, intersection_normal, -ray_direction, lobe_sample, direction_sample, bounce_direction, bounce_weight))
+            break;
+        throughput = throughput * bounce_weight;
+
+        // Terminate low-throughput paths with Russian roulette, reweighting the surviving ones to keep the estimate unbiased
+        if (bounce_it + 1 >= russian_roulette_min_bounce_count)
+        {
+            auto const max_throughput = (std::max)(throughput.x(), (std::max)(throughput.y(), throughput.z()));
+            auto const survival_probability = math::clamp(max_throughput, 0.05f, 0.95f);
+            if (math::generate_random_01() >= survival_probability)
+                break;
+            throughput = throughput / survival_probability;
+        }
+        if (context.edit_footprint != nullptr)
+            context.edit_footprint->has_secondary_rays = true;
+        path_ray = geometry::Ray{intersection_position, bounce_direction};
+        path_near_limit = math::distance_epsilon(intersection_distance, 2.0f);
+    }
+    return radiance;
+}
+
+Vec3f const Renderer_Base::compute_pixel_sample(Trace_Context& context, int column, int row, Primary_Hit* out_hit) const
+{
+    auto const ray = compute_camera_ray(column, row, true);
+    auto const first_intersection = compute_camera_ray_intersection(column, row, ray);
+    if (m_integrator_type == Integrator_Type::path_tracing)
+        return compute_path_radiance(context, ray, m_draw_camera.get_near(), m_draw_camera.get_far(), out_hit, &first_intersection);
+    return compute_color_from_ray(context, ray, m_draw_camera.get_near(), m_draw_camera.get_far(), get_whitted_recursion_depth(), out_hit, &first_intersection);
+}
+
+geometry::Ray Renderer_Base::compute_camera_ray(int column, int row, bool jittered) const
 {
-    auto const& near_limit = m_draw_camera.get_near();
-    auto const& far_limit = m_draw_camera.get_far();
     Vec3f const& ray_origin{m_draw_camera.get_position()};
-    Unit_Vec3f const& ray_direction = Vec3f{u, v, near_limit}.normalize();
-    geometry::Ray ray{ray_origin, ray_direction};
-    auto const recursion_max_depth = 1;
-    return compute_color_from_ray(ray, near_limit, far_limit, recursion_max_depth);
+    if (!jittered)
+        return geometry::Ray{ray_origin, m_camera_rays.get_direction(row * m_framebuffer_width + column)};
+    return geometry::Ray{ray_origin, compute_jittered_ray_direction(m_draw_camera, column, row, m_framebuffer_width, m_framebuffer_height)};
+}
+
+std::pair<Object const*, float> Renderer_Base::compute_primary_intersection(Trace_Context& context, int column, int row, geometry::Ray const& ray) const
+{
+    auto const near_limit = m_draw_camera.get_near();
+    auto const far_limit = m_draw_camera.get_far();
+    // Only trust the visibility buffer where the pixel and its neighbors see the same object, or all see the background,
+    // since tessellation and rasterization may move silhouettes and the edges between objects by up to a pixel
+    auto const* triangle_ids = m_visibility_rasterizer.get_triangle_ids();
+    auto const get_pixel_object = [this, triangle_ids](int i, int j) {
+        auto const triangle = triangle_ids[j * m_framebuffer_width + i];
+        return (triangle >= 0) ? m_visibility_rasterizer.get_object_index(triangle) : -1;
+    };
+    auto const object_index = get_pixel_object(column, row);
+    auto is_interior = true;
+    for (auto j = (std::max)(row - 1, 0); j <= (std::min)(row + 1, m_framebuffer_height - 1) && is_interior; j++)
+        for (auto i = (std::max)(column - 1, 0); i <= (std::min)(column + 1, m_framebuffer_width - 1) && is_interior; i++)
+            is_interior = (get_pixel_object(i, j) == object_index);
+    if (is_interior)
+    {
+        if (object_index < 0)
+        {
+            context.visibility_hit_count++;
+            return std::make_pair(nullptr, far_limit);
+        }
+        // Intersect the ray with the visible object only, which gives the exact same hit as tracing it through the whole scene
+        thread_local std::vector<float> intersections;
+        auto const& object = m_scene.get_objects()[object_index];
+        object.get_primitive().compute_intersection_with(ray, near_limit, far_limit, m_culling_type, intersections);
+        if (!intersections.empty())
+        {
+            context.visibility_hit_count++;
+            return std::make_pair(&object, intersections[0]);
+        }
+    }
+    return compute_camera_ray_intersection(column, row, ray);
+}
+
+std::pair<Object const*, float> Renderer_Base::compute_camera_ray_intersection(int column, int row, geometry::Ray const& ray) const
+{
+    auto const near_limit = m_draw_camera.get_near();
+    auto const far_limit = m_draw_camera.get_far();
+    if (!m_is_view_culling_current)
+        return compute_closest_intersection_with_scene(ray, near_limit, far_limit);
+    // Test the objects of the pixel's tile only
+    auto const tile_column_count = (m_framebuffer_width + view_culling_tile_size - 1) / view_culling_tile_size;
+    auto const tile = (row / view_culling_tile_size) * tile_column_count + column / view_culling_tile_size;
+    auto const first_object = m_view_tile_offsets[tile];
+    return compute_closest_intersection_with_objects(ray, near_limit, far_limit, m_view_tile_objects.data() + first_object, m_view_tile_offsets[tile + 1] - first_object);
+}
+
+Vec3f const Renderer_Base::compute_pixel_color(Trace_Context& context, int column, int row, Primary_Hit* out_hit) const
+{
+    if (m_integrator_type == Integrator_Type::path_tracing)
+    {
+        // Average several camera rays, jittered over the pixel's footprint
+        auto color = Vec3f::zero();
+        for (auto sample_it = 0u; sample_it < m_samples_per_pixel; sample_it++)
+            color += compute_pixel_sample(context, column, row, (sample_it == 0) ? out_hit : nullptr);
+        return color / static_cast<float>(m_samples_per_pixel);
+    }
+    auto const ray = compute_camera_ray(column, row, false);
+    auto const first_intersection = compute_camera_ray_intersection(column, row, ray);
+    return compute_color_from_ray(context, ray, m_draw_camera.get_near(), m_draw_camera.get_far(), get_whitted_recursion_depth(), out_hit, &first_intersection);
+}
+
+Vec3f const Renderer_Base::compute_view_pixel_color(Trace_Context& context, Render_View const& view, int column, int row, Primary_Hit* out_hit) const
+{
+    auto const& camera = view.camera;
+    auto const view_width = m_framebuffer_width / m_view_column_count;
+    auto const view_height = m_framebuffer_height / m_view_row_count;
+    if (m_integrator_type == Integrator_Type::path_tracing)
+    {
+        // Average several camera rays, jittered over the pixel's footprint
+        auto color = Vec3f::zero();
+        for (auto sample_it = 0u; sample_it < m_samples_per_pixel; sample_it++)
+        {
+            auto const ray = geometry::Ray{camera.get_position(), compute_jittered_ray_direction(camera, column, row, view_width, view_height)};
+            auto const first_intersection = compute_view_ray_intersection(view, column, row, ray);
+            color += compute_path_radiance(context, ray, camera.get_near(), camera.get_far(), (sample_it == 0) ? out_hit : nullptr, &first_intersection);
+        }
+        return color / static_cast<float>(m_samples_per_pixel);
+    }
+    auto const ray = geometry::Ray{camera.get_position(), view.camera_rays.get_direction(row * view_width + column)};
+    auto const first_intersection = compute_view_ray_intersection(view, column, row, ray);
+    return compute_color_from_ray(context, ray, camera.get_near(), camera.get_far(), get_whitted_recursion_depth(), out_hit, &first_intersection);
+}
+
+std::pair<Object const*, float> Renderer_Base::compute_view_ray_intersection(Render_View const& view, int column, int row, geometry::Ray const& ray) const
+{
+    auto const near_limit = view.camera.get_near();
+    auto const far_limit = view.camera.get_far();
+    if (view.tile_offsets.empty())
+        return compute_closest_intersection_with_scene(ray, near_limit, far_limit);
+    // Test the objects of the pixel's tile only
+    auto const view_width = m_framebuffer_width / m_view_column_count;
+    auto const tile_column_count = (view_width + view_culling_tile_size - 1) / view_culling_tile_size;
+    auto const tile = (row / view_culling_tile_size) * tile_column_count + column / view_culling_tile_size;
+    auto const first_object = view.tile_offsets[tile];
+    return compute_closest_intersection_with_objects(ray, near_limit, far_limit, view.tile_objects.data() + first_object, view.tile_offsets[tile + 1] - first_object);
 }
 
 void Renderer_Base::launch_pixel_loading_threads()
 {
-    // Get the number of CPU cores
-    auto const core_count = std::thread::hardware_concurrency();
-    // Launch one thread per core
-    for (auto it = 0u; it < core_count; it++)
-        m_loading_threads.push_back(std::thread(&Renderer_Base::compute_pixel_colors_for_next_row, this));
+    // Reset the frame's shadow ray counters, and write the visibility buffer if the frame reads it
+    m_shadow_ray_count = 0;
+    m_area_light_evaluations = 0;
+    m_refined_evaluations = 0;
+    m_reused_shadow_points = 0;
+    update_visibility_buffer();
+    // Multi-view frames are computed by a single thread, running a pass over the tiles of all views with its own group of threads
+    if (!m_views.empty())
+    {
+        m_loading_threads.push_back(std::thread(&Renderer_Base::compute_views_frame, this));
+        return;
+    }
+    m_camera_rays.update(m_draw_camera, m_framebuffer_width, m_framebuffer_height);
+    update_view_culling();
+    // With progressive rendering, a single thread runs the passes of successive frames on the worker pool
+    if (m_progressive_enabled)
+    {
+        m_loading_threads.push_back(std::thread(&Renderer_Base::compute_progressive_frames, this));
+        return;
+    }
+    // Otherwise, a single thread runs the frame's passes on the worker pool, then its post-processing
+    m_loading_threads.push_back(std::thread(&Renderer_Base::compute_frame, this));
+}
+
+void Renderer_Base::compute_frame()
+{
+    if (m_adaptive_base_sample_count > 0)
+        compute_adaptive_sampling_passes();
+    else
+        compute_pass();
+    if (!m_denoiser_enabled)
+        return;
+
+    // Denoise the framebuffer, then publish all of its pixels again
+    m_denoiser.apply(m_framebuffer, m_worker_pool);
+    publish_framebuffer_rows(0, m_framebuffer_height);
+}
+
+void Renderer_Base::publish_rectangle(int x, int y, int width, int height, std::array<float const*, 3> const& channels, int row_stride)
+{
+    if (!is_displaying_progress() || width <= 0 || height <= 0)
+        return;
+    // Copy the rectangle's values in a single block, so that the display can consume it without further locking
+    std::lock_guard<std::mutex> lock{m_thread_guard};
+    auto const first_value = m_published_colors.size();
+    for (auto const* channel : channels)
+        for (auto row_it = 0; row_it < height; row_it++)
+            m_published_colors.insert(m_published_colors.end(), channel + row_it * row_stride, channel + row_it * row_stride + width);
+    Pixel_Rectangle rectangle;
+    rectangle.x = x;
+    rectangle.y = y;
+    rectangle.width = width;
+    rectangle.height = height;
+    rectangle.first_value = first_value;
+    m_published_rectangles.push_back(rectangle);
+}
+
+void Renderer_Base::publish_framebuffer_rows(int first_row, int end_row)
+{
+    Framebuffer const& framebuffer = m_framebuffer;
+    auto const first_pixel = first_row * m_framebuffer_width;
+    publish_rectangle(0, first_row, m_framebuffer_width, end_row - first_row, {framebuffer.get_red() + first_pixel, framebuffer.get_green() + first_pixel, framebuffer.get_blue() + first_pixel}, m_framebuffer_width);
+}
+
+void Renderer_Base::compute_progressive_frames()
+{
+    auto constexpr coarsest_block_size = 4;
+    while (!m_stop_requested)
+    {
+        // Take the changes requested since the previous frame started, then apply them outside of the lock, no pass being in flight
+        unsigned int generation;
+        auto has_camera_changed = false;
+        auto has_resolution_changed = false;
+        auto width = m_framebuffer_width;
+        auto height = m_framebuffer_height;
+        auto has_target_frame_time_changed = false;
+        auto target_frame_time = m_target_frame_time;
+        std::vector<std::function<void(Scene&)>> scene_edits;
+        {
+            std::lock_guard<std::mutex> lock{m_pending_changes_guard};
+            has_camera_changed = m_has_pending_camera;
+            if (m_has_pending_camera)
+                m_draw_camera = m_pending_camera;
+            m_has_pending_camera = false;
+            has_resolution_changed = m_has_pending_resolution;
+            width = m_pending_width;
+            height = m_pending_height;
+            m_has_pending_resolution = false;
+            has_target_frame_time_changed = m_has_pending_target_frame_time;
+            target_frame_time = m_pending_target_frame_time;
+            m_has_pending_target_frame_time = false;
+            scene_edits.swap(m_pending_scene_edits);
+            generation = m_frame_generation;
+        }
+        for (auto const& edit : scene_edits)
+            edit(m_scene);
+        auto const scene_changes = m_scene.take_changes();
+        if (has_resolution_changed)
+        {
+            m_output_width = width;
+            m_output_height = height;
+            update_view_layout();
+        }
+        if (has_target_frame_time_changed)
+            apply_target_frame_time(target_frame_time);
+        // Render at the quality level chosen from the previous frames, at full quality when there is no target frame time
+        auto const previous_width = m_framebuffer_width;
+        auto const previous_height = m_framebuffer_height;
+        auto const previous_reflection_depth_limit = m_reflection_depth_limit;
+        apply_quality_level();
+        m_camera_rays.update(m_draw_camera, m_framebuffer_width, m_framebuffer_height);
+        update_view_culling();
+        auto const is_frame_current = [&]() { return m_frame_generation == generation && !m_stop_requested; };
+
+        // The cost of the frame's first image is measured once its passes reach the level's sample count, or extrapolated from the completed passes if the frame is cancelled before
+        auto const frame_start = std::chrono::steady_clock::now();
+        auto const first_image_work = static_cast<float>(get_quality_level().sample_count);
+        auto completed_work = 0.0f;      // Pixels sampled by the completed passes, in passes of one sample per pixel
+        auto completed_work_time = 0.0f; // Time at which the last pass was completed, in milliseconds since the frame started
+        auto is_first_image_measured = (m_target_frame_time <= 0.0f);
+        auto const run_pass = [&](float pass_work) {
+            compute_pass();
+            if (!is_frame_current())
+                return;
+            completed_work += pass_work;
+            completed_work_time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+            if (!is_first_image_measured && completed_work >= first_image_work)
+            {
+                update_quality_level(completed_work_time);
+                is_first_image_measured = true;
+            }
+        };
+
+        // When only the camera has moved, reuse the previous frame's colors wherever they can be reprojected, otherwise discard the history
+        auto reused_pixel_count = 0;
+        if (m_reprojection_enabled)
+        {
+            auto const is_reprojectable = has_camera_changed && scene_edits.empty() && m_framebuffer_width == previous_width && m_framebuffer_height == previous_height;
+            if (is_reprojectable)
+                reused_pixel_count = m_reprojection_cache.reproject(m_framebuffer, m_draw_camera, m_reprojection_max_reflective_intensity, m_reprojection_refresh_ratio);
+            else
+                m_reprojection_cache.resize(m_framebuffer_width, m_framebuffer_height);
+        }
+
+        // When only the scene was edited, keep the pixels of the tiles that the edits do not affect, and render the others again from scratch
+        auto is_incremental = false;
+        if (m_dirty_regions_enabled && m_are_footprints_complete)
+        {
+            is_incremental = !has_camera_changed && m_framebuffer_width == previous_width && m_framebuffer_height == previous_height && m_reflection_depth_limit == previous_reflection_depth_limit &&
+                             !scene_changes.is_global;
+            if (is_incremental)
+            {
+                m_edit_footprints.compute_dirty_tiles(m_scene, scene_changes, m_draw_camera, m_dirty_tiles);
+                m_edit_footprints.clear_tiles(m_dirty_tiles);
+                for (auto j = 0; j < m_framebuffer_height; j++)
+                    for (auto i = 0; i < m_framebuffer_width; i++)
+                        if (m_dirty_tiles[m_edit_footprints.get_tile_index(i, j)])
+                            m_framebuffer.reset_sample_statistics(j * m_framebuffer_width + i);
+            }
+        }
+
+        // Each pass brings the pixels it visits to its sample count, the pixels that already have it keeping their color
+        m_progressive_block_size = 1;
+        m_progressive_sample_count = 1;
+        if (reused_pixel_count > 0)
+        {
+            // Sample the pixels that could not be reprojected, so that every pixel has a sample
+            m_are_footprints_complete = false;
+            run_pass(1.0f);
+        }
+        else
+        {
+            if (!is_incremental)
+            {
+                m_framebuffer.reset_sample_statistics();
+                if (m_dirty_regions_enabled)
+                    m_edit_footprints.resize(m_framebuffer_width, m_framebuffer_height);
+                m_are_footprints_complete = m_dirty_regions_enabled;
+            }
+            // Sample one pixel per block, with blocks getting finer until every pixel has a sample, each pass skipping the pixels sampled by the previous one
+            for (auto block_size = coarsest_block_size; block_size >= 1 && is_frame_current(); block_size /= 2)
+            {
+                m_progressive_block_size = block_size;
+                auto const skipped_work = (block_size < coarsest_block_size) ? 1.0f / (4 * block_size * block_size) : 0.0f;
+                run_pass(1.0f / (block_size * block_size) - skipped_work);
+            }
+        }
+
+        // Then accumulate samples in every pixel
+        m_progressive_block_size = 1;
+        for (auto sample_it = 1u; sample_it < m_progressive_max_sample_count && is_frame_current(); sample_it++)
+        {
+            m_progressive_sample_count = sample_it + 1;
+            run_pass(1.0f);
+        }
+        if (!is_first_image_measured && completed_work > 0.0f)
+            update_quality_level(completed_work_time * first_image_work / completed_work);
+        if (!is_frame_current())
+            continue;
+        if (!is_interactive())
+            return;
+
+        // Wait for a change once the frame is complete
+        std::unique_lock<std::mutex> lock{m_pending_changes_guard};
+        m_pending_changes_condition.wait(lock, [&]() { return m_frame_generation != generation || m_stop_requested; });
+    }
+}
+
+void Renderer_Base::compute_progressive_rows()
+{
+    auto const block_size = m_progressive_block_size;
+    auto const sample_count = m_progressive_sample_count;
+    auto const generation = m_frame_generation.load();
+    thread_local std::array<std::vector<float>, 3> block_row_colors;
+    Trace_Context context;
+    // Keep looking for a next row of blocks to sample, until there are no more or the frame restarts, in which case return
+    while (true)
+    {
+        auto const j = (m_last_loaded_row++) * block_size;
+        if (j >= m_framebuffer_height || m_frame_generation != generation || m_stop_requested)
+            return;
+        auto const block_end_row = (std::min)(j + block_size, m_framebuffer_height);
+        auto const block_row_pixel_count = static_cast<std::size_t>(block_end_row - j) * m_framebuffer_width;
+        for (auto& channel : block_row_colors)
+            channel.resize(block_row_pixel_count);
+        for (auto i = 0; i < m_framebuffer_width; i += block_size)
+        {
+            // Blocks whose first pixel already has the pass's samples, i.e. sampled by the previous pass, reprojected or left intact by an edit, keep displaying their colors
+            auto const index = (j * m_framebuffer_width + i);
+            if (m_framebuffer.get_sample_count(index) >= sample_count)
+            {
+                copy_block(block_row_colors, m_framebuffer, i, j, block_size, block_end_row - j);
+                continue;
+            }
+            context.edit_footprint = m_are_footprints_complete ? &m_edit_footprints.get_footprint(i, j) : nullptr;
+            // The AOVs and the reprojection history are taken from the pixel's very first sample
+            auto const is_first_sample = (m_framebuffer.get_sample_count(index) == 0);
+            auto const store_aovs = is_first_sample && m_framebuffer.has_aovs();
+            auto const store_history = is_first_sample && m_reprojection_enabled;
+            Primary_Hit hit;
+            m_framebuffer.add_sample(index, compute_pixel_sample(context, i, j, (store_aovs || store_history) ? &hit : nullptr));
+            if (store_aovs)
+                m_framebuffer.set_aovs(index, hit);
+            if (store_history)
+                m_reprojection_cache.store(index, hit);
+            // Display the pixel's color over its whole block, until finer passes replace it
+            fill_block(block_row_colors, i, block_size, block_end_row - j, m_framebuffer_width, m_framebuffer.get_color(index));
+        }
+        publish_rectangle(0, j, m_framebuffer_width, block_end_row - j, {block_row_colors[0].data(), block_row_colors[1].data(), block_row_colors[2].data()}, m_framebuffer_width);
+        // Add the shadow rays counted by this thread for the row to the frame's counters
+        add_trace_statistics(context);
+    }
+}
+
+void Renderer_Base::compute_pass()
+{
+    m_last_loaded_row = 0;
+    m_worker_pool.run([this](unsigned int) { compute_pixel_colors_for_next_row(); });
+}
+
+void Renderer_Base::add_trace_statistics(Trace_Context& context)
+{
+    m_shadow_ray_count += context.shadow_ray_statistics.ray_count;
+    m_area_light_evaluations += context.shadow_ray_statistics.area_light_evaluations;
+    m_refined_evaluations += context.shadow_ray_statistics.refined_evaluations;
+    m_reused_shadow_points += context.shadow_ray_statistics.reused_point_count;
+    m_visibility_hit_count += context.visibility_hit_count;
+    context.shadow_ray_statistics = Shadow_Ray_Statistics{};
+    context.visibility_hit_count = 0;
+}
+
+void Renderer_Base::compute_adaptive_sampling_passes()
+{
+    auto const tile_count_x = (m_framebuffer_width + adaptive_sampling_tile_size - 1) / adaptive_sampling_tile_size;
+    auto const tile_count_y = (m_framebuffer_height + adaptive_sampling_tile_size - 1) / adaptive_sampling_tile_size;
+    m_framebuffer.reset_sample_statistics();
+    m_active_tiles.assign(static_cast<std::size_t>(tile_count_x) * tile_count_y, 1);
+    m_average_sample_count = 0.0f;
+    auto active_tile_sample_count = 0u;
+    std::vector<float> tile_errors(m_active_tiles.size());
+    while (true)
+    {
+        // Add a pass of samples to the pixels of the active tiles
+        compute_pass();
+        active_tile_sample_count += m_adaptive_base_sample_count;
+        if (active_tile_sample_count + m_adaptive_base_sample_count > m_adaptive_max_sample_count)
+            break;
+
+        // Keep the tiles in which some pixel is still too noisy, and measure the noise of the whole image
+        std::fill(tile_errors.begin(), tile_errors.end(), 0.0f);
+        auto total_error = 0.0;
+        for (auto j = 0; j < m_framebuffer_height; j++)
+        {
+            for (auto i = 0; i < m_framebuffer_width; i++)
+            {
+                auto const pixel_error = m_framebuffer.compute_relative_error(j * m_framebuffer_width + i);
+                auto& tile_error = tile_errors[(j / adaptive_sampling_tile_size) * tile_count_x + (i / adaptive_sampling_tile_size)];
+                tile_error = (std::max)(tile_error, pixel_error);
+                total_error += pixel_error;
+            }
+        }
+        auto active_tile_count = 0u;
+        for (auto tile_it = 0u; tile_it < m_active_tiles.size(); tile_it++)
+        {
+            m_active_tiles[tile_it] = (m_active_tiles[tile_it] != 0 && tile_errors[tile_it] > m_adaptive_error_threshold) ? 1 : 0;
+            active_tile_count += m_active_tiles[tile_it];
+        }
+        auto const average_error = total_error / (std::max)(m_framebuffer.get_pixel_count(), 1);
+        if (active_tile_count == 0 || (m_adaptive_noise_target > 0.0f && average_error <= m_adaptive_noise_target))
+            break;
+    }
+
+    // Measure the average sample count reached over the frame
+    auto total_sample_count = 0.0;
+    for (auto index = 0; index < m_framebuffer.get_pixel_count(); index++)
+        total_sample_count += m_framebuffer.get_sample_count(index);
+    m_average_sample_count = static_cast<float>(total_sample_count / (std::max)(m_framebuffer.get_pixel_count(), 1));
+}
+
+void Renderer_Base::compute_views_frame()
+{
+    // Update the data of the rendered views, each sharing the camera-space ray directions of the previous rendered view if they have the same intrinsics
+    auto const view_width = m_framebuffer_width / m_view_column_count;
+    auto const view_height = m_framebuffer_height / m_view_row_count;
+    auto const is_sharing_shadows = (m_integrator_type == Integrator_Type::whitted);
+    Camera_Ray_Table const* previous_camera_rays = nullptr;
+    for (auto& view : m_views)
+    {
+        if (view.copied_view >= 0)
+            continue;
+        view.camera_rays.update(view.camera, view_width, view_height, previous_camera_rays);
+        previous_camera_rays = &view.camera_rays;
+        view.tile_offsets.clear();
+        view.tile_objects.clear();
+        if (m_view_culling_enabled)
+            list_tile_objects(view.camera, view_width, view_height, view.tile_offsets, view.tile_objects);
+        if (is_sharing_shadows && view.is_recording_shadows)
+            view.shadows.reset(view.camera, view_width, view_height, m_scene.get_lights().size());
+    }
+
+    // Compute the tiles of all views on the worker threads
+    m_next_view_tile = 0;
+    m_worker_pool.run([this](unsigned int) { compute_view_tiles(); });
+
+    // Copy the views that have the same camera as an earlier view, then publish the whole frame
+    for (auto const& view : m_views)
+    {
+        if (view.copied_view < 0)
+            continue;
+        auto const& source_view = m_views[view.copied_view];
+        for (auto j = 0; j < view_height; j++)
+            for (auto i = 0; i < view_width; i++)
+                m_framebuffer.copy_pixel((source_view.first_row + j) * m_framebuffer_width + source_view.first_column + i, (view.first_row + j) * m_framebuffer_width + view.first_column + i);
+    }
+    publish_framebuffer_rows(0, m_framebuffer_height);
+}
+
+void Renderer_Base::compute_view_tiles()
+{
+    auto const view_width = m_framebuffer_width / m_view_column_count;
+    auto const view_height = m_framebuffer_height / m_view_row_count;
+    auto const tile_column_count = (view_width + view_culling_tile_size - 1) / view_culling_tile_size;
+    auto const tile_row_count = (view_height + view_culling_tile_size - 1) / view_culling_tile_size;
+    auto const view_tile_count = tile_column_count * tile_row_count;
+    auto const tile_count = view_tile_count * static_cast<int>(m_views.size());
+    auto const is_sharing_shadows = (m_integrator_type == Integrator_Type::whitted);
+    Framebuffer const& framebuffer = m_framebuffer;
+    Trace_Context context;
+    // Keep taking the next tile, until there are no more, in which case return
+    while (true)
+    {
+        auto const tile = m_next_view_tile++;
+        if (tile >= tile_count)
+            return;
+        auto& view = m_views[tile / view_tile_count];
+        if (view.copied_view >= 0)
+            continue;
+        auto const first_column = (tile % view_tile_count % tile_column_count) * view_culling_tile_size;
+        auto const first_row = (tile % view_tile_count / tile_column_count) * view_culling_tile_size;
+        auto const end_column = (std::min)(first_column + view_culling_tile_size, view_width);
+        auto const end_row = (std::min)(first_row + view_culling_tile_size, view_height);
+        auto const* const reused_shadows = (is_sharing_shadows && view.shadow_view >= 0) ? &m_views[view.shadow_view].shadows : nullptr;
+        auto* const recorded_shadows = (is_sharing_shadows && view.is_recording_shadows) ? &view.shadows : nullptr;
+        context.view_camera = &view.camera;
+        for (auto j = first_row; j < end_row; j++)
+        {
+            for (auto i = first_column; i < end_column; i++)
+            {
+                auto const index = (view.first_row + j) * m_framebuffer_width + view.first_column + i;
+                Primary_Hit hit;
+                auto* const out_hit = m_framebuffer.has_aovs() ? &hit : nullptr;
+                // Share the light visibilities of the pixel's first hit with the other views
+                context.reused_shadows = reused_shadows;
+                context.recorded_shadows = recorded_shadows;
+                context.recorded_pixel = j * view_width + i;
+                m_framebuffer.set_color(index, compute_view_pixel_color(context, view, i, j, out_hit));
+                if (m_framebuffer.has_aovs())
+                    m_framebuffer.set_aovs(index, hit);
+            }
+        }
+        // Publish the completed tile for display
+        auto const first_pixel = (view.first_row + first_row) * m_framebuffer_width + view.first_column + first_column;
+        publish_rectangle(view.first_column + first_column, view.first_row + first_row, end_column - first_column, end_row - first_row,
+                          {framebuffer.get_red() + first_pixel, framebuffer.get_green() + first_pixel, framebuffer.get_blue() + first_pixel}, m_framebuffer_width);
+        // Add the shadow rays counted by this thread for the tile to the frame's counters
+        add_trace_statistics(context);
+    }
 }
 
 void Renderer_Base::compute_pixel_colors_for_next_row()
 {
+    // Progressive passes sample blocks of pixels instead
+    if (m_progressive_enabled)
+    {
+        compute_progressive_rows();
+        return;
+    }
+    // The wavefront pipeline processes tiles of rows instead (adaptive sampling passes still computing each pixel on its own)
+    if (m_wavefront_enabled && m_adaptive_base_sample_count == 0)
+    {
+        compute_wavefront_tiles();
+        return;
+    }
+    Trace_Context context;
     // Keep looking for a next row of pixels to compute, until there are no more, in which case return
     while (true)
     {
         // Get the index of the next unhandled row, and return if it is beyond the framebuffer height
         auto j = m_last_loaded_row++;
-        if (j > m_framebuffer_height)
+        if (j >= m_framebuffer_height)
             return;
-        // Compute values for each pixel in the row, and store them in the member storage variable
-        for (auto i = 0; i < m_framebuffer_width; i++)
+        // With adaptive sampling, add a pass of samples to the pixels of the row that belong to active tiles
+        if (m_adaptive_base_sample_count > 0)
         {
-            auto const index = (j * m_framebuffer_width + i);
-            auto const u = (i * 1.0f / (m_framebuffer_width - 1)) - 0.5f;
-            auto const v = (j * 1.0f / (m_framebuffer_height - 1)) - 0.5f;
-            auto const pixel_color = compute_pixel_color(u, v);
-            // Move the computed pixel values into the member storage variable in a thread-safe way
-            m_thread_guard.lock();
-            m_loaded_pixels.insert(std::make_pair(index, pixel_color));
-            m_thread_guard.unlock();
+            auto const tile_count_x = (m_framebuffer_width + adaptive_sampling_tile_size - 1) / adaptive_sampling_tile_size;
+            auto const* row_tiles = m_active_tiles.data() + (j / adaptive_sampling_tile_size) * tile_count_x;
+            for (auto i = 0; i < m_framebuffer_width; i++)
+            {
+                if (row_tiles[i / adaptive_sampling_tile_size] == 0)
+                    continue;
+                auto const index = (j * m_framebuffer_width + i);
+                // The AOVs are taken from the pixel's very first sample
+                auto const store_aovs = m_framebuffer.has_aovs() && m_framebuffer.get_sample_count(index) == 0;
+                Primary_Hit hit;
+                for (auto sample_it = 0u; sample_it < m_adaptive_base_sample_count; sample_it++)
+                    m_framebuffer.add_sample(index, compute_pixel_sample(context, i, j, (store_aovs && sample_it == 0) ? &hit : nullptr));
+                if (store_aovs)
+                    m_framebuffer.set_aovs(index, hit);
+            }
+        }
+        // Otherwise, compute values for each pixel in the row, and store them in the framebuffer, Whitted rows being shaded together
+        else if (m_integrator_type == Integrator_Type::whitted)
+        {
+            compute_whitted_row(context, j);
+        }
+        else
+        {
+            for (auto i = 0; i < m_framebuffer_width; i++)
+            {
+                auto const index = (j * m_framebuffer_width + i);
+                Primary_Hit hit;
+                auto* const out_hit = m_framebuffer.has_aovs() ? &hit : nullptr;
+                // Each pixel is written by a single thread, so the framebuffer can be written without locking
+                m_framebuffer.set_color(index, compute_pixel_color(context, i, j, out_hit));
+                if (m_framebuffer.has_aovs())
+                    m_framebuffer.set_aovs(index, hit);
+            }
+        }
+        // Publish the completed row for display, replacing the previous pass's values
+        publish_framebuffer_rows(j, j + 1);
+        // Add the shadow rays counted by this thread for the row to the frame's counters
+        add_trace_statistics(context);
+    }
+}
+
+void Renderer_Base::compute_whitted_row(Trace_Context& context, int row)
+{
+    auto const far_limit = m_draw_camera.get_far();
+    auto const recursion_depth = get_whitted_recursion_depth();
+    auto const& camera_position = m_draw_camera.get_position();
+    auto const& objects = m_scene.get_objects();
+    thread_local std::vector<geometry::Ray> camera_rays;
+    thread_local std::vector<std::pair<Object const*, float>> intersections;
+    thread_local std::vector<Wavefront_Hit> hits;
+    thread_local std::vector<Light_Sample> selected_lights;
+    thread_local std::vector<float> light_visibilities;
+    thread_local Lighting_Batch lighting_batch;
+    camera_rays.clear();
+    intersections.clear();
+    hits.clear();
+
+    // Add the first hits of the row to a shared lighting batch, whose lanes are filled with the lights of several points, the camera rays going through the pixels' centers
+    lighting_batch.clear();
+    for (auto i = 0; i < m_framebuffer_width; i++)
+    {
+        camera_rays.push_back(compute_camera_ray(i, row, false));
+        auto const& ray = camera_rays.back();
+        intersections.push_back(m_is_visibility_buffer_current ? compute_primary_intersection(context, i, row, ray) : compute_camera_ray_intersection(i, row, ray));
+        auto const* intersected_object = intersections.back().first;
+        if (intersected_object == nullptr)
+            continue;
+        auto const& object_material = intersected_object->get_material();
+        auto const& object_primitive = intersected_object->get_primitive();
+        auto const intersection_distance = intersections.back().second;
+        auto const intersection_position = ray.get_origin() + intersection_distance * ray.get_direction();
+        auto const intersection_normal = object_primitive.compute_normal_from_position_on_primitive(intersection_position);
+        // Constant materials do not depend on UV coordinates, so skip computing them
+        auto const intersection_uv = object_material.is_constant() ? Vec2f::zero() : object_primitive.compute_uv_from_position_on_primitive(intersection_position);
+        hits.push_back(Wavefront_Hit{intersection_position, intersection_normal, object_material.get_surface_parameters(intersection_uv)});
+        auto const& hit = hits.back();
+        m_scene.select_lights(intersection_position, selected_lights);
+        light_visibilities.resize(selected_lights.size());
+        compute_light_visibilities(context, intersection_position, math::distance_epsilon(intersection_distance, 1.0f, 1e-2f), selected_lights.data(), static_cast<unsigned int>(selected_lights.size()),
+                                   light_visibilities.data());
+        lighting_batch.add_point(selected_lights.data(), light_visibilities.data(), static_cast<unsigned int>(selected_lights.size()), hit.normal, camera_position, hit.position, hit.surface);
+    }
+    lighting_batch.flush();
+
+    // Mix the local color of each first hit with its mirror reflection, until reaching the recursion limit
+    // Each pixel is written by a single thread, so the framebuffer can be written without locking
+    auto point_index = 0u;
+    for (auto i = 0; i < m_framebuffer_width; i++)
+    {
+        auto const index = (row * m_framebuffer_width + i);
+        auto const* intersected_object = intersections[i].first;
+        if (intersected_object == nullptr)
+        {
+            m_framebuffer.set_color(index, m_background_color);
+            if (m_framebuffer.has_aovs())
+                m_framebuffer.set_aovs(index, Primary_Hit{Vec3f::zero(), Vec3f::one(), far_limit, -1, Vec3f::zero()});
+            continue;
+        }
+        auto const& hit = hits[point_index];
+        auto const intersection_distance = intersections[i].second;
+        auto const local_color = lighting_batch.get_color(point_index++);
+        if (m_framebuffer.has_aovs())
+        {
+            Primary_Hit primary_hit;
+            fill_primary_hit(primary_hit, intersected_object - objects.data(), intersection_distance, hit.position, hit.normal, hit.surface);
+            primary_hit.direct_lighting = local_color;
+            m_framebuffer.set_aovs(index, primary_hit);
+        }
+        if (recursion_depth <= 0)
+        {
+            m_framebuffer.set_color(index, local_color);
+            continue;
+        }
+        auto const reflective_intensity = hit.surface.reflective_intensity;
+        auto const& reflected_ray = geometry::Ray{hit.position, -camera_rays[i].get_direction()}.reflect(hit.normal);
+        auto const& reflected_color = compute_color_from_ray(context, reflected_ray, math::distance_epsilon(intersection_distance, 2.0f), far_limit, recursion_depth - 1);
+        m_framebuffer.set_color(index, (1.0f - reflective_intensity) * local_color + reflective_intensity * reflected_color);
+    }
+}
+
+void Renderer_Base::compute_wavefront_tiles()
+{
+    auto const near_limit = m_draw_camera.get_near();
+    auto const far_limit = m_draw_camera.get_far();
+    auto const is_path_tracing = (m_integrator_type == Integrator_Type::path_tracing);
+    auto const sample_count = is_path_tracing ? m_samples_per_pixel : 1u;
+    thread_local Ray_Queue queue;
+    thread_local Ray_Queue next_queue;
+    std::array<std::vector<float>, 3> tile_colors;
+    Trace_Context context;
+    // Keep taking the next tile of rows, until there are no more, in which case return
+    while (true)
+    {
+        auto const first_row = m_last_loaded_row.fetch_add(m_wavefront_tile_row_count);
+        if (first_row >= m_framebuffer_height)
+            return;
+        auto const end_row = (std::min)(first_row + m_wavefront_tile_row_count, m_framebuffer_height);
+        auto const first_pixel = first_row * m_framebuffer_width;
+        auto const tile_pixel_count = static_cast<std::size_t>(end_row - first_row) * m_framebuffer_width;
+        for (auto& channel : tile_colors)
+            channel.assign(tile_pixel_count, 0.0f);
+
+        // Ray generation phase: queue the camera rays of the tile, the AOVs of each pixel being taken from its first sample
+        queue.clear();
+        for (auto j = first_row; j < end_row; j++)
+        {
+            for (auto i = 0; i < m_framebuffer_width; i++)
+            {
+                for (auto sample_it = 0u; sample_it < sample_count; sample_it++)
+                    queue.push(compute_camera_ray(i, j, is_path_tracing), near_limit, far_limit, Vec3f::one(), j * m_framebuffer_width + i, 0, m_framebuffer.has_aovs() && sample_it == 0);
+            }
+        }
+
+        // Process the rays one bounce at a time, until no path continues
+        while (queue.size() > 0)
+        {
+            queue.sort_keys.resize(queue.size());
+            for (auto ray_it = 0u; ray_it < queue.size(); ray_it++)
+                queue.sort_keys[ray_it] = queue.compute_direction_octant(ray_it);
+            queue.sort_by_key(8);
+            trace_closest_hits(queue);
+            next_queue.clear();
+            shade_hits(context, queue, first_pixel, tile_colors, next_queue);
+            std::swap(queue, next_queue);
+        }
+
+        // Store the tile's colors, each pixel belonging to this thread only, then publish the tile for display
+        for (auto pixel_it = 0u; pixel_it < tile_pixel_count; pixel_it++)
+        {
+            auto const pixel_color = Vec3f{tile_colors[0][pixel_it], tile_colors[1][pixel_it], tile_colors[2][pixel_it]} / static_cast<float>(sample_count);
+            m_framebuffer.set_color(first_pixel + static_cast<int>(pixel_it), pixel_color);
+        }
+        publish_framebuffer_rows(first_row, end_row);
+        // Add the shadow rays counted by this thread for the tile to the frame's counters
+        add_trace_statistics(context);
+    }
+}
+
+void Renderer_Base::trace_closest_hits(Ray_Queue& queue) const
+{
+    auto const count = queue.size();
+    queue.hit_objects.resize(count);
+    queue.hit_distances.resize(count);
+    compute_closest_intersections_with_scene(queue.rays.data(), queue.near_limits.data(), queue.far_limits.data(), count, queue.hit_objects.data(), queue.hit_distances.data());
+}
+
+void Renderer_Base::shade_hits(Trace_Context& context, Ray_Queue& queue, int first_pixel, std::array<std::vector<float>, 3>& tile_colors, Ray_Queue& out_next_queue)
+{
+    auto constexpr russian_roulette_min_bounce_count = 3u;
+    auto const& objects = m_scene.get_objects();
+    auto const is_path_tracing = (m_integrator_type == Integrator_Type::path_tracing);
+    auto const count = queue.size();
+    auto const add_radiance = [&](unsigned int ray_it, Vec3f const& radiance) {
+        auto const pixel_it = queue.pixel_indices[ray_it] - first_pixel;
+        tile_colors[0][pixel_it] += queue.throughputs_r[ray_it] * radiance.x();
+        tile_colors[1][pixel_it] += queue.throughputs_g[ray_it] * radiance.y();
+        tile_colors[2][pixel_it] += queue.throughputs_b[ray_it] * radiance.z();
+    };
+
+    // Bin the rays by intersected object, and thus by material, then by direction octant, misses coming first
+    queue.sort_keys.resize(count);
+    for (auto ray_it = 0u; ray_it < count; ray_it++)
+    {
+        auto const* hit_object = queue.hit_objects[ray_it];
+        auto const object_key = (hit_object != nullptr) ? static_cast<unsigned int>(hit_object - objects.data()) + 1 : 0u;
+        queue.sort_keys[ray_it] = object_key * 8 + queue.compute_direction_octant(ray_it);
+    }
+    queue.sort_by_key((static_cast<unsigned int>(objects.size()) + 1) * 8);
+
+    // Rays that hit nothing return the background color
+    auto first_hit = 0u;
+    while (first_hit < count && queue.hit_objects[first_hit] == nullptr)
+    {
+        add_radiance(first_hit, m_background_color);
+        if (queue.stores_aovs[first_hit] != 0)
+            m_framebuffer.set_aovs(queue.pixel_indices[first_hit], Primary_Hit{Vec3f::zero(), Vec3f::one(), queue.far_limits[first_hit], -1, Vec3f::zero()});
+        first_hit++;
+    }
+
+    // Surface phase: compute the hit points and select their lights
+    thread_local std::vector<Wavefront_Hit> hits;
+    thread_local std::vector<Shadow_Point> shadow_points;
+    thread_local std::vector<Light_Sample> point_lights;
+    thread_local std::vector<Light_Sample> lights;
+    thread_local std::vector<float> light_visibilities;
+    hits.clear();
+    shadow_points.clear();
+    lights.clear();
+    for (auto ray_it = first_hit; ray_it < count; ray_it++)
+    {
+        auto const& object_material = queue.hit_objects[ray_it]->get_material();
+        auto const& object_primitive = queue.hit_objects[ray_it]->get_primitive();
+        auto const& ray_direction = queue.rays[ray_it].get_direction();
+        auto const intersection_position = queue.rays[ray_it].get_origin() + queue.hit_distances[ray_it] * ray_direction;
+        auto intersection_normal = object_primitive.compute_normal_from_position_on_primitive(intersection_position);
+        if (is_path_tracing && intersection_normal.dot(ray_direction) > 0.0f)
+            intersection_normal = -intersection_normal;
+        auto const intersection_uv = object_material.is_constant() ? Vec2f::zero() : object_primitive.compute_uv_from_position_on_primitive(intersection_position);
+        hits.push_back(Wavefront_Hit{intersection_position, intersection_normal, object_material.get_surface_parameters(intersection_uv)});
+        m_scene.select_lights(intersection_position, point_lights);
+        Shadow_Point point;
+        point.position = intersection_position;
+        point.near_limit = math::distance_epsilon(queue.hit_distances[ray_it], 1.0f, 1e-2f);
+        point.first_light = static_cast<unsigned int>(lights.size());
+        point.light_count = static_cast<unsigned int>(point_lights.size());
+        shadow_points.push_back(point);
+        lights.insert(lights.end(), point_lights.begin(), point_lights.end());
+    }
+
+    // Shadow phase: trace the shadow rays of all hits in shared batches
+    light_visibilities.resize(lights.size());
+    if (!shadow_points.empty())
+        compute_light_visibilities(context, shadow_points.data(), static_cast<unsigned int>(shadow_points.size()), lights.data(), light_visibilities.data());
+
+    // Shading phase: apply the lights to all hits, whose lights fill the lanes of shared BRDF batches, then continue the path of each hit if needed
+    thread_local Lighting_Batch lighting_batch;
+    lighting_batch.clear();
+    for (auto ray_it = first_hit; ray_it < count; ray_it++)
+    {
+        auto const& hit = hits[ray_it - first_hit];
+        auto const& point = shadow_points[ray_it - first_hit];
+        // The Whitted integrator shades every point as seen from the camera, while paths are shaded as seen from the previous vertex
+        auto const& view_position = is_path_tracing ? queue.rays[ray_it].get_origin() : m_draw_camera.get_position();
+        lighting_batch.add_point(lights.data() + point.first_light, light_visibilities.data() + point.first_light, point.light_count, hit.normal, view_position, hit.position, hit.surface);
+    }
+    lighting_batch.flush();
+    for (auto ray_it = first_hit; ray_it < count; ray_it++)
+    {
+        auto const& hit = hits[ray_it - first_hit];
+        auto const* hit_object = queue.hit_objects[ray_it];
+        auto const& ray = queue.rays[ray_it];
+        auto const hit_distance = queue.hit_distances[ray_it];
+        auto const bounce_count = queue.bounce_counts[ray_it];
+        auto const throughput = Vec3f{queue.throughputs_r[ray_it], queue.throughputs_g[ray_it], queue.throughputs_b[ray_it]};
+        auto const direct_lighting = lighting_batch.get_color(ray_it - first_hit);
+        if (queue.stores_aovs[ray_it] != 0)
+        {
+            Primary_Hit primary_hit;
+            fill_primary_hit(primary_hit, hit_object - objects.data(), hit_distance, hit.position, hit.normal, hit.surface);
+            primary_hit.direct_lighting = direct_lighting;
+            m_framebuffer.set_aovs(queue.pixel_indices[ray_it], primary_hit);
+        }
+
+        if (!is_path_tracing)
+        {
+            // Mix the local color with the mirror reflection, until reaching the recursion limit
+            if (bounce_count >= static_cast<unsigned int>(get_whitted_recursion_depth()))
+            {
+                add_radiance(ray_it, direct_lighting);
+                continue;
+            }
+            auto const reflective_intensity = hit.surface.reflective_intensity;
+            add_radiance(ray_it, (1.0f - reflective_intensity) * direct_lighting);
+            auto const reflected_ray = geometry::Ray{hit.position, -ray.get_direction()}.reflect(hit.normal);
+            out_next_queue.push(reflected_ray, math::distance_epsilon(hit_distance, 2.0f), queue.far_limits[ray_it], throughput * reflective_intensity, queue.pixel_indices[ray_it], bounce_count + 1, false);
+            continue;
+        }
+
+        // Add the direct lighting, then continue the path in a direction sampled from the BRDF, terminating it with Russian roulette as in compute_path_radiance
+        add_radiance(ray_it, direct_lighting);
+        if (bounce_count + 1 >= get_path_bounce_count())
+            continue;
+        BRDF_Input brdf_input;
+        brdf_input.albedo = hit.surface.albedo;
+        brdf_input.roughness = hit.surface.roughness;
+        brdf_input.metallic = hit.surface.metallic;
+        brdf_input.base_reflectivity = hit.surface.base_reflectivity;
+        auto bounce_direction = Unit_Vec3f::reference();
+        auto bounce_weight = Vec3f::zero();
+        auto const lobe_sample = math::generate_random_01();
+        auto const direction_sample = Vec2f{math::generate_random_01(), math::generate_random_01()};
+        if (!sample_brdf_cook_torrance(brdf_input, hit.normal, -ray.get_direction(), lobe_sample, direction_sample, bounce_direction, bounce_weight))
+            continue;
+        auto next_throughput = throughput * bounce_weight;
+        if (bounce_count + 1 >= russian_roulette_min_bounce_count)
+        {
+            auto const max_throughput = (std::max)(next_throughput.x(), (std::max)(next_throughput.y(), next_throughput.z()));
+            auto const survival_probability = math::clamp(max_throughput, 0.05f, 0.95f);
+            if (math::generate_random_01() >= survival_probability)
+                continue;
+            next_throughput = next_throughput / survival_probability;
         }
+        out_next_queue.push(geometry::Ray{hit.position, bounce_direction}, math::distance_epsilon(hit_distance, 2.0f), queue.far_limits[ray_it], next_throughput, queue.pixel_indices[ray_it], bounce_count + 1, false);
     }
 }
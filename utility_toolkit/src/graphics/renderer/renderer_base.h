@@ -5,17 +5,148 @@
 #include <graphics/culling.h>
 #include <graphics/light.h>
 #include <graphics/object.h>
+#include <graphics/renderer/camera_ray_table.h>
+#include <graphics/renderer/denoiser.h>
+#include <graphics/renderer/display_transform.h>
+#include <graphics/renderer/edit_footprints.h>
+#include <graphics/renderer/framebuffer.h>
+#include <graphics/renderer/rasterizer.h>
+#include <graphics/renderer/ray_queue.h>
+#include <graphics/renderer/reprojection_cache.h>
+#include <graphics/renderer/view_shadow_cache.h>
+#include <graphics/renderer/worker_pool.h>
 #include <graphics/scene.h>
 #include <math/vec.h>
 
 #include <dll_defines.h>
 
+#include <array>
 #include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <mutex>
 #include <thread>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
+/**
+ * @brief Algorithms used to compute the color seen along a camera ray.
+ */
+enum class DECLSPECIFIER Integrator_Type
+{
+    whitted,     // Direct lighting plus a single mirror reflection, with one ray per pixel (fast preview)
+    path_tracing // Iterative path tracing with next-event estimation and Russian roulette, with several jittered samples per pixel
+};
+
+/**
+ * @brief Arrangements of the views of a multi-view frame in the framebuffer.
+ */
+enum class DECLSPECIFIER View_Layout
+{
+    side_by_side, // All views in a single row, from left to right (e.g. the left and right eyes of a stereo pair)
+    cube_map      // Rows of three views, from the top left (e.g. the +X, -X and +Y faces of a cube map above its -Y, +Z and -Z faces)
+};
+
+/**
+ * @brief Shadow ray traced as part of a batch, along with its result.
+ */
+struct Shadow_Query
+{
+    Vec3f origin = Vec3f::zero();                   // Origin of the shadow ray, on the shaded surface
+    Unit_Vec3f direction = Unit_Vec3f::reference(); // Direction of the shadow ray, towards the light
+    float near_limit = 0.0f;                        // Near intersection distance, at which to start looking for occluders
+    float far_limit = 0.0f;                         // Far intersection distance (usually the distance to the light), at which to stop looking for occluders
+    Light const* light = nullptr;                   // Light towards which the ray is cast, used to look up the last occluder found for it
+    Object const* occluder = nullptr;               // Output occluder, or nullptr if the light is visible
+};
+
+/**
+ * @brief Surface point whose lights' visibilities are computed as part of a batch of points, along with the range of its lights in the batch's list of lights.
+ */
+struct Shadow_Point
+{
+    Vec3f position = Vec3f::zero(); // Position of the point from which the lights are seen
+    float near_limit = 0.0f;        // Near intersection distance, at which to start looking for occluders
+    unsigned int first_light = 0;   // Index of the point's first light in the batch's list of lights
+    unsigned int light_count = 0;   // Number of lights of the point
+};
+
+/**
+ * @brief Rectangle of pixels published for display by the render threads, whose linear colors are stored in a shared array of published colors.
+ */
+struct Pixel_Rectangle
+{
+    int x = 0;                   // Column of the rectangle's first pixel
+    int y = 0;                   // Row of the rectangle's first pixel
+    int width = 0;               // Number of columns of the rectangle
+    int height = 0;              // Number of rows of the rectangle
+    std::size_t first_value = 0; // Index in the published colors of the rectangle's first red value, followed by its planar red, green and blue values
+};
+
+/**
+ * @brief Quality at which dynamic resolution scaling renders the first image of each progressive frame.
+ */
+struct Quality_Level
+{
+    float resolution_scale = 1.0f;     // Ratio of the framebuffer's size to the output size, the image being upscaled by the display
+    unsigned int sample_count = 1;     // Number of samples per pixel of the first image, whose cost is measured
+    unsigned int reflection_depth = 0; // Maximum number of reflections or bounces after the camera hit, the integrators' own limits applying if lower
+};
+
+/**
+ * @brief Snapshot of the shadow ray counters, accumulated over the current frame.
+ */
+struct Shadow_Ray_Statistics
+{
+    std::uint64_t ray_count = 0;              // Number of shadow rays traced
+    std::uint64_t area_light_evaluations = 0; // Number of times the visibility of an area light was estimated
+    std::uint64_t refined_evaluations = 0;    // Number of area light visibility estimations that detected a penumbra and cast additional rays
+    std::uint64_t reused_point_count = 0;     // Number of hit points whose light visibilities were reused from another view's hits instead of being computed
+};
+
+/**
+ * @brief Throughputs of closest-hit traversal measured by Renderer_Base::benchmark_traversal, in millions of ray-object tests per second.
+ */
+struct Traversal_Benchmark
+{
+    float single_ray_throughput = 0.0f; // Throughput when tracing the rays one after the other
+    float grouped_throughput = 0.0f;    // Throughput when tracing the rays in interleaved groups
+    bool are_hits_identical = false;    // Whether both traversals found the same closest hits
+};
+
+/**
+ * @brief View of a multi-view frame, along with the data that its pixels share.
+ */
+struct Render_View
+{
+    Camera camera;                           // Camera rendering the view
+    int first_column = 0;                    // Column of the view's first pixel in the framebuffer
+    int first_row = 0;                       // Row of the view's first pixel in the framebuffer
+    int copied_view = -1;                    // Index of an earlier view with the same camera, whose pixels are copied instead of rendering the view, or -1 if none
+    int shadow_view = -1;                    // Index of an earlier view looking the same way, whose first hits' light visibilities the view's first hits reuse, or -1 if none
+    bool is_recording_shadows = false;       // Whether a later view reuses the light visibilities of the view's first hits
+    Camera_Ray_Table camera_rays;            // Directions of the view's camera rays
+    std::vector<std::size_t> tile_offsets;   // Index of the first object of each tile of the view in the list of the tiles' objects, followed by the size of the list
+    std::vector<std::uint32_t> tile_objects; // Indices of the objects overlapping each tile of the view, tile after tile
+    View_Shadow_Cache shadows;               // Light visibilities of the view's first hits, if a later view reuses them
+};
+
+/**
+ * @brief State of the pixel that a thread computes, passed down the calls tracing and shading its rays, along with the counters that the thread adds to the frame's counters.
+ */
+struct Trace_Context
+{
+    Shadow_Ray_Statistics shadow_ray_statistics;       // Shadow ray counters, added to the frame's counters after each row or tile
+    std::uint64_t visibility_hit_count = 0;            // Camera rays whose first hit was read from the visibility buffer, added to the frame's counter after each row
+    Edit_Footprint* edit_footprint = nullptr;          // Footprint in which to record the objects and lights contributing to the pixel, or nullptr if none
+    Camera const* view_camera = nullptr;               // Camera of the view to which the pixel belongs in a multi-view frame, or nullptr for the draw camera
+    View_Shadow_Cache const* reused_shadows = nullptr; // Cache from which the pixel's first hit reads its light visibilities, or nullptr if none
+    View_Shadow_Cache* recorded_shadows = nullptr;     // Cache in which the pixel's first hit records its light visibilities, or nullptr if none
+    int recorded_pixel = 0;                            // Index in its view of the pixel whose first hit's light visibilities are recorded
+};
+
 class Renderer_Base
 {
   public:
@@ -42,6 +173,194 @@ class Renderer_Base
      */
     DECLSPECIFIER virtual void release();
 
+    /**
+     * @brief Selects the tone curve used by the display transform applied to the framebuffer.
+     * @param[in] tone_curve. The tone curve to use.
+     */
+    DECLSPECIFIER void set_tone_curve(Tone_Curve tone_curve);
+
+    /**
+     * @brief Selects the strategy used to choose the lights evaluated in each surface point.
+     * @param[in] mode. Selection strategy (all lights, lights culled below a radiance threshold, or a few lights sampled stochastically).
+     * @param[in] radiance_threshold. Radiance below which a light's contribution is considered negligible (used by the culled mode).
+     * @param[in] sample_count. Number of lights to sample in each point (used by the stochastic mode).
+     */
+    DECLSPECIFIER void set_light_selection(Light_Selection_Mode mode, float radiance_threshold = 0.0f, unsigned int sample_count = 1);
+
+    /**
+     * @brief Selects the integrator used to compute pixel colors.
+     * @param[in] integrator_type. The integrator to use.
+     * @param[in] samples_per_pixel. Number of jittered camera rays averaged in each pixel (used by the path tracing integrator).
+     * @param[in] max_bounce_count. Maximum number of bounces of a path, beyond which it is terminated even if Russian roulette kept it alive (used by the path tracing integrator).
+     */
+    DECLSPECIFIER void set_integrator(Integrator_Type integrator_type, unsigned int samples_per_pixel = 1, unsigned int max_bounce_count = 8);
+
+    /**
+     * @brief Enables adaptive sampling, which replaces the fixed number of samples per pixel with passes of jittered samples restricted to noisy tiles.
+     * After a base pass, each pass adds the same number of samples to the pixels of the tiles where the 95% confidence interval of some pixel's mean luminance,
+     * relative to that mean, exceeds the error threshold. Passes stop when no tile is noisy anymore, when the maximum sample count is reached, or when the average relative error of the image falls below the noise target.
+     * @param[in] base_sample_count. Number of samples per pixel of each pass (at least two, so that variance can be estimated). Zero disables adaptive sampling.
+     * @param[in] max_sample_count. Maximum number of samples per pixel.
+     * @param[in] error_threshold. Relative error above which a tile keeps receiving samples.
+     * @param[in] noise_target. Average relative error of the image at which to stop early, or zero to only stop on the other criteria.
+     */
+    DECLSPECIFIER void set_adaptive_sampling(unsigned int base_sample_count, unsigned int max_sample_count = 64, float error_threshold = 0.05f, float noise_target = 0.0f);
+
+    /**
+     * @brief Gets the average number of samples per pixel taken for the current frame by adaptive sampling.
+     * @return The average sample count, or zero if adaptive sampling is disabled or has not completed.
+     */
+    DECLSPECIFIER float get_average_sample_count() const { return m_average_sample_count; }
+
+    /**
+     * @brief Enables or disables an arbitrary output variable (AOV), filled from the camera rays' first intersection in the same pass as the colors.
+     * The renderer to file writes the colors and the enabled AOVs to a single multi-channel file. Disabled AOVs are neither computed nor stored.
+     * @param[in] type. The AOV to enable or disable.
+     * @param[in] enabled. Whether the AOV should be output.
+     */
+    DECLSPECIFIER void set_aov_enabled(AOV_Type type, bool enabled);
+
+    /**
+     * @brief Enables or disables the denoiser applied to the framebuffer once all of its samples are computed. Enabling it makes the renderer store the AOVs guiding it.
+     * @param[in] enabled. Whether to denoise the rendered frames.
+     * @param[in] denoiser. Denoiser to apply, with its filter parameters.
+     */
+    DECLSPECIFIER void set_denoiser(bool enabled, Denoiser const& denoiser = Denoiser{});
+
+    /**
+     * @brief Enables or disables the wavefront pipeline, which replaces the per-pixel, depth-first computation of colors with phases processing whole tiles of rays at once.
+     * Each thread takes a tile of rows, generates its camera rays, then processes them one bounce at a time: rays sorted by direction octant are intersected with the scene one object after the other,
+     * then the hits are binned by material and direction octant, the shadow rays of all hits are traced in shared batches, and the hits are shaded, producing the queue of the next bounce.
+     * Adaptive sampling still uses the depth-first computation.
+     * @param[in] enabled. Whether to use the wavefront pipeline.
+     * @param[in] tile_row_count. Number of rows of the tiles of pixels processed together.
+     */
+    DECLSPECIFIER void set_wavefront_pipeline(bool enabled, unsigned int tile_row_count = 2);
+
+    /**
+     * @brief Enables or disables progressive rendering, which favors the time to a first usable image over the time to complete a frame.
+     * A frame starts with a pass sampling one pixel per 4x4 block, then one per 2x2 block, then the remaining pixels, each sample being displayed over its whole block until finer passes replace it.
+     * Passes of one jittered sample per pixel are then accumulated until reaching the maximum sample count. The frame restarts from the coarsest pass whenever the camera, the scene or the resolution changes.
+     * Progressive rendering replaces adaptive sampling and denoising, and takes a single sample per pixel per pass with either integrator. It must be set before the renderer is initialized.
+     * @param[in] enabled. Whether to render progressively.
+     * @param[in] max_sample_count. Number of samples per pixel at which to stop accumulating.
+     */
+    DECLSPECIFIER void set_progressive_rendering(bool enabled, unsigned int max_sample_count = 256);
+
+    /**
+     * @brief Sets the camera used to render the scene, e.g. when the user moves it. Its width and height are ignored, the framebuffer's size being only changed by set_resolution.
+     * With progressive rendering, the camera is replaced between two passes and the frame restarts. Otherwise, it is replaced immediately, and must not be changed while a frame is being computed.
+     * @param[in] draw_camera. The new camera.
+     */
+    DECLSPECIFIER void set_camera(Camera const& draw_camera);
+
+    /**
+     * @brief Modifies the scene, e.g. to move objects or lights.
+     * With progressive rendering, the modification is applied between two passes and the frame restarts. Otherwise, it is applied immediately, and must not be made while a frame is being computed.
+     * @param[in] edit. Function applying the modification to the scene.
+     */
+    DECLSPECIFIER void edit_scene(std::function<void(Scene&)> const& edit);
+
+    /**
+     * @brief Changes the size of the framebuffer, e.g. when the window is resized, the previous image upscaled to the new size being published as a preview.
+     * With progressive rendering, the frame in flight is cancelled, the framebuffer is resized between two passes and the frame restarts at the new size. Otherwise, it is resized immediately, and must not be resized while a frame is being computed.
+     * @param[in] width. New width, in pixels.
+     * @param[in] height. New height, in pixels.
+     */
+    DECLSPECIFIER void set_resolution(int width, int height);
+
+    /**
+     * @brief Sets the time within which progressive frames should produce their first image, i.e. sample every pixel at the chosen quality level.
+     * After each frame, the measured time moves the quality level, i.e. the framebuffer's resolution, the first image's samples per pixel and the reflection depth, towards the target.
+     * Levels drop at once when frames get too slow, and only rise one at a time after several frames with enough room, so that they do not oscillate. Requires progressive rendering.
+     * @param[in] milliseconds. Target time of the first image of a frame, or zero to always render at full quality.
+     */
+    DECLSPECIFIER void set_target_frame_time(float milliseconds);
+
+    /**
+     * @brief Gets the quality level at which the current frame is rendered.
+     * @return The quality level.
+     */
+    DECLSPECIFIER Quality_Level get_quality_level() const;
+
+    /**
+     * @brief Enables or disables temporal reprojection, which reuses the previous frame's colors when only the camera has moved. Requires progressive rendering.
+     * The surface seen through each pixel is splatted to the new view, and the pixels that received a trustworthy color are only traced again by the accumulation passes,
+     * the first pass tracing the disoccluded, view-dependent and refreshed pixels alone. Scene edits and resolution changes discard the history.
+     * @param[in] enabled. Whether to reproject the previous frame.
+     * @param[in] refresh_ratio. Ratio of the reusable pixels traced again anyway, picked at random each frame, so that errors of reused colors do not persist.
+     * @param[in] max_reflective_intensity. Reflective intensity above which a surface's color is considered too dependent on the view direction to be reused.
+     */
+    DECLSPECIFIER void set_temporal_reprojection(bool enabled, float refresh_ratio = 0.05f, float max_reflective_intensity = 0.2f);
+
+    /**
+     * @brief Enables or disables dirty-region rendering, which only renders again the tiles affected by scene edits. Requires progressive rendering.
+     * While sampling, each row of each tile records the objects its rays hit or were shadowed by, and the lights that shaded it. When the next frame only edits the scene
+     * through its tracked modifications (materials, geometries and lights), the tiles that recorded an edited element, or that it may now reach, are cleared and rendered again,
+     * the other pixels keeping their samples. Camera, resolution and light selection changes render every pixel.
+     * @param[in] enabled. Whether to render only the tiles affected by scene edits.
+     */
+    DECLSPECIFIER void set_dirty_region_rendering(bool enabled);
+
+    /**
+     * @brief Enables or disables hybrid rendering, in which the first hits of camera rays are read from a visibility buffer, written by rasterizing the tessellated scene at the start of each frame.
+     * Each camera ray is then only intersected with the object that the visibility buffer shows through its pixel, its shadow and reflection rays being traced as usual.
+     * Pixels next to another object or to the background in the visibility buffer, where tessellation may move the silhouettes, and pixels whose camera ray misses the object,
+     * trace their camera ray through the whole scene, so that the image stays the same as long as the tessellation deviates from the surfaces by less than a pixel.
+     * Only applies to the Whitted integrator, whose camera rays go through the pixels' centers, without progressive rendering, adaptive sampling or the wavefront pipeline.
+     * @param[in] enabled. Whether to read the first hits of camera rays from a visibility buffer.
+     * @param[in] sphere_segment_count. Number of meridians of the spheres' tessellation, the number of parallels being half of it.
+     */
+    DECLSPECIFIER void set_hybrid_visibility(bool enabled, unsigned int sphere_segment_count = 48);
+
+    /**
+     * @brief Gets the number of camera rays of the last frame whose first hit was read from the visibility buffer, instead of being traced through the whole scene.
+     * @return The number of camera rays.
+     */
+    DECLSPECIFIER std::uint64_t get_visibility_buffer_hit_count() const { return m_visibility_hit_count.load(); }
+
+    /**
+     * @brief Enables or disables the culling of the objects tested by camera rays, which is enabled by default.
+     * At the start of each frame, the objects' bounds are projected through the camera, and objects out of the view frustum or beyond its near and far distances are culled.
+     * Each tile of pixels then lists the objects whose projected bounds overlap its own sub-frustum, and camera rays only test the objects of their tile.
+     * Reflection, shadow and path rays still test the whole scene, as do camera rays of the wavefront pipeline, which traces them along with the other rays.
+     * @param[in] enabled. Whether camera rays only test the objects that overlap their tile.
+     */
+    DECLSPECIFIER void set_view_culling(bool enabled);
+
+    /**
+     * @brief Renders several views of the scene in each frame, laid out in the framebuffer, instead of the draw camera's single view.
+     * The tiles of all views are computed by the worker threads sharing the scene. Views with the same camera are only rendered once, views with the same intrinsics
+     * share their camera-space ray directions, and with the Whitted integrator, views looking the same way (e.g. the eyes of a stereo pair) reuse the light visibilities
+     * of the surface points that an earlier view also sees away from silhouettes and shadow edges. This is an approximation, which misses shadow details smaller than a pixel
+     * of the earlier view (see View_Shadow_Cache).
+     * The faces of a cube map look different ways, and share nothing beyond their ray directions. Multi-view frames are computed in a single pass, without adaptive sampling, the wavefront pipeline,
+     * progressive rendering, the visibility buffer or the denoiser, and only by the ray tracing renderers. Must be called after initialize.
+     * @param[in] view_cameras. Cameras of the views (e.g. from Camera::create_stereo_pair or Camera::create_cube_map_faces), each view having the output size, or none to render the draw camera's view again.
+     * @param[in] layout. Arrangement of the views in the framebuffer.
+     */
+    DECLSPECIFIER void set_views(std::vector<Camera> const& view_cameras, View_Layout layout = View_Layout::side_by_side);
+
+    /**
+     * @brief Sets how many shadow rays are cast towards area lights.
+     * A first ray is cast in each cell of a coarse grid on the light's surface. Only if these rays disagree, i.e. if the point lies in a penumbra, the remaining cells of a finer grid are sampled.
+     * @param[in] detection_grid_size. Number of cells along each axis of the coarse grid used to detect penumbrae.
+     * @param[in] penumbra_grid_size. Number of cells along each axis of the fine grid used in penumbrae, rounded up to a multiple of the coarse grid size.
+     */
+    DECLSPECIFIER void set_area_light_sampling(unsigned int detection_grid_size, unsigned int penumbra_grid_size);
+
+    /**
+     * @brief Gets the shadow ray counters accumulated since the current frame started.
+     * @return The shadow ray statistics.
+     */
+    DECLSPECIFIER Shadow_Ray_Statistics get_shadow_ray_statistics() const;
+
+    /**
+     * @brief Enables or disables printing the statistics of each frame (e.g. its time and its number of shadow rays) to the standard output, which is disabled by default.
+     * @param[in] enabled. Whether to print the statistics of each frame.
+     */
+    DECLSPECIFIER void set_statistics_output(bool enabled) { m_statistics_output_enabled = enabled; }
+
     /**
      * @brief Computes the closest intersection between the given ray and an element of the scene's geometry.
      * @param[in] ray. Ray, with origin and direction.
@@ -51,6 +370,49 @@ class Renderer_Base
      */
     DECLSPECIFIER std::pair<Object const*, float> compute_closest_intersection_with_scene(geometry::Ray const& ray, float near_limit, float far_limit) const;
 
+    /**
+     * @brief Computes the closest intersection between the given ray and an element of a subset of the scene's geometry.
+     * @param[in] ray. Ray, with origin and direction.
+     * @param[in] near_limit. Near intersection distance, at which to start looking for intersections.
+     * @param[in] far_limit. Far intersection distance, at which to stop looking for intersections.
+     * @param[in] object_indices. Indices of the objects to test, in increasing order.
+     * @param[in] object_count. Number of objects to test.
+     * @return A pair of values, containing a pointer to the intersected element and the distance separating the intersection from the ray's origin.
+     */
+    DECLSPECIFIER std::pair<Object const*, float> compute_closest_intersection_with_objects(geometry::Ray const& ray, float near_limit, float far_limit, std::uint32_t const* object_indices,
+                                                                                            std::size_t object_count) const;
+
+    /**
+     * @brief Computes the closest intersections between a group of independent rays and the scene's geometry, interleaving the rays to hide the latency of fetching the geometry.
+     * The objects are walked once for the whole group: each object's primitive is tested against every ray in turn while the primitives of the next objects are prefetched,
+     * so that each primitive is fetched from memory once per group instead of once per ray.
+     * @param[in] rays. Rays, with origin and direction.
+     * @param[in] near_limits. Near intersection distance of each ray, at which to start looking for intersections.
+     * @param[in] far_limits. Far intersection distance of each ray, at which to stop looking for intersections.
+     * @param[in] count. Number of rays in the group.
+     * @param[out] out_objects. Closest intersected element of each ray, or nullptr if the ray hits nothing.
+     * @param[out] out_distances. Distance separating each ray's closest intersection from its origin, or its far limit if the ray hits nothing.
+     */
+    DECLSPECIFIER void compute_closest_intersections_with_scene(geometry::Ray const* rays, float const* near_limits, float const* far_limits, unsigned int count, Object const** out_objects, float* out_distances) const;
+
+    /**
+     * @brief Replaces the scene with a field of small spheres too large for the caches, then compares the throughput of single-ray and grouped closest-hit traversal on it.
+     * No frame must be in flight.
+     * @param[in] sphere_count. Number of spheres in the field.
+     * @param[in] ray_count. Number of rays to trace from the origin through the field, both one after the other and in groups.
+     * @param[in] group_size. Number of rays in each group.
+     * @return The throughputs of both traversals.
+     */
+    DECLSPECIFIER Traversal_Benchmark benchmark_traversal(std::size_t sphere_count, unsigned int ray_count, unsigned int group_size);
+
+    /**
+     * @brief Computes frames of the scene without outputting them, e.g. to compare the cost of rendering modes.
+     * No frame must be in flight, and progressive rendering must be disabled.
+     * @param[in] frame_count. Number of frames to compute.
+     * @return The average time taken by a frame, in milliseconds.
+     */
+    DECLSPECIFIER float measure_frame_time(unsigned int frame_count);
+
     /**
      * @brief Checks whether the given ray intersects any element of the scene's geometry.
      * @param[in] ray. Ray, with origin and direction.
@@ -62,24 +424,117 @@ class Renderer_Base
      */
     DECLSPECIFIER bool intersects_any_object(geometry::Ray const& ray, float near_limit, float far_limit, bool invert_culling = false, Object const* first_element_to_check = nullptr) const;
 
+    /**
+     * @brief Traces a batch of shadow rays through a dedicated any-hit path.
+     * Each ray first tests the last occluder that the calling thread found for the same light, then the remaining objects are tested one after the other against all unresolved rays of the batch,
+     * so that coherent rays share the traversal of the scene.
+     * @param[in,out] context. State of the pixel whose shadow rays are traced, whose footprint records the occluders found and whose counters count the rays.
+     * @param[in,out] queries. Shadow rays to trace, whose occluder is written on output.
+     * @param[in] count. Number of shadow rays in the batch.
+     * @param[in] invert_culling. Whether or not to invert culling for this check.
+     */
+    DECLSPECIFIER void trace_shadow_rays(Trace_Context& context, Shadow_Query* queries, unsigned int count, bool invert_culling = true) const;
+
+    /**
+     * @brief Computes the fraction of each given light that is visible from a point, tracing all shadow rays of a pass in a single batch.
+     * Point and directional lights use a single ray, area lights use stratified rays following the adaptive scheme set with set_area_light_sampling, and ambient lights are always visible.
+     * In multi-view frames, the visibilities may be read from or recorded into the caches of the views' first hits, as set in the context.
+     * @param[in,out] context. State of the pixel to which the point belongs.
+     * @param[in] point_position. Position of the point from which the lights are seen.
+     * @param[in] near_limit. Near intersection distance, at which to start looking for occluders.
+     * @param[in] lights. Lights whose visibility to compute.
+     * @param[in] count. Number of lights.
+     * @param[out] out_visibilities. Visible fraction of each light, between zero and one.
+     */
+    DECLSPECIFIER void compute_light_visibilities(Trace_Context& context, Vec3f const& point_position, float near_limit, Light_Sample const* lights, unsigned int count, float* out_visibilities) const;
+
+    /**
+     * @brief Computes the fraction of each given light that is visible from its surface point, for several points at once, tracing the shadow rays of all points in shared batches.
+     * @param[in,out] context. State of the pixels to which the points belong.
+     * @param[in] points. Surface points, each with the range of its lights.
+     * @param[in] point_count. Number of points.
+     * @param[in] lights. Lights of all points, whose visibility to compute.
+     * @param[out] out_visibilities. Visible fraction of each light from its point, between zero and one, indexed as the lights.
+     */
+    DECLSPECIFIER void compute_light_visibilities(Trace_Context& context, Shadow_Point const* points, unsigned int point_count, Light_Sample const* lights, float* out_visibilities) const;
+
     /**
      * @brief Computes the color obtained by intersecting the given ray with the scene's geometry.
+     * @param[in,out] context. State of the pixel whose ray is traced.
      * @param[in] ray. Ray, with origin and direction.
      * @param[in] direction. Direction of the ray, as a unit vector.
      * @param[in] near_limit. Near intersection distance, at which to start looking for intersections.
      * @param[in] far_limit. Far intersection distance, at which to stop looking for intersections.
      * @param[in] recursion_depth. Number of times we reflect the ray off the geometry to look for reflected colors.
-     * @return The computed color.
+     * @param[out] out_hit. (Optional) Surface data of the ray's first intersection.
+     * @param[in] first_intersection. (Optional) First intersection of the ray, with its object (nullptr if none) and distance, if already known, e.g. from the visibility buffer.
+     * @return The computed color, in linear HDR.
      */
-    DECLSPECIFIER Vec3f const compute_color_from_ray(geometry::Ray const& ray, float near_limit, float far_limit, float recursion_depth) const;
+    DECLSPECIFIER Vec3f const compute_color_from_ray(Trace_Context& context, geometry::Ray const& ray, float near_limit, float far_limit, float recursion_depth, Primary_Hit* out_hit = nullptr,
+                                                     std::pair<Object const*, float> const* first_intersection = nullptr) const;
+
+    /**
+     * @brief Computes the radiance carried back along the given camera ray by iterative path tracing.
+     * Each bounce adds the direct lighting of the hit point (next-event estimation against the scene's lights), weighted by the path throughput, then continues the path in a direction sampled from the BRDF.
+     * Paths are terminated by Russian roulette after a few bounces, or when reaching the maximum bounce count.
+     * @param[in,out] context. State of the pixel whose path is traced.
+     * @param[in] ray. Camera ray, with origin and direction.
+     * @param[in] near_limit. Near intersection distance, at which to start looking for intersections.
+     * @param[in] far_limit. Far intersection distance, at which to stop looking for intersections.
+     * @param[out] out_hit. (Optional) Surface data of the ray's first intersection.
+     * @param[in] first_intersection. (Optional) First intersection of the camera ray, if already known.
+     * @return The computed radiance, in linear HDR.
+     */
+    DECLSPECIFIER Vec3f const compute_path_radiance(Trace_Context& context, geometry::Ray const& ray, float near_limit, float far_limit, Primary_Hit* out_hit = nullptr,
+                                                    std::pair<Object const*, float> const* first_intersection = nullptr) const;
+
+    /**
+     * @brief Computes a single sample of the color in the given pixel, with a camera ray jittered over the pixel's footprint and traced with the selected integrator.
+     * @param[in,out] context. State of the pixel.
+     * @param[in] column. Column of the pixel.
+     * @param[in] row. Row of the pixel.
+     * @param[out] out_hit. (Optional) Surface data of the camera ray's first intersection.
+     * @return The sampled color, in linear HDR.
+     */
+    DECLSPECIFIER Vec3f const compute_pixel_sample(Trace_Context& context, int column, int row, Primary_Hit* out_hit = nullptr) const;
+
+    /**
+     * @brief Computes the camera ray through the given pixel, reading its direction from the frame's table of camera rays unless it is jittered.
+     * @param[in] column. Column of the pixel.
+     * @param[in] row. Row of the pixel.
+     * @param[in] jittered. Whether to jitter the ray over the pixel's footprint, or to cast it through the pixel's center.
+     * @return The camera ray.
+     */
+    DECLSPECIFIER geometry::Ray compute_camera_ray(int column, int row, bool jittered) const;
+
+    /**
+     * @brief Computes the first intersection of the camera ray through a pixel's center, from the visibility buffer where it can be trusted, or by tracing the ray otherwise.
+     * @param[in,out] context. State of the pixel, counting the hits read from the visibility buffer.
+     * @param[in] column. Column of the pixel.
+     * @param[in] row. Row of the pixel.
+     * @param[in] ray. Camera ray through the pixel's center.
+     * @return The intersected object (nullptr if none) and the distance to the intersection.
+     */
+    DECLSPECIFIER std::pair<Object const*, float> compute_primary_intersection(Trace_Context& context, int column, int row, geometry::Ray const& ray) const;
+
+    /**
+     * @brief Computes the first intersection of a camera ray, testing only the objects that overlap the tile of the ray's pixel when view culling applies to the frame.
+     * @param[in] column. Column of the ray's pixel.
+     * @param[in] row. Row of the ray's pixel.
+     * @param[in] ray. Camera ray through the pixel, possibly jittered over the pixel's footprint.
+     * @return The intersected object (nullptr if none) and the distance to the intersection.
+     */
+    DECLSPECIFIER std::pair<Object const*, float> compute_camera_ray_intersection(int column, int row, geometry::Ray const& ray) const;
 
     /**
      * @brief Computes the color in the given pixel.
-     * @param[in] u. Horizontal pixel identifier, as a value between zero and one.
-     * @param[in] v. Vertical pixel identifier, as a value between zero and one.
-     * @return The computed color.
+     * @param[in,out] context. State of the pixel.
+     * @param[in] column. Column of the pixel.
+     * @param[in] row. Row of the pixel.
+     * @param[out] out_hit. (Optional) Surface data of the first camera ray's first intersection.
+     * @return The computed color, in linear HDR.
      */
-    DECLSPECIFIER Vec3f const compute_pixel_color(float u, float v) const;
+    DECLSPECIFIER Vec3f const compute_pixel_color(Trace_Context& context, int column, int row, Primary_Hit* out_hit = nullptr) const;
 
   protected:
     DECLSPECIFIER Renderer_Base();
@@ -89,23 +544,295 @@ class Renderer_Base
 
     /**
      * @brief Computes and stores the colors of the next unhandled row of the framebuffer.
-     * This method is made to be called asynchronously using the group of member threads.
+     * This method is made to be called by each worker thread.
      */
     DECLSPECIFIER void compute_pixel_colors_for_next_row();
 
+    /**
+     * @brief Computes and stores the colors of a row of the framebuffer with the Whitted integrator.
+     * The first hits of all pixels of the row are shaded in a shared lighting batch, whose lanes are filled with the lights of several points, before their reflections are traced.
+     * @param[in,out] context. State of the row's pixels.
+     * @param[in] row. Row to compute.
+     */
+    DECLSPECIFIER void compute_whitted_row(Trace_Context& context, int row);
+
     /**
      * @brief Launches the thread group that comptes the pixel colors.
      */
     DECLSPECIFIER void launch_pixel_loading_threads();
 
-    Camera m_draw_camera;                           // Camera to use to draw the scene
-    int m_framebuffer_width;                        // Width of the framebuffer
-    int m_framebuffer_height;                       // Height of the framebuffer
-    Vec3f m_background_color;                       // Background color of the framebuffer
-    Scene m_scene;                                  // Describes the scene's geometry and lighting
-    culling::Type m_culling_type;                   // Whether to cull front or back faces
-    std::vector<std::thread> m_loading_threads;     // List of threads to use to compute the output colors asynchronously
-    std::mutex m_thread_guard;                      // Thread guard used to prevent concurrent writing to the stored output values
-    volatile std::atomic<int> m_last_loaded_row;    // Index of the last row that has been handled by a loading thread
-    std::unordered_map<int, Vec3f> m_loaded_pixels; // Maps each loaded pixel's index in the canvas to its R,G,B values
+    /**
+     * @brief Computes a frame in one pass or in several passes over the framebuffer (adaptive sampling), then applies the post-processing (denoising) and publishes the final pixel values.
+     * This method is made to be called asynchronously, the passes being computed by the worker pool.
+     */
+    DECLSPECIFIER void compute_frame();
+
+    /**
+     * @brief Computes all rows of the framebuffer once, using the worker pool's threads, and waits for them to finish.
+     */
+    DECLSPECIFIER void compute_pass();
+
+    /**
+     * @brief Runs the passes of adaptive sampling, each pass computing the rows of the framebuffer, then updating the tiles that need more samples.
+     */
+    DECLSPECIFIER void compute_adaptive_sampling_passes();
+
+    /**
+     * @brief Checks whether the renderer keeps displaying frames and reacting to changes, in which case progressive rendering waits for changes once a frame is complete instead of stopping.
+     * @return True if the renderer is interactive, false otherwise.
+     */
+    DECLSPECIFIER virtual bool is_interactive() const { return false; }
+
+    /**
+     * @brief Checks whether the renderer displays the pixels published by the render threads while they compute the frame.
+     * @return True if the published pixels are consumed for display, false if they are not published at all.
+     */
+    DECLSPECIFIER virtual bool is_displaying_progress() const { return false; }
+
+    /**
+     * @brief Runs the passes of progressive rendering, restarting the frame whenever the camera or the scene changes, until the renderer is released (or the frame is complete, for non-interactive renderers).
+     * This method is made to be called asynchronously, in place of the thread group.
+     */
+    DECLSPECIFIER void compute_progressive_frames();
+
+    /**
+     * @brief Adds a sample to the pixels of the next unhandled rows of the current progressive pass, and publishes each sampled pixel's color over its block.
+     * This method is made to be called by each worker thread.
+     */
+    DECLSPECIFIER void compute_progressive_rows();
+
+    /**
+     * @brief Publishes the colors of a rectangle of pixels for display, after the rectangles published before it. Does nothing if the renderer does not display progress.
+     * @param[in] x. Column of the rectangle's first pixel.
+     * @param[in] y. Row of the rectangle's first pixel.
+     * @param[in] width. Number of columns of the rectangle.
+     * @param[in] height. Number of rows of the rectangle.
+     * @param[in] channels. Linear red, green and blue values of the rectangle's first pixel, the values of each channel being stored row after row.
+     * @param[in] row_stride. Distance between the values of two consecutive rows in each channel.
+     */
+    DECLSPECIFIER void publish_rectangle(int x, int y, int width, int height, std::array<float const*, 3> const& channels, int row_stride);
+
+    /**
+     * @brief Sets the target time of the first image of progressive frames, and restarts the quality level search from full quality. No pass must be in flight.
+     * @param[in] milliseconds. Target time of the first image of a frame, or zero to always render at full quality.
+     */
+    DECLSPECIFIER void apply_target_frame_time(float milliseconds);
+
+    /**
+     * @brief Applies the current quality level, resizing the framebuffer relative to the output size and limiting the reflection depth. No pass must be in flight.
+     */
+    DECLSPECIFIER void apply_quality_level();
+
+    /**
+     * @brief Moves the quality level according to the time taken by a frame's first image.
+     * @param[in] frame_time. Time taken by the first image, in milliseconds.
+     */
+    DECLSPECIFIER void update_quality_level(float frame_time);
+
+    /**
+     * @brief Gets the number of mirror reflections traced by the Whitted integrator, limited by the quality level.
+     * @return The recursion depth.
+     */
+    DECLSPECIFIER int get_whitted_recursion_depth() const;
+
+    /**
+     * @brief Gets the maximum number of bounces of a path traced by the path tracing integrator, limited by the quality level.
+     * @return The bounce count.
+     */
+    DECLSPECIFIER unsigned int get_path_bounce_count() const;
+
+    /**
+     * @brief Resizes the framebuffer, and replaces the rectangles published at the previous size by the previous image upscaled to the new size. No pass must be in flight.
+     * @param[in] width. New width, in pixels.
+     * @param[in] height. New height, in pixels.
+     */
+    DECLSPECIFIER void resize_framebuffer(int width, int height);
+
+    /**
+     * @brief Places the views of a multi-view frame in the framebuffer, for the current output size. No pass must be in flight.
+     */
+    DECLSPECIFIER void update_view_layout();
+
+    /**
+     * @brief Publishes the colors of whole rows of the framebuffer for display.
+     * @param[in] first_row. First row to publish.
+     * @param[in] end_row. Row after the last row to publish.
+     */
+    DECLSPECIFIER void publish_framebuffer_rows(int first_row, int end_row);
+
+    /**
+     * @brief Computes and stores the colors of the next unhandled tiles of rows with the wavefront pipeline.
+     * This method is made to be called by each worker thread.
+     */
+    DECLSPECIFIER void compute_wavefront_tiles();
+
+    /**
+     * @brief Closest-hit phase of the wavefront pipeline, intersecting all rays of a queue with the scene as a single interleaved group.
+     * @param[in,out] queue. Rays to intersect, whose hit attributes are written on output.
+     */
+    DECLSPECIFIER void trace_closest_hits(Ray_Queue& queue) const;
+
+    /**
+     * @brief Shading phase of the wavefront pipeline: bins the hits of a queue by material and direction, traces their shadow rays in shared batches, then shades them.
+     * The radiance of each ray is added to its pixel, the AOVs of the rays that provide them are stored, and the rays that continue the paths are added to the queue of the next bounce.
+     * @param[in,out] context. State of the tile's pixels.
+     * @param[in,out] queue. Rays whose closest hits were computed, reordered on output.
+     * @param[in] first_pixel. Index of the tile's first pixel.
+     * @param[in,out] tile_colors. Accumulated radiance of the tile's pixels, one array per channel.
+     * @param[out] out_next_queue. Queue to which to add the rays of the next bounce.
+     */
+    DECLSPECIFIER void shade_hits(Trace_Context& context, Ray_Queue& queue, int first_pixel, std::array<std::vector<float>, 3>& tile_colors, Ray_Queue& out_next_queue);
+
+    /**
+     * @brief Enables in the framebuffer the AOVs that are either requested or needed by the denoiser, and disables the others.
+     */
+    DECLSPECIFIER void update_framebuffer_aovs();
+
+    /**
+     * @brief Writes the visibility buffer for the frame about to be computed, if hybrid rendering applies to it.
+     */
+    DECLSPECIFIER void update_visibility_buffer();
+
+    /**
+     * @brief Lists the objects overlapping each tile of the view for the frame about to be computed, if view culling is enabled.
+     */
+    DECLSPECIFIER void update_view_culling();
+
+    /**
+     * @brief Lists the objects overlapping each tile of a view, the objects of each tile being listed in the scene's order.
+     * @param[in] camera. Camera rendering the view.
+     * @param[in] width. Width of the view, in pixels.
+     * @param[in] height. Height of the view, in pixels.
+     * @param[out] out_tile_offsets. Index of the first object of each tile in the list of the tiles' objects, followed by the size of the list.
+     * @param[out] out_tile_objects. Indices of the objects overlapping each tile, tile after tile.
+     */
+    DECLSPECIFIER void list_tile_objects(Camera const& camera, int width, int height, std::vector<std::size_t>& out_tile_offsets, std::vector<std::uint32_t>& out_tile_objects) const;
+
+    /**
+     * @brief Computes a multi-view frame: updates the data of the views, computes the tiles of all views on the worker threads, copies the views rendered twice, then publishes the frame.
+     * This method is made to be called asynchronously, in place of the thread group.
+     */
+    DECLSPECIFIER void compute_views_frame();
+
+    /**
+     * @brief Computes and stores the colors of the next unhandled tiles of the views of a multi-view frame, the tiles of each view being taken after those of the previous views.
+     * This method is made to be called by each worker thread.
+     */
+    DECLSPECIFIER void compute_view_tiles();
+
+    /**
+     * @brief Computes the color of a pixel of a view of a multi-view frame, averaging the samples of the path tracing integrator.
+     * @param[in,out] context. State of the pixel, with the view's camera and shadow caches.
+     * @param[in] view. View to which the pixel belongs.
+     * @param[in] column. Column of the pixel in the view.
+     * @param[in] row. Row of the pixel in the view.
+     * @param[out] out_hit. If not nullptr, surface data of the first intersection of the pixel's first sample.
+     * @return The linear color of the pixel.
+     */
+    DECLSPECIFIER Vec3f const compute_view_pixel_color(Trace_Context& context, Render_View const& view, int column, int row, Primary_Hit* out_hit) const;
+
+    /**
+     * @brief Adds the counters of a thread's context to the frame's counters, and resets them.
+     * @param[in,out] context. Context whose counters to add.
+     */
+    DECLSPECIFIER void add_trace_statistics(Trace_Context& context);
+
+    /**
+     * @brief Computes the first intersection of a camera ray of a view, only testing the objects of the pixel's tile when view culling is enabled.
+     * @param[in] view. View to which the pixel belongs.
+     * @param[in] column. Column of the pixel in the view.
+     * @param[in] row. Row of the pixel in the view.
+     * @param[in] ray. Camera ray through the pixel.
+     * @return The intersected object, or nullptr if the ray hits nothing, along with the distance to the intersection.
+     */
+    DECLSPECIFIER std::pair<Object const*, float> compute_view_ray_intersection(Render_View const& view, int column, int row, geometry::Ray const& ray) const;
+
+    /**
+     * @brief Converts the framebuffer's linear colors to display values, and writes them to a binary PPM file, from the top row to the bottom one.
+     * @param[in] path. Path of the file to write.
+     */
+    DECLSPECIFIER void write_framebuffer_image(char const* path) const;
+
+    Camera m_draw_camera;                                           // Camera to use to draw the scene
+    int m_framebuffer_width;                                        // Width of the framebuffer
+    int m_framebuffer_height;                                       // Height of the framebuffer
+    Vec3f m_background_color;                                       // Background color of the framebuffer
+    Scene m_scene;                                                  // Describes the scene's geometry and lighting
+    culling::Type m_culling_type;                                   // Whether to cull front or back faces
+    std::vector<std::thread> m_loading_threads;                     // Thread computing the frames asynchronously, which runs their passes on the worker pool
+    Worker_Pool m_worker_pool;                                      // Worker threads, one per core, computing the passes of all frames
+    std::mutex m_thread_guard;                                      // Thread guard used to prevent concurrent writing to the stored output values
+    volatile std::atomic<int> m_last_loaded_row;                    // Index of the last row that has been handled by a loading thread
+    std::vector<Pixel_Rectangle> m_published_rectangles;            // Rectangles of pixels computed since the display last consumed them, in publishing order
+    std::vector<float> m_published_colors;                          // Linear colors of the published rectangles
+    int m_published_width;                                          // Width of the framebuffer to which the published rectangles belong
+    int m_published_height;                                         // Height of the framebuffer to which the published rectangles belong
+    Framebuffer m_framebuffer;                                      // Linear HDR colors of all pixels of the canvas
+    Display_Transform m_display_transform;                          // Output stage converting the linear HDR colors to display colors
+    Integrator_Type m_integrator_type;                              // Integrator used to compute pixel colors
+    unsigned int m_samples_per_pixel;                               // Number of camera rays per pixel, for the path tracing integrator
+    unsigned int m_max_bounce_count;                                // Maximum number of bounces of a path, for the path tracing integrator
+    unsigned int m_adaptive_base_sample_count;                      // Number of samples per pixel of each adaptive sampling pass, or zero if adaptive sampling is disabled
+    unsigned int m_adaptive_max_sample_count;                       // Maximum number of samples per pixel of adaptive sampling
+    float m_adaptive_error_threshold;                               // Relative error above which a tile keeps receiving samples
+    float m_adaptive_noise_target;                                  // Average relative error of the image at which adaptive sampling stops early
+    std::vector<unsigned char> m_active_tiles;                      // Whether each tile of the framebuffer receives samples in the current adaptive sampling pass
+    float m_average_sample_count;                                   // Average number of samples per pixel taken by adaptive sampling for the current frame
+    std::array<bool, aov_type_count> m_requested_aovs;              // Whether each AOV is requested for output
+    bool m_denoiser_enabled;                                        // Whether to denoise the rendered frames
+    Denoiser m_denoiser;                                            // Denoiser applied to the rendered frames
+    bool m_wavefront_enabled;                                       // Whether to compute colors with the wavefront pipeline
+    int m_wavefront_tile_row_count;                                 // Number of rows of the tiles processed together by the wavefront pipeline
+    bool m_progressive_enabled;                                     // Whether frames are rendered progressively
+    unsigned int m_progressive_max_sample_count;                    // Number of samples per pixel at which progressive rendering stops accumulating
+    int m_progressive_block_size;                                   // Width and height of the blocks of pixels sampled once by the current progressive pass
+    std::uint32_t m_progressive_sample_count;                       // Number of samples to which the current progressive pass brings the pixels it visits, those that already have them being skipped
+    std::atomic<unsigned int> m_frame_generation;                   // Incremented whenever a change restarts the frame, so that progressive passes in flight stop
+    std::atomic<bool> m_stop_requested;                             // Whether the renderer is being released, so that progressive rendering stops
+    std::mutex m_pending_changes_guard;                             // Thread guard protecting the changes waiting to be applied between two progressive passes
+    std::condition_variable m_pending_changes_condition;            // Notified when a change is requested, to wake up progressive rendering once a frame is complete
+    bool m_has_pending_camera;                                      // Whether a new camera waits to be applied
+    Camera m_pending_camera;                                        // New camera waiting to be applied
+    std::vector<std::function<void(Scene&)>> m_pending_scene_edits; // Modifications of the scene waiting to be applied
+    bool m_has_pending_resolution;                                  // Whether a new framebuffer size waits to be applied
+    int m_pending_width;                                            // New framebuffer width waiting to be applied
+    int m_pending_height;                                           // New framebuffer height waiting to be applied
+    bool m_has_pending_target_frame_time;                           // Whether a new target frame time waits to be applied
+    float m_pending_target_frame_time;                              // New target frame time waiting to be applied, in milliseconds
+    int m_output_width;                                             // Width of the displayed image, of which the framebuffer's width is a fraction with dynamic resolution scaling
+    int m_output_height;                                            // Height of the displayed image, of which the framebuffer's height is a fraction with dynamic resolution scaling
+    float m_target_frame_time;                                      // Target time of the first image of progressive frames, in milliseconds, or zero to disable dynamic resolution scaling
+    std::atomic<unsigned int> m_quality_level;                      // Index of the quality level at which frames are rendered
+    float m_smoothed_frame_time;                                    // Moving average of the times of the first images rendered at the current quality level, or zero if none was measured yet
+    unsigned int m_quality_raise_streak;                            // Number of consecutive frames that left enough room to raise the quality level
+    unsigned int m_reflection_depth_limit;                          // Maximum number of reflections or bounces after the camera hit, set by the quality level
+    bool m_reprojection_enabled;                                    // Whether to reuse the previous frame's colors when only the camera has moved
+    float m_reprojection_refresh_ratio;                             // Ratio of the reusable pixels traced again anyway
+    float m_reprojection_max_reflective_intensity;                  // Reflective intensity above which a surface's color is not reused
+    Reprojection_Cache m_reprojection_cache;                        // Surfaces seen through the pixels of the current frame, from which the next frame is reprojected
+    bool m_dirty_regions_enabled;                                   // Whether to only render again the tiles affected by scene edits
+    Edit_Footprints m_edit_footprints;                              // Objects and lights contributing to each row of each tile, recorded while rendering progressive frames
+    bool m_are_footprints_complete;                                 // Whether the footprints cover every sample of the framebuffer, which allows rendering only the tiles affected by scene edits
+    std::vector<unsigned char> m_dirty_tiles;                       // Whether each tile is affected by the scene edits applied at the start of the current frame
+    bool m_hybrid_visibility_enabled;                               // Whether to read the first hits of camera rays from a visibility buffer
+    unsigned int m_visibility_sphere_segment_count;                 // Number of meridians of the spheres' tessellation, for the visibility buffer
+    Rasterizer m_visibility_rasterizer;                             // Rasterizer writing the visibility buffer
+    bool m_is_visibility_buffer_current;                            // Whether the visibility buffer was written for the current frame, whose camera rays then read it
+    std::atomic<std::uint64_t> m_visibility_hit_count;              // Number of camera rays of the current frame whose first hit was read from the visibility buffer
+    Camera_Ray_Table m_camera_rays;                                 // Directions of the camera rays through the pixels' centers, for the current frame's camera
+    bool m_view_culling_enabled;                                    // Whether camera rays only test the objects that overlap their tile of the view
+    bool m_is_view_culling_current;                                 // Whether the objects of the tiles were listed for the current frame, whose camera rays then test them only
+    std::vector<std::size_t> m_view_tile_offsets;                   // Index of the first object of each tile in the list of the tiles' objects, followed by the size of the list
+    std::vector<std::uint32_t> m_view_tile_objects;                 // Indices of the objects overlapping each tile of the view, tile after tile
+    std::vector<Render_View> m_views;                               // Views of multi-view frames, or none to render the draw camera's single view
+    int m_view_column_count;                                        // Number of columns of views in the framebuffer, one for a single view
+    int m_view_row_count;                                           // Number of rows of views in the framebuffer, one for a single view
+    std::atomic<int> m_next_view_tile;                              // Index of the next tile of the views of a multi-view frame to be handled by a thread
+    unsigned int m_shadow_detection_grid_size;                      // Number of cells along each axis of the coarse grid of shadow rays cast towards area lights
+    unsigned int m_shadow_penumbra_grid_size;                       // Number of cells along each axis of the fine grid of shadow rays cast towards area lights in penumbrae
+    std::atomic<std::uint64_t> m_shadow_ray_count;                  // Number of shadow rays traced in the current frame
+    std::atomic<std::uint64_t> m_area_light_evaluations;            // Number of area light visibility estimations in the current frame
+    std::atomic<std::uint64_t> m_refined_evaluations;               // Number of area light visibility estimations that detected a penumbra in the current frame
+    std::atomic<std::uint64_t> m_reused_shadow_points;              // Number of hit points whose light visibilities were reused from another view's hits in the current frame
+    bool m_statistics_output_enabled;                               // Whether the statistics of each frame are printed to the standard output
 };
@@ -20,12 +20,24 @@ Renderer_OpenGL::Renderer_OpenGL()
     , m_ebo_id{0}
     , m_shader_program_id{0}
     , m_texture_id{0}
+    , m_window_width{0}
+    , m_window_height{0}
+    , m_texture_width{0}
+    , m_texture_height{0}
+    , m_pixel_buffer_ids{}
+    , m_next_pixel_buffer{0}
+    , m_uploaded_rectangles{}
+    , m_uploaded_colors{}
+    , m_viewer_camera{}
 {
+    // The viewer shows a coarse image first and refines it, restarting when the camera moves, unless progressive rendering is disabled before initializing it
+    set_progressive_rendering(true);
 }
 
 void Renderer_OpenGL::initialize(Camera const& draw_camera, Vec3f const& background_color)
 {
     Renderer_Base::initialize(draw_camera, background_color);
+    m_viewer_camera = draw_camera;
     initialize_window();
     initialize_fullscreen_quad_rendering();
     launch_pixel_loading_threads();
@@ -42,6 +54,9 @@ void Renderer_OpenGL::draw_scene()
     glClearColor(1.0f, 0.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
+    // Update the texture with the pixels computed since the last frame
+    upload_published_rectangles();
+
     // Draw a fullscreen quad with the given texture
     glUseProgram(m_shader_program_id);
     glBindVertexArray(m_vao_id);
@@ -49,24 +64,6 @@ void Renderer_OpenGL::draw_scene()
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 
-    m_thread_guard.lock();
-    if (m_loaded_pixels.size() > 0)
-    {
-        glBindTexture(GL_TEXTURE_2D, m_texture_id);
-        for (auto& pixel : m_loaded_pixels)
-        {
-            auto const pixel_index = pixel.first;
-            auto const pixel_rgb = pixel.second;
-            auto const pixel_y = pixel_index / m_framebuffer_width;
-            auto const pixel_x = pixel_index - (pixel_y * m_framebuffer_width);
-            std::vector<float> pixel_rgb_value{pixel_rgb.x(), pixel_rgb.y(), pixel_rgb.z()};
-            glTexSubImage2D(GL_TEXTURE_2D, 0, pixel_x, pixel_y, 1, 1, GL_RGB, GL_FLOAT, pixel_rgb_value.data());
-        }
-        glBindTexture(GL_TEXTURE_2D, 0);
-        m_loaded_pixels.clear();
-    }
-    m_thread_guard.unlock();
-
     // Swap buffers
     glfwSwapBuffers(m_window);
     glfwPollEvents();
@@ -80,6 +77,7 @@ void Renderer_OpenGL::release()
     glDeleteBuffers(1, &m_vbo_id);
     glDeleteBuffers(1, &m_ebo_id);
     glDeleteTextures(1, &m_texture_id);
+    glDeleteBuffers(static_cast<int>(m_pixel_buffer_ids.size()), m_pixel_buffer_ids.data());
     glDeleteProgram(m_shader_program_id);
 
     glfwTerminate();
@@ -94,7 +92,9 @@ void Renderer_OpenGL::initialize_window()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    m_window = glfwCreateWindow(m_framebuffer_width, m_framebuffer_height, "Raytracer", nullptr, nullptr);
+    m_window_width = m_framebuffer_width;
+    m_window_height = m_framebuffer_height;
+    m_window = glfwCreateWindow(m_window_width, m_window_height, "Raytracer", nullptr, nullptr);
     if (m_window == nullptr)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -117,8 +117,14 @@ void Renderer_OpenGL::initialize_window()
     glBindTexture(GL_TEXTURE_2D, m_texture_id);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_framebuffer_width, m_framebuffer_height, 0, GL_RGB, GL_FLOAT, nullptr);
+    m_texture_width = m_framebuffer_width;
+    m_texture_height = m_framebuffer_height;
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, m_texture_width, m_texture_height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Display colors are uploaded as tightly packed 8-bit RGB rows
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenBuffers(static_cast<int>(m_pixel_buffer_ids.size()), m_pixel_buffer_ids.data());
 }
 
 void Renderer_OpenGL::initialize_fullscreen_quad_rendering()
@@ -159,33 +165,116 @@ void Renderer_OpenGL::initialize_fullscreen_quad_rendering()
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void Renderer_OpenGL::upload_published_rectangles()
+{
+    // Take the published rectangles, leaving empty arrays with the previous allocations to the render threads
+    auto published_width = 0;
+    auto published_height = 0;
+    {
+        std::lock_guard<std::mutex> lock{m_thread_guard};
+        m_uploaded_rectangles.swap(m_published_rectangles);
+        m_uploaded_colors.swap(m_published_colors);
+        published_width = m_published_width;
+        published_height = m_published_height;
+    }
+    if (m_uploaded_rectangles.empty())
+        return;
+
+    // Reallocate the texture if the framebuffer was resized, the rectangles taken along with the new size all belonging to it
+    if (published_width != m_texture_width || published_height != m_texture_height)
+    {
+        m_texture_width = published_width;
+        m_texture_height = published_height;
+        glBindTexture(GL_TEXTURE_2D, m_texture_id);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, m_texture_width, m_texture_height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // Convert the colors to display values in the next pixel buffer of the ring, each pixel's three linear values becoming three bytes at the same offset
+    auto const buffer_size = static_cast<GLsizeiptr>(m_uploaded_colors.size());
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixel_buffer_ids[m_next_pixel_buffer]);
+    m_next_pixel_buffer = (m_next_pixel_buffer + 1) % static_cast<unsigned int>(m_pixel_buffer_ids.size());
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer_size, nullptr, GL_STREAM_DRAW);
+    auto* const display_values = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, buffer_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (display_values != nullptr)
+    {
+        for (auto const& rectangle : m_uploaded_rectangles)
+        {
+            auto const pixel_count = static_cast<std::size_t>(rectangle.width) * rectangle.height;
+            auto const* red = m_uploaded_colors.data() + rectangle.first_value;
+            m_display_transform.apply(red, red + pixel_count, red + 2 * pixel_count, pixel_count, display_values + rectangle.first_value);
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        // Update the texture from the pixel buffer, one call per rectangle in publishing order, so that later values replace earlier ones
+        glBindTexture(GL_TEXTURE_2D, m_texture_id);
+        for (auto const& rectangle : m_uploaded_rectangles)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rectangle.x, rectangle.y, rectangle.width, rectangle.height, GL_RGB, GL_UNSIGNED_BYTE, reinterpret_cast<void const*>(rectangle.first_value));
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    m_uploaded_rectangles.clear();
+    m_uploaded_colors.clear();
+}
+
 void Renderer_OpenGL::process_input()
 {
     // Enable closing the window on escape key press
     if (glfwGetKey(m_window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(m_window, true);
+
+    // Move the camera, the progressive renderer restarting its frame from the coarsest pass
+    if (!m_progressive_enabled)
+        return;
+    auto constexpr move_step = 0.05f;
+    std::array<std::pair<int, Vec3f>, 6> const moves{std::make_pair(GLFW_KEY_W, Vec3f{0.0f, 0.0f, move_step}), std::make_pair(GLFW_KEY_S, Vec3f{0.0f, 0.0f, -move_step}),
+                                                     std::make_pair(GLFW_KEY_A, Vec3f{-move_step, 0.0f, 0.0f}), std::make_pair(GLFW_KEY_D, Vec3f{move_step, 0.0f, 0.0f}),
+                                                     std::make_pair(GLFW_KEY_Q, Vec3f{0.0f, -move_step, 0.0f}), std::make_pair(GLFW_KEY_E, Vec3f{0.0f, move_step, 0.0f})};
+    auto has_moved = false;
+    for (auto const& move : moves)
+    {
+        if (glfwGetKey(m_window, move.first) == GLFW_PRESS)
+        {
+            m_viewer_camera.set_position(m_viewer_camera.get_position() + move.second);
+            has_moved = true;
+        }
+    }
+    if (has_moved)
+        set_camera(m_viewer_camera);
 }
 
 void Renderer_OpenGL::change_framebuffer_size(GLFWwindow* window, int width, int height)
 {
-    if (window == m_window && (m_framebuffer_width != width || m_framebuffer_height != height))
+    if (window == m_window && width > 0 && height > 0 && (m_window_width != width || m_window_height != height))
     {
         // Update window width and height values while ensuring the aspect ratio stays the same
-        auto const height_on_width_ratio = m_framebuffer_height * 1.0f / m_framebuffer_width;
+        auto const height_on_width_ratio = m_window_height * 1.0f / m_window_width;
         auto width_mult_factor = 1.0f;
-        if (m_framebuffer_width != width)
+        if (m_window_width != width)
         {
-            width_mult_factor = (width * 1.0f / m_framebuffer_width);
+            width_mult_factor = (width * 1.0f / m_window_width);
         }
-        else if (m_framebuffer_height != height)
+        else if (m_window_height != height)
         {
-            width_mult_factor = ((height / height_on_width_ratio) * 1.0f / m_framebuffer_width);
+            width_mult_factor = ((height / height_on_width_ratio) * 1.0f / m_window_width);
         }
-        m_framebuffer_width = static_cast<int>(width_mult_factor * m_framebuffer_width);
-        m_framebuffer_height = static_cast<int>(height_on_width_ratio * m_framebuffer_width);
+        m_window_width = static_cast<int>(width_mult_factor * m_window_width);
+        m_window_height = static_cast<int>(height_on_width_ratio * m_window_width);
         // Update the viewport and window size accordingly
-        glViewport(0, 0, m_framebuffer_width, m_framebuffer_height);
-        glfwSetWindowSize(m_window, m_framebuffer_width, m_framebuffer_height);
+        glViewport(0, 0, m_window_width, m_window_height);
+        glfwSetWindowSize(m_window, m_window_width, m_window_height);
+        // Render at the new resolution, the framebuffer being resized by the progressive renderer between two passes.
+        // Otherwise, the frame in flight cannot be cancelled, so it is completed before the framebuffer is resized and the frame computed again
+        if (m_progressive_enabled)
+        {
+            set_resolution(m_window_width, m_window_height);
+            return;
+        }
+        for (auto& loading_thread : m_loading_threads)
+            loading_thread.join();
+        m_loading_threads.clear();
+        set_resolution(m_window_width, m_window_height);
+        launch_pixel_loading_threads();
     }
 }
 
@@ -8,6 +8,9 @@
 
 #include <math/vec.h>
 
+#include <array>
+#include <vector>
+
 struct GLFWwindow;
 
 class Renderer_OpenGL : public Renderer_Base
@@ -25,14 +28,20 @@ class Renderer_OpenGL : public Renderer_Base
     DECLSPECIFIER void release() override;
 
     /**
-     * @brief Modifies the framebuffer's size on receiving a callback from the window object.
-     * Note that we constrain the width/height ratio of the framebuffer to stay the same.
+     * @brief Modifies the window's size on receiving a callback from the window object.
+     * Note that we constrain the width/height ratio of the window to stay the same.
+     * The framebuffer is resized to match and the frame restarts at the new resolution, the previous image being displayed upscaled in the meantime. With progressive rendering, which the viewer uses
+     * by default, the frame in flight is cancelled. Otherwise, it is completed first.
      * @param[in] window. The window object being resized.
      * @param[in] width. The new proposed width for the window.
      * @param[in] height. The new proposed height for the window.
      */
     DECLSPECIFIER void change_framebuffer_size(GLFWwindow* window, int width, int height);
 
+  protected:
+    DECLSPECIFIER bool is_interactive() const override { return true; }
+    DECLSPECIFIER bool is_displaying_progress() const override { return true; }
+
   private:
     DECLSPECIFIER Renderer_OpenGL();
 
@@ -46,17 +55,34 @@ class Renderer_OpenGL : public Renderer_Base
      */
     DECLSPECIFIER void initialize_fullscreen_quad_rendering();
 
+    /**
+     * @brief Uploads the rectangles of pixels published since the last frame to the displayed texture, one texture update per rectangle.
+     * Their display colors are written to the next pixel buffer object of the ring, orphaned first so that the driver never waits for a previous upload to complete.
+     * The render threads are only blocked while the published rectangles are taken, not during the conversion or the upload.
+     */
+    DECLSPECIFIER void upload_published_rectangles();
+
     /**
      * @brief Performs actions when the user presses a key.
+     * With progressive rendering, the W/S, A/D and Q/E keys move the camera along the Z, X and Y axes, restarting the frame.
      */
     DECLSPECIFIER void process_input();
 
-    GLFWwindow* m_window;             // Main window of the application
-    unsigned int m_vao_id;            // ID of the vertex array object used for fullscreen quad rendering
-    unsigned int m_vbo_id;            // ID of the vertex buffer object used for fullscreen quad rendering
-    unsigned int m_ebo_id;            // ID of the element buffer object used for fullscreen quad rendering
-    unsigned int m_shader_program_id; // ID of the shader program object used for fullscreen quad rendering
-    unsigned int m_texture_id;        // ID of the texture object used for fullscreen quad rendering
+    GLFWwindow* m_window;                               // Main window of the application
+    unsigned int m_vao_id;                              // ID of the vertex array object used for fullscreen quad rendering
+    unsigned int m_vbo_id;                              // ID of the vertex buffer object used for fullscreen quad rendering
+    unsigned int m_ebo_id;                              // ID of the element buffer object used for fullscreen quad rendering
+    unsigned int m_shader_program_id;                   // ID of the shader program object used for fullscreen quad rendering
+    unsigned int m_texture_id;                          // ID of the texture object used for fullscreen quad rendering
+    int m_window_width;                                 // Width of the window
+    int m_window_height;                                // Height of the window
+    int m_texture_width;                                // Width of the texture, following the framebuffer's size
+    int m_texture_height;                               // Height of the texture, following the framebuffer's size
+    std::array<unsigned int, 3> m_pixel_buffer_ids;     // IDs of the ring of pixel buffer objects through which the texture is updated
+    unsigned int m_next_pixel_buffer;                   // Index in the ring of the pixel buffer object to use for the next upload
+    std::vector<Pixel_Rectangle> m_uploaded_rectangles; // Published rectangles taken for upload, swapped with the published ones to keep both allocations
+    std::vector<float> m_uploaded_colors;               // Linear colors of the rectangles taken for upload
+    Camera m_viewer_camera;                             // Camera moved by the user, passed to the renderer on each move
 };
 
 #endif
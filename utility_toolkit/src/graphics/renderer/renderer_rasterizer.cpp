@@ -0,0 +1,129 @@
+#include "renderer_rasterizer.h"
+
+#if defined(RENDERER_RASTERIZER)
+
+#include <graphics/light.h>
+#include <graphics/material.h>
+#include <graphics/object.h>
+#include <math/vec.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+
+auto constexpr default_sphere_segment_count = 48u;        // Number of meridians of the spheres' tessellation, unless set otherwise
+auto constexpr default_occluder_min_screen_ratio = 0.1f; // Ratio of the screen covered by the projected bounds of the occluders, unless set otherwise
+
+} // namespace
+
+Renderer_Rasterizer::Renderer_Rasterizer()
+    : Renderer_Base()
+    , m_rasterizer{}
+    , m_sphere_segment_count{default_sphere_segment_count}
+    , m_is_tessellation_outdated{true}
+    , m_has_drawn_scene{false}
+{
+    m_rasterizer.set_occlusion_culling(true, default_occluder_min_screen_ratio);
+}
+
+void Renderer_Rasterizer::initialize(Camera const& draw_camera, Vec3f const& background_color)
+{
+    Renderer_Base::initialize(draw_camera, background_color);
+    m_is_tessellation_outdated = true;
+    m_has_drawn_scene = false;
+}
+
+bool Renderer_Rasterizer::should_continue_render_loop() const { return !m_has_drawn_scene; }
+
+void Renderer_Rasterizer::draw_scene()
+{
+    auto const frame_start = std::chrono::steady_clock::now();
+    // Tessellate the scene again only if it was edited since the last frame
+    if (!m_scene.take_changes().empty() || m_is_tessellation_outdated)
+    {
+        m_rasterizer.set_scene(m_scene, m_sphere_segment_count);
+        m_is_tessellation_outdated = false;
+    }
+    // Find the nearest triangle of each pixel, then shade the pixels by bands of rows, one per worker thread
+    m_rasterizer.rasterize(m_draw_camera, m_framebuffer_width, m_framebuffer_height, m_culling_type, m_worker_pool);
+    auto const thread_count = m_worker_pool.get_thread_count();
+    auto const rows_per_thread = (m_framebuffer_height + static_cast<int>(thread_count) - 1) / static_cast<int>(thread_count);
+    m_worker_pool.run([&](unsigned int thread_index) {
+        auto const first_row = static_cast<int>(thread_index) * rows_per_thread;
+        auto const end_row = (std::min)(first_row + rows_per_thread, m_framebuffer_height);
+        shade_rows(first_row, end_row);
+    });
+    auto const frame_time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+    // Output the pixels to file, and report the frame's cost if requested
+    write_framebuffer_image("./_build/output.ppm");
+    if (m_statistics_output_enabled)
+    {
+        auto const& statistics = m_rasterizer.get_occlusion_statistics();
+        std::cout << "Rasterized " << m_rasterizer.get_triangle_count() << " triangles in " << frame_time << " ms" << std::endl;
+        std::cout << "Occlusion culling: " << statistics.culled_object_count << " / " << m_scene.get_objects().size() << " objects and " << statistics.culled_triangle_count
+                  << " triangles culled behind " << statistics.occluder_count << " occluders" << std::endl;
+    }
+    // Notify that we have finished drawing
+    m_has_drawn_scene = true;
+}
+
+void Renderer_Rasterizer::release() { Renderer_Base::release(); }
+
+void Renderer_Rasterizer::set_sphere_tessellation(unsigned int segment_count)
+{
+    m_sphere_segment_count = segment_count;
+    m_is_tessellation_outdated = true;
+}
+
+void Renderer_Rasterizer::set_occlusion_culling(bool is_enabled, float occluder_min_screen_ratio) { m_rasterizer.set_occlusion_culling(is_enabled, occluder_min_screen_ratio); }
+
+void Renderer_Rasterizer::shade_rows(int first_row, int end_row)
+{
+    auto const& objects = m_scene.get_objects();
+    auto const& camera_position = m_draw_camera.get_position();
+    auto const* triangle_ids = m_rasterizer.get_triangle_ids();
+    auto const* barycentrics = m_rasterizer.get_barycentrics();
+    std::vector<Light_Sample> selected_lights;
+    std::vector<float> light_visibilities;
+    Lighting_Batch lighting_batch;
+    for (auto j = first_row; j < end_row; j++)
+    {
+        // Add the points of the row to a shared lighting batch, whose lanes are filled with the lights of several points
+        lighting_batch.clear();
+        for (auto i = 0; i < m_framebuffer_width; i++)
+        {
+            auto const index = j * m_framebuffer_width + i;
+            auto const triangle = triangle_ids[index];
+            if (triangle < 0)
+                continue;
+            // Place the surface point where the pixel's camera ray crosses the triangle
+            auto const position = m_rasterizer.compute_position(triangle, barycentrics[index]);
+            // Shade the point with the same direct lighting as ray tracing, every light being considered visible
+            auto const& object = objects[m_rasterizer.get_object_index(triangle)];
+            auto const& material = object.get_material();
+            auto const& primitive = object.get_primitive();
+            auto const normal = primitive.compute_normal_from_position_on_primitive(position);
+            // Constant materials do not depend on UV coordinates, so skip computing them
+            auto const uv = material.is_constant() ? Vec2f::zero() : primitive.compute_uv_from_position_on_primitive(position);
+            m_scene.select_lights(position, selected_lights);
+            light_visibilities.assign(selected_lights.size(), 1.0f);
+            lighting_batch.add_point(selected_lights.data(), light_visibilities.data(), static_cast<unsigned int>(selected_lights.size()), normal, camera_position, position,
+                                     material.get_surface_parameters(uv));
+        }
+        lighting_batch.flush();
+
+        // Each pixel is written by a single thread, so the framebuffer can be written without locking
+        auto point_index = 0u;
+        for (auto i = 0; i < m_framebuffer_width; i++)
+        {
+            auto const index = j * m_framebuffer_width + i;
+            m_framebuffer.set_color(index, (triangle_ids[index] < 0) ? m_background_color : lighting_batch.get_color(point_index++));
+        }
+    }
+}
+
+#endif
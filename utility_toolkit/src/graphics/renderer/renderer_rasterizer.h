@@ -0,0 +1,65 @@
+#pragma once
+
+#include <graphics/renderer/renderer_defines.h>
+
+#if defined(RENDERER_RASTERIZER)
+
+#include "rasterizer.h"
+#include "renderer_base.h"
+
+#include <graphics/camera.h>
+
+/**
+ * @brief Preview renderer rasterizing the tessellated scene instead of tracing rays, then shading each pixel's nearest surface with the materials' direct lighting.
+ * Shadows and reflections are not computed, so that frames take milliseconds, and objects hidden by large occluders are culled before rasterization. The frame is written to file, as with the renderer to file.
+ */
+class Renderer_Rasterizer : public Renderer_Base
+{
+  public:
+    DECLSPECIFIER static Renderer_Rasterizer& get_instance()
+    {
+        static Renderer_Rasterizer global_renderer;
+        return global_renderer;
+    }
+
+    DECLSPECIFIER void initialize(Camera const& draw_camera, Vec3f const& background_color) override;
+    DECLSPECIFIER bool should_continue_render_loop() const override;
+    DECLSPECIFIER void draw_scene() override;
+    DECLSPECIFIER void release() override;
+
+    /**
+     * @brief Sets the tessellation of the spheres, which are split along meridians and parallels. The scene is tessellated again for the next frame.
+     * @param[in] segment_count. Number of meridians, the number of parallels being half of it.
+     */
+    DECLSPECIFIER void set_sphere_tessellation(unsigned int segment_count);
+
+    /**
+     * @brief Enables or disables the culling of the objects hidden by large occluders before their triangles are set up, which is enabled by default.
+     * @param[in] is_enabled. Whether to cull hidden objects.
+     * @param[in] occluder_min_screen_ratio. Ratio of the screen that the projected bounds of an object must cover for the object to be drawn first as an occluder.
+     */
+    DECLSPECIFIER void set_occlusion_culling(bool is_enabled, float occluder_min_screen_ratio = 0.1f);
+
+    /**
+     * @brief Gets the numbers of occluders, culled objects and culled triangles of the last frame.
+     * @return The occlusion culling statistics.
+     */
+    DECLSPECIFIER Rasterizer::Occlusion_Statistics get_occlusion_statistics() const { return m_rasterizer.get_occlusion_statistics(); }
+
+  private:
+    DECLSPECIFIER Renderer_Rasterizer();
+
+    /**
+     * @brief Shades the nearest surface of each pixel of a range of rows, found by the last rasterization, and stores its color in the framebuffer.
+     * @param[in] first_row. First row to shade.
+     * @param[in] end_row. Row after the last row to shade.
+     */
+    DECLSPECIFIER void shade_rows(int first_row, int end_row);
+
+    Rasterizer m_rasterizer;             // Rasterizer finding the nearest triangle of each pixel
+    unsigned int m_sphere_segment_count; // Number of meridians of the spheres' tessellation
+    bool m_is_tessellation_outdated;     // Whether the scene must be tessellated again before the next frame
+    bool m_has_drawn_scene;              // True if the scene has already been drawn once, false otherwise
+};
+
+#endif
@@ -3,8 +3,9 @@
 #if defined(RENDERER_TO_FILE)
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
-#include <vector>
+#include <iostream>
 
 void Renderer_To_File::initialize(Camera const& draw_camera, Vec3f const& background_color)
 {
@@ -17,26 +18,39 @@ bool Renderer_To_File::should_continue_render_loop() const { return !m_has_drawn
 void Renderer_To_File::draw_scene()
 {
     // Launch the threads and wait for them to finish processing
+    auto const frame_start = std::chrono::steady_clock::now();
     launch_pixel_loading_threads();
     for (auto& loading_thread : m_loading_threads)
         loading_thread.join();
+    m_loading_threads.clear();
+    auto const frame_time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
     // Output the pixels to file
-    std::ofstream ofs("./_build/output.ppm", std::ios::out | std::ios::binary);
-    ofs << "P6\n" << m_framebuffer_width << " " << m_framebuffer_height << "\n255\n";
-    for (auto row_it = m_framebuffer_height - 1; row_it >= 0; row_it--)
+    write_framebuffer_image("./_build/output.ppm");
+    // Output the colors along with the requested AOVs to a single multi-channel file
+    if (std::find(m_requested_aovs.begin(), m_requested_aovs.end(), true) != m_requested_aovs.end())
     {
-        for (auto column_it = 0; column_it < m_framebuffer_width; column_it++)
-        {
-            auto const index = (row_it * m_framebuffer_height + column_it);
-            auto const loaded_pixel = m_loaded_pixels.at(index);
-            ofs << static_cast<unsigned char>((std::min)(1.0f, loaded_pixel.x()) * 255) << static_cast<unsigned char>((std::min)(1.0f, loaded_pixel.y()) * 255) << static_cast<unsigned char>((std::min)(1.0f, loaded_pixel.z()) * 255);
-        }
+        std::ofstream aov_ofs("./_build/output.aov", std::ios::out | std::ios::binary);
+        m_framebuffer.write_channels(aov_ofs);
+    }
+    // If requested, report the frame's time, the number of shadow rays traced for it, the camera rays that read their first hit from the visibility buffer, the views' reused light visibilities,
+    // and the average sample count reached by adaptive sampling
+    if (m_statistics_output_enabled)
+    {
+        std::cout << "Frame time: " << frame_time << " ms" << std::endl;
+        auto const shadow_statistics = get_shadow_ray_statistics();
+        std::cout << "Shadow rays: " << shadow_statistics.ray_count << " (area light penumbrae refined: " << shadow_statistics.refined_evaluations << " / " << shadow_statistics.area_light_evaluations << ")"
+                  << std::endl;
+        if (m_is_visibility_buffer_current)
+            std::cout << "Visibility buffer: " << get_visibility_buffer_hit_count() << " / " << m_framebuffer.get_pixel_count() << " camera rays not traced through the scene" << std::endl;
+        if (!m_views.empty())
+            std::cout << "Views: " << m_views.size() << " rendered in one pass (hit points reusing another view's light visibilities: " << shadow_statistics.reused_point_count << ")" << std::endl;
+        if (m_adaptive_base_sample_count > 0)
+            std::cout << "Adaptive sampling: " << get_average_sample_count() << " samples per pixel on average" << std::endl;
     }
-    ofs.close();
     // Notify that we have finished drawing
     m_has_drawn_scene = true;
 }
 
-void Renderer_To_File::release() {}
+void Renderer_To_File::release() { Renderer_Base::release(); }
 
 #endif
@@ -0,0 +1,104 @@
+#include "reprojection_cache.h"
+
+#include <math/math.h>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace
+{
+
+auto constexpr silhouette_depth_tolerance = 0.1f; // Relative distance by which a neighbor's surface must be nearer for a pixel to be considered next to its silhouette
+
+} // namespace
+
+void Reprojection_Cache::resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_surfaces.assign(static_cast<std::size_t>(width) * height, Surface{});
+}
+
+void Reprojection_Cache::invalidate()
+{
+    for (auto& surface : m_surfaces)
+        surface.is_valid = false;
+}
+
+int Reprojection_Cache::reproject(Framebuffer& framebuffer, Camera const& camera, float max_reflective_intensity, float refresh_ratio)
+{
+    auto const near_plane = camera.get_near();
+    auto const pixel_count = m_width * m_height;
+    if (framebuffer.get_width() != m_width || framebuffer.get_height() != m_height)
+    {
+        framebuffer.reset_sample_statistics();
+        resize(framebuffer.get_width(), framebuffer.get_height());
+        return 0;
+    }
+
+    // Splat each sampled pixel's surface into the new view, keeping the nearest surface of each new pixel
+    m_sources.assign(pixel_count, -1);
+    m_splat_distances.assign(pixel_count, (std::numeric_limits<float>::max)());
+    for (auto source = 0; source < pixel_count; source++)
+    {
+        auto const& surface = m_surfaces[source];
+        if (!surface.is_valid || framebuffer.get_sample_count(source) == 0 || surface.reflective_intensity > max_reflective_intensity)
+            continue;
+        auto const direction = surface.position - camera.get_position();
+        auto const view_position = camera.to_view_space(surface.position);
+        if (view_position.z() <= near_plane || surface.normal.dot(direction) >= 0.0f)
+            continue;
+        auto const column = static_cast<int>(std::lround((near_plane * view_position.x() / view_position.z() + 0.5f) * (m_width - 1)));
+        auto const row = static_cast<int>(std::lround((near_plane * view_position.y() / view_position.z() + 0.5f) * (m_height - 1)));
+        if (column < 0 || column >= m_width || row < 0 || row >= m_height)
+            continue;
+        auto const target = row * m_width + column;
+        auto const distance = direction.length();
+        if (distance < m_splat_distances[target])
+        {
+            m_sources[target] = source;
+            m_splat_distances[target] = distance;
+        }
+    }
+
+    // Gather the colors and surfaces of the reused pixels, rejecting those next to a nearer surface, whose silhouette may have uncovered them,
+    // and a random part of the others, so that they are refreshed
+    for (auto& channel : m_colors)
+        channel.resize(pixel_count);
+    m_reprojected_surfaces.assign(pixel_count, Surface{});
+    m_is_reused.assign(pixel_count, 0);
+    auto const is_near_silhouette = [this](int target, int neighbor) {
+        return m_sources[neighbor] >= 0 && m_splat_distances[neighbor] < m_splat_distances[target] * (1.0f - silhouette_depth_tolerance);
+    };
+    auto reused_pixel_count = 0;
+    for (auto row = 0; row < m_height; row++)
+    {
+        for (auto column = 0; column < m_width; column++)
+        {
+            auto const target = row * m_width + column;
+            auto const source = m_sources[target];
+            if (source < 0)
+                continue;
+            if ((column > 0 && is_near_silhouette(target, target - 1)) || (column + 1 < m_width && is_near_silhouette(target, target + 1)) ||
+                (row > 0 && is_near_silhouette(target, target - m_width)) || (row + 1 < m_height && is_near_silhouette(target, target + m_width)))
+                continue;
+            if (math::generate_random_01() < refresh_ratio)
+                continue;
+            m_colors[0][target] = framebuffer.get_red()[source];
+            m_colors[1][target] = framebuffer.get_green()[source];
+            m_colors[2][target] = framebuffer.get_blue()[source];
+            m_reprojected_surfaces[target] = m_surfaces[source];
+            m_is_reused[target] = 1;
+            reused_pixel_count++;
+        }
+    }
+    m_surfaces.swap(m_reprojected_surfaces);
+
+    // Restart the accumulation from the reprojected colors, each counting as a single sample
+    framebuffer.reset_sample_statistics();
+    for (auto index = 0; index < pixel_count; index++)
+        if (m_is_reused[index])
+            framebuffer.add_sample(index, Vec3f{m_colors[0][index], m_colors[1][index], m_colors[2][index]});
+    return reused_pixel_count;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <graphics/camera.h>
+#include <graphics/renderer/framebuffer.h>
+#include <math/vec.h>
+
+#include <array>
+#include <vector>
+
+/**
+ * @brief History of the surfaces seen through the pixels of the previous frame, used to reuse its colors when only the camera moves (temporal reprojection).
+ * Each pixel stores the world-space position, normal and reflective intensity of its first sample's hit, its color being read from the framebuffer when reprojecting.
+ * Pixels are splatted from the previous view into the new one with a depth test, then rejected if they may be wrong: disoccluded pixels receive no splat,
+ * and pixels of reflective surfaces, of surfaces facing away from the new camera, or next to a nearer surface whose silhouette may have uncovered them are discarded.
+ */
+class Reprojection_Cache
+{
+  public:
+    Reprojection_Cache() = default;
+    ~Reprojection_Cache() = default;
+    Reprojection_Cache(Reprojection_Cache const& other) = default;
+    Reprojection_Cache& operator=(Reprojection_Cache const& other) = default;
+
+    /**
+     * @brief Resizes the history, invalidating all of its pixels.
+     * @param[in] width. Width of the framebuffer, in pixels.
+     * @param[in] height. Height of the framebuffer, in pixels.
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Invalidates all pixels of the history, e.g. when the scene changes.
+     */
+    void invalidate();
+
+    /**
+     * @brief Stores the surface seen through a pixel. Different threads may store different pixels concurrently.
+     * @param[in] index. Index of the pixel.
+     * @param[in] hit. Surface data of the first intersection of the pixel's first sample.
+     */
+    void store(int index, Primary_Hit const& hit)
+    {
+        auto& surface = m_surfaces[index];
+        surface.position = hit.position;
+        surface.normal = hit.normal;
+        surface.reflective_intensity = hit.reflective_intensity;
+        surface.is_valid = (hit.object_id >= 0);
+    }
+
+    /**
+     * @brief Reprojects the colors of the framebuffer's sampled pixels to the view of a moved or turned camera, from the world-space positions of their surfaces.
+     * The framebuffer's sample statistics are reset, each reused pixel starting with its reprojected color as a single sample. The history is moved to the new view along with the colors.
+     * @param[in,out] framebuffer. Framebuffer holding the previous frame's colors on input, and the reprojected colors on output.
+     * @param[in] camera. Camera that renders the new frame.
+     * @param[in] max_reflective_intensity. Reflective intensity above which a surface's color is considered too dependent on the view direction to be reused.
+     * @param[in] refresh_ratio. Ratio of the reusable pixels traced again anyway, picked at random, so that errors of reused colors do not persist.
+     * @return The number of reused pixels, the others having no samples.
+     */
+    int reproject(Framebuffer& framebuffer, Camera const& camera, float max_reflective_intensity, float refresh_ratio);
+
+  private:
+    /**
+     * @brief Surface seen through a pixel.
+     */
+    struct Surface
+    {
+        Vec3f position = Vec3f::zero();    // World-space position of the surface
+        Vec3f normal = Vec3f::zero();      // World-space normal of the surface
+        float reflective_intensity = 0.0f; // Weight of the mirror reflection in the surface's color
+        bool is_valid = false;             // Whether the pixel stores a surface, i.e. its first sample hit an object
+    };
+
+    int m_width = 0;                             // Width of the history, in pixels
+    int m_height = 0;                            // Height of the history, in pixels
+    std::vector<Surface> m_surfaces;             // Surface seen through each pixel
+    std::vector<Surface> m_reprojected_surfaces; // Scratch array storing the surface splatted into each new pixel
+    std::vector<int> m_sources;                  // Scratch array storing the previous pixel splatted into each new pixel, or -1 if none
+    std::vector<float> m_splat_distances;        // Scratch array storing the distance from the new camera to each new pixel's splatted surface
+    std::array<std::vector<float>, 3> m_colors;  // Scratch arrays storing the red, green and blue colors splatted into each new pixel
+    std::vector<unsigned char> m_is_reused;      // Scratch array storing whether each new pixel reuses its splatted color
+};
@@ -0,0 +1,75 @@
+#include "view_shadow_cache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// Largest distance, in pixel footprints, between a point and the hits of the pixels around it that see the same surface
+auto constexpr surface_footprint_count = 4.0f;
+
+} // namespace
+
+void View_Shadow_Cache::reset(Camera const& camera, int width, int height, std::size_t light_count)
+{
+    auto const pixel_count = static_cast<std::size_t>(width) * height;
+    if (static_cast<std::size_t>(m_width) * m_height != pixel_count || !m_is_recorded)
+        m_is_recorded.reset(new std::atomic<bool>[pixel_count]);
+    for (auto index = 0u; index < pixel_count; index++)
+        m_is_recorded[index].store(false, std::memory_order_relaxed);
+    m_camera = camera;
+    m_width = width;
+    m_height = height;
+    m_light_count = light_count;
+    // A pixel spans the image plane's extent divided by the number of intervals between pixel centers, at the near distance
+    auto const pixel_width = camera.get_image_plane_width() / (std::max)(width - 1, 1);
+    auto const pixel_height = camera.get_image_plane_height() / (std::max)(height - 1, 1);
+    m_footprint_scale = (std::max)(pixel_width, pixel_height) / camera.get_near();
+    m_positions.assign(pixel_count, Vec3f::zero());
+    m_visibilities.resize(pixel_count * light_count);
+}
+
+void View_Shadow_Cache::record(int index, Vec3f const& position, Light_Sample const* lights, unsigned int count, Light const* scene_lights, float const* visibilities)
+{
+    m_positions[index] = position;
+    auto* const pixel_visibilities = m_visibilities.data() + index * m_light_count;
+    std::fill(pixel_visibilities, pixel_visibilities + m_light_count, -1.0f);
+    for (auto light_it = 0u; light_it < count; light_it++)
+        pixel_visibilities[lights[light_it].light - scene_lights] = visibilities[light_it];
+    m_is_recorded[index].store(true, std::memory_order_release);
+}
+
+bool View_Shadow_Cache::find(Vec3f const& position, Light_Sample const* lights, unsigned int count, Light const* scene_lights, float* out_visibilities) const
+{
+    // Find the four pixels whose camera rays surround the point
+    auto const view_position = m_camera.to_view_space(position);
+    if (view_position.z() <= 0.0f)
+        return false;
+    auto const near_plane = m_camera.get_near();
+    auto const first_column = static_cast<int>(std::floor((near_plane * view_position.x() / view_position.z() + 0.5f) * (m_width - 1)));
+    auto const first_row = static_cast<int>(std::floor((near_plane * view_position.y() / view_position.z() + 0.5f) * (m_height - 1)));
+    if (first_column < 0 || first_column + 1 >= m_width || first_row < 0 || first_row + 1 >= m_height)
+        return false;
+
+    // Only reuse their visibilities if all four see the same surface and agree on every light, so that the points near silhouettes and the edges of shadows
+    // trace their own shadow rays. The hits of neighbouring pixels on a slanted surface lie a few footprints apart
+    auto const tolerance = surface_footprint_count * m_footprint_scale * view_position.z();
+    auto const first_index = first_row * m_width + first_column;
+    int const indices[4] = {first_index, first_index + 1, first_index + m_width, first_index + m_width + 1};
+    for (auto const index : indices)
+        if (!m_is_recorded[index].load(std::memory_order_acquire) || (m_positions[index] - position).length() > tolerance)
+            return false;
+    for (auto light_it = 0u; light_it < count; light_it++)
+    {
+        auto const light_index = lights[light_it].light - scene_lights;
+        auto const visibility = m_visibilities[indices[0] * m_light_count + light_index];
+        if (visibility < 0.0f)
+            return false;
+        for (auto const index : indices)
+            if (m_visibilities[index * m_light_count + light_index] != visibility)
+                return false;
+        out_visibilities[light_it] = visibility;
+    }
+    return true;
+}
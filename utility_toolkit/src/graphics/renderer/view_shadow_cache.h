@@ -0,0 +1,71 @@
+#pragma once
+
+#include <graphics/camera.h>
+#include <graphics/light.h>
+#include <graphics/light_tree.h>
+#include <math/vec.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Light visibilities computed at the first hits of a view's pixels, reused at the first hits of another view that sees the same surface points,
+ * e.g. by the right eye of a stereo pair, most of whose visible points are also seen by the left eye.
+ * A point is looked up by projecting it to the recorded view, and only reuses the visibilities of the four pixels around it if all of their hits lie within a few pixel footprints of it
+ * and all of them recorded the same visibility for each of its lights. This is an approximation: silhouettes and shadow edges passing near the point are detected,
+ * but a shadow edge or a thin occluder's shadow falling between the four hits without reaching any of them is missed, and the point then takes their visibility instead of its own.
+ * Different threads may record and look up pixels concurrently, a pixel only being read once its recording is complete.
+ */
+class View_Shadow_Cache
+{
+  public:
+    View_Shadow_Cache() = default;
+    ~View_Shadow_Cache() = default;
+    View_Shadow_Cache(View_Shadow_Cache const& other) = delete;
+    View_Shadow_Cache& operator=(View_Shadow_Cache const& other) = delete;
+    View_Shadow_Cache(View_Shadow_Cache&& other) = default;
+    View_Shadow_Cache& operator=(View_Shadow_Cache&& other) = default;
+
+    /**
+     * @brief Resizes the cache for a view, invalidating all of its pixels. No pixel must be recorded or looked up concurrently.
+     * @param[in] camera. Camera of the recorded view.
+     * @param[in] width. Width of the view, in pixels.
+     * @param[in] height. Height of the view, in pixels.
+     * @param[in] light_count. Number of lights of the scene.
+     */
+    void reset(Camera const& camera, int width, int height, std::size_t light_count);
+
+    /**
+     * @brief Records the light visibilities at a pixel's first hit. Each pixel must be recorded by a single thread.
+     * @param[in] index. Index of the pixel in the view, row after row.
+     * @param[in] position. World-space position of the hit.
+     * @param[in] lights. Lights selected to shade the hit.
+     * @param[in] count. Number of selected lights.
+     * @param[in] scene_lights. First light of the scene, from which the lights' indices are taken.
+     * @param[in] visibilities. Visible fraction of each selected light.
+     */
+    void record(int index, Vec3f const& position, Light_Sample const* lights, unsigned int count, Light const* scene_lights, float const* visibilities);
+
+    /**
+     * @brief Looks up the light visibilities recorded at the first hits of the four pixels of the recorded view around a point, if they agree.
+     * @param[in] position. World-space position of the point.
+     * @param[in] lights. Lights selected to shade the point.
+     * @param[in] count. Number of selected lights.
+     * @param[in] scene_lights. First light of the scene, from which the lights' indices are taken.
+     * @param[out] out_visibilities. Visible fraction of each selected light, only written if found.
+     * @return True if the visibilities of all lights were found and agreed upon, false otherwise.
+     */
+    bool find(Vec3f const& position, Light_Sample const* lights, unsigned int count, Light const* scene_lights, float* out_visibilities) const;
+
+  private:
+    Camera m_camera;                                    // Camera of the recorded view
+    int m_width = 0;                                    // Width of the recorded view, in pixels
+    int m_height = 0;                                   // Height of the recorded view, in pixels
+    std::size_t m_light_count = 0;                      // Number of lights of the scene
+    float m_footprint_scale = 0.0f;                     // Largest extent of a pixel's footprint at a unit depth, scaled by the depth of a hit to get its tolerance
+    std::vector<Vec3f> m_positions;                     // World-space position of each pixel's first hit
+    std::vector<float> m_visibilities;                  // Visible fraction of each light of the scene at each pixel's first hit, or a negative value if the light was not selected there
+    std::unique_ptr<std::atomic<bool>[]> m_is_recorded; // Whether each pixel's recording is complete
+};
@@ -0,0 +1,72 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+
+Worker_Pool::Worker_Pool()
+    : m_thread_count{(std::max)(std::thread::hardware_concurrency(), 1u)}
+    , m_threads{}
+    , m_guard{}
+    , m_task_condition{}
+    , m_done_condition{}
+    , m_task{nullptr}
+    , m_task_generation{0}
+    , m_running_count{0}
+    , m_stop_requested{false}
+{
+}
+
+Worker_Pool::~Worker_Pool() { stop(); }
+
+void Worker_Pool::run(std::function<void(unsigned int)> const& task)
+{
+    // Start the worker threads on first use, so that renderers which never run a pass do not keep idle threads
+    if (m_threads.empty())
+    {
+        for (auto thread_it = 0u; thread_it < m_thread_count; thread_it++)
+            m_threads.push_back(std::thread(&Worker_Pool::work, this, thread_it, m_task_generation));
+    }
+
+    // Hand the task to all workers, and wait for the last one to finish it
+    std::unique_lock<std::mutex> lock{m_guard};
+    m_task = &task;
+    m_task_generation++;
+    m_running_count = m_thread_count;
+    m_task_condition.notify_all();
+    m_done_condition.wait(lock, [&]() { return m_running_count == 0; });
+    m_task = nullptr;
+}
+
+void Worker_Pool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock{m_guard};
+        m_stop_requested = true;
+    }
+    m_task_condition.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+    m_threads.clear();
+    m_stop_requested = false;
+}
+
+void Worker_Pool::work(unsigned int thread_index, std::uint64_t last_generation)
+{
+    while (true)
+    {
+        std::function<void(unsigned int)> const* task;
+        {
+            std::unique_lock<std::mutex> lock{m_guard};
+            m_task_condition.wait(lock, [&]() { return m_task_generation != last_generation || m_stop_requested; });
+            if (m_stop_requested)
+                return;
+            last_generation = m_task_generation;
+            task = m_task;
+        }
+        (*task)(thread_index);
+        {
+            std::lock_guard<std::mutex> lock{m_guard};
+            if (--m_running_count == 0)
+                m_done_condition.notify_one();
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <dll_defines.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Group of worker threads, one per core, started on first use and kept until the pool is destroyed, so that the passes of successive frames do not start and join threads each time.
+ * Each call to run hands the same task to every worker, which typically takes its share of the work from a shared counter, and returns once all of them have finished it.
+ * Worker threads keep their thread-local state between tasks.
+ */
+class Worker_Pool
+{
+  public:
+    DECLSPECIFIER Worker_Pool();
+    DECLSPECIFIER ~Worker_Pool();
+    Worker_Pool(Worker_Pool const& other) = delete;
+    Worker_Pool& operator=(Worker_Pool const& other) = delete;
+
+    /**
+     * @brief Gets the number of worker threads, i.e. the number of cores.
+     * @return The number of worker threads.
+     */
+    DECLSPECIFIER unsigned int get_thread_count() const { return m_thread_count; }
+
+    /**
+     * @brief Runs a task on every worker thread, and waits until all of them have returned. Must not be called from a task, nor by several threads at once.
+     * @param[in] task. Task to run, called with the index of the worker thread, between zero and the number of worker threads.
+     */
+    DECLSPECIFIER void run(std::function<void(unsigned int)> const& task);
+
+    /**
+     * @brief Stops the worker threads and waits for them to return, a later task starting them again. Must not be called while a task is running.
+     */
+    DECLSPECIFIER void stop();
+
+  private:
+    /**
+     * @brief Waits for the tasks handed to a worker thread and runs them, until the pool is stopped.
+     * @param[in] thread_index. Index of the worker thread.
+     * @param[in] last_generation. Generation of the last task handed to the workers before the thread started, which it does not run.
+     */
+    void work(unsigned int thread_index, std::uint64_t last_generation);
+
+    unsigned int m_thread_count;                     // Number of worker threads
+    std::vector<std::thread> m_threads;              // Worker threads, started by the first task
+    std::mutex m_guard;                              // Guard protecting the current task and the workers' progress
+    std::condition_variable m_task_condition;        // Notified when a task is handed to the workers, or when the pool is being stopped
+    std::condition_variable m_done_condition;        // Notified when the last worker has finished the current task
+    std::function<void(unsigned int)> const* m_task; // Task currently handed to the workers, or nullptr if none
+    std::uint64_t m_task_generation;                 // Incremented whenever a task is handed to the workers, so that each worker runs it once
+    unsigned int m_running_count;                    // Number of workers that have not finished the current task yet
+    bool m_stop_requested;                           // Whether the pool is being stopped, so that the workers return
+};
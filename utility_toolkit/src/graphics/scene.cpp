@@ -4,7 +4,10 @@
 #include <geometry/sphere.h>
 #include <graphics/material.h>
 
+#include <algorithm>
 #include <memory>
+#include <random>
+#include <utility>
 
 void Scene::setup_default_scene()
 {
@@ -61,4 +64,72 @@ void Scene::setup_default_scene()
     m_lights.push_back(top_light);
     m_lights.push_back(left_light);
     m_lights.push_back(right_light);
+
+    // Build the light tree over the final list of lights
+    m_light_tree.build(m_lights, m_light_radiance_threshold);
+    m_changes.is_global = true;
+}
+
+void Scene::setup_sphere_field(std::size_t sphere_count)
+{
+    // Scatter the spheres in a cube in front of the origin, from a fixed seed so that every run measures the same scene
+    auto const field_half_size = 50.0f;
+    auto const field_center = Vec3f{0.0f, 0.0f, 60.0f};
+    auto const sphere_radius = 0.3f;
+    std::mt19937 random_engine{0};
+    std::uniform_real_distribution<float> offset_distribution{-field_half_size, field_half_size};
+    std::vector<std::shared_ptr<geometry::Primitive>> spheres;
+    spheres.reserve(sphere_count);
+    for (auto sphere_it = std::size_t{0}; sphere_it < sphere_count; sphere_it++)
+    {
+        auto const offset = Vec3f{offset_distribution(random_engine), offset_distribution(random_engine), offset_distribution(random_engine)};
+        spheres.push_back(std::make_shared<geometry::Sphere>(field_center + offset, sphere_radius));
+    }
+    std::shuffle(spheres.begin(), spheres.end(), random_engine);
+    auto const material = Material{Vec3f::one(), Vec3f::zero(), 0.5f * Vec3f::one()};
+    m_objects.clear();
+    m_objects.reserve(sphere_count);
+    for (auto const& sphere : spheres)
+        m_objects.push_back(Object{"Sphere", sphere, material});
+
+    // Light the field from the origin
+    m_lights.clear();
+    m_lights.push_back(Light{Light_Type::point, 1.0f, Vec3f::zero()});
+    m_light_tree.build(m_lights, m_light_radiance_threshold);
+    m_changes.is_global = true;
+}
+
+void Scene::set_light_selection(Light_Selection_Mode mode, float radiance_threshold, unsigned int sample_count)
+{
+    m_light_selection_mode = mode;
+    m_light_radiance_threshold = radiance_threshold;
+    m_light_sample_count = (std::max)(sample_count, 1u);
+    m_light_tree.build(m_lights, m_light_radiance_threshold);
+    m_changes.is_global = true;
+}
+
+void Scene::set_object_material(std::size_t index, Material const& material)
+{
+    m_objects[index].set_material(material);
+    m_changes.shaded_objects.push_back(index);
+}
+
+void Scene::set_object_primitive(std::size_t index, std::shared_ptr<geometry::Primitive> const& primitive)
+{
+    m_objects[index].set_primitive(primitive);
+    m_changes.moved_objects.push_back(index);
+}
+
+void Scene::set_light(std::size_t index, Light const& light)
+{
+    m_lights[index] = light;
+    m_light_tree.build(m_lights, m_light_radiance_threshold);
+    m_changes.lights.push_back(index);
+}
+
+Scene_Changes Scene::take_changes()
+{
+    Scene_Changes changes;
+    std::swap(changes, m_changes);
+    return changes;
 }
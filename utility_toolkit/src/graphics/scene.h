@@ -1,27 +1,98 @@
 #pragma once
 
 #include <graphics/light.h>
+#include <graphics/light_tree.h>
 #include <graphics/object.h>
 
+#include <cstddef>
 #include <vector>
 
+/**
+ * @brief Objects and lights modified since the scene's changes were last taken, from which renderers find the pixels that must be rendered again.
+ */
+struct Scene_Changes
+{
+    std::vector<std::size_t> shaded_objects; // Indices of the objects whose material changed
+    std::vector<std::size_t> moved_objects;  // Indices of the objects whose geometry changed
+    std::vector<std::size_t> lights;         // Indices of the lights that changed
+    bool is_global = false;                  // Whether a change may affect every pixel, e.g. a new light selection strategy or a new set of objects
+
+    bool empty() const { return shaded_objects.empty() && moved_objects.empty() && lights.empty() && !is_global; }
+};
+
 class Scene
 {
   public:
     Scene() = default;
     ~Scene() = default;
-    Scene(Scene const& other) = default;
-    Scene& operator=(Scene const& other) = default;
+    Scene(Scene const& other) = delete;
+    Scene& operator=(Scene const& other) = delete;
 
     std::vector<Object> const& get_objects() const { return m_objects; }
     std::vector<Light> const& get_lights() const { return m_lights; }
+    Light_Selection_Mode get_light_selection_mode() const { return m_light_selection_mode; }
+    float get_light_radiance_threshold() const { return m_light_radiance_threshold; }
 
     /**
      * @brief Sets up a default scene, with a grid of spheres and a point light.
      */
     void setup_default_scene();
 
+    /**
+     * @brief Sets up a field of small spheres scattered in front of the origin, lit by a point light at the origin, e.g. to measure traversal on a scene too large for the caches.
+     * The spheres are added in a random order, so that consecutive objects point to primitives that are distant in memory, as in large assets.
+     * @param[in] sphere_count. Number of spheres.
+     */
+    void setup_sphere_field(std::size_t sphere_count);
+
+    /**
+     * @brief Sets the strategy used to select the lights evaluated in each surface point, and rebuilds the light tree accordingly.
+     * @param[in] mode. Selection strategy.
+     * @param[in] radiance_threshold. Radiance below which a light's contribution is considered negligible (used by the culled mode).
+     * @param[in] sample_count. Number of lights to sample in each point (used by the stochastic mode).
+     */
+    void set_light_selection(Light_Selection_Mode mode, float radiance_threshold = 0.0f, unsigned int sample_count = 1);
+
+    /**
+     * @brief Selects the lights whose contribution to compute in the given point, according to the current light selection strategy.
+     * @param[in] point_position. World-space position of the surface point.
+     * @param[out] out_samples. Selected lights and their weights.
+     */
+    void select_lights(Vec3f const& point_position, std::vector<Light_Sample>& out_samples) const { m_light_tree.select_lights(point_position, m_light_selection_mode, m_light_sample_count, out_samples); }
+
+    /**
+     * @brief Replaces the material of an object, e.g. while editing the look of the scene.
+     * @param[in] index. Index of the object.
+     * @param[in] material. New material of the object.
+     */
+    void set_object_material(std::size_t index, Material const& material);
+
+    /**
+     * @brief Replaces the geometry of an object, e.g. to move it.
+     * @param[in] index. Index of the object.
+     * @param[in] primitive. New geometry of the object.
+     */
+    void set_object_primitive(std::size_t index, std::shared_ptr<geometry::Primitive> const& primitive);
+
+    /**
+     * @brief Replaces a light, and rebuilds the light tree accordingly.
+     * @param[in] index. Index of the light.
+     * @param[in] light. New light.
+     */
+    void set_light(std::size_t index, Light const& light);
+
+    /**
+     * @brief Takes the changes made to the scene since they were last taken.
+     * @return The objects and lights modified in the meantime.
+     */
+    Scene_Changes take_changes();
+
   private:
-    std::vector<Object> m_objects; // List of objects that compose the scene's geometry
-    std::vector<Light> m_lights;   // List of lights that compose the scene's lighting
+    std::vector<Object> m_objects;                                          // List of objects that compose the scene's geometry
+    std::vector<Light> m_lights;                                            // List of lights that compose the scene's lighting
+    Light_Tree m_light_tree;                                                // Hierarchy built over the lights, pointing into the list of lights
+    Light_Selection_Mode m_light_selection_mode{Light_Selection_Mode::all}; // Strategy used to select the lights evaluated in each surface point
+    float m_light_radiance_threshold{0.0f};                                 // Radiance below which a light's contribution is considered negligible
+    unsigned int m_light_sample_count{1};                                   // Number of lights sampled in each point in the stochastic mode
+    Scene_Changes m_changes;                                                // Changes made to the scene since they were last taken
 };
@@ -0,0 +1,15 @@
+#include "texture.h"
+
+#include <graphics/texture_tile_cache.h>
+
+Texture::Texture(std::string const& filepath)
+    : m_color{Vec3f::zero()}
+    , m_tiled_texture_id{-1}
+{
+    Tiled_Texture_Header header;
+    m_tiled_texture_id = Texture_Tile_Cache::get_instance().register_texture(filepath, header);
+    if (m_tiled_texture_id >= 0)
+        m_color = Vec3f{header.average_color[0], header.average_color[1], header.average_color[2]};
+}
+
+Vec3f Texture::sample_tiled(Vec2f const& uv, unsigned int mip_level) const { return Texture_Tile_Cache::get_instance().sample(m_tiled_texture_id, uv, mip_level, m_color); }
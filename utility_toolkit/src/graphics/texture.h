@@ -2,16 +2,51 @@
 
 #include <math/vec.h>
 
+#include <string>
+
 class Texture
 {
   public:
-    Texture(Vec3f tmp)
-        : m_tmp{tmp}
+    /**
+     * @brief Creates a texture with the same color at every coordinate.
+     * @param[in] color. The color of the texture.
+     */
+    Texture(Vec3f const& color)
+        : m_color{color}
+        , m_tiled_texture_id{-1}
     {
     }
 
-    Vec3f sample(Vec2f uv) const { return m_tmp; }
+    /**
+     * @brief Creates a texture backed by a tiled texture file, whose tiles are paged in on demand through the texture tile cache.
+     * If the file cannot be opened, the texture falls back to a constant black color.
+     * @param[in] filepath. Path to the tiled texture file (including extension).
+     */
+    explicit Texture(std::string const& filepath);
+
+    /**
+     * @brief Checks whether the texture has the same color at every coordinate.
+     * @return True if the texture is constant, false if it is backed by a tiled texture file.
+     */
+    bool is_constant() const { return m_tiled_texture_id < 0; }
+
+    /**
+     * @brief Samples the texture at the given coordinates.
+     * @param[in] uv. Texture coordinates.
+     * @param[in] mip_level. (Optional) Mip level at which to sample tiled textures.
+     * @return The sampled color.
+     */
+    Vec3f sample(Vec2f const& uv, unsigned int mip_level = 0) const { return is_constant() ? m_color : sample_tiled(uv, mip_level); }
 
   private:
-    Vec3f m_tmp; // TODO
+    /**
+     * @brief Samples the tiled texture file backing this texture through the texture tile cache.
+     * @param[in] uv. Texture coordinates.
+     * @param[in] mip_level. Mip level at which to sample.
+     * @return The sampled color.
+     */
+    Vec3f sample_tiled(Vec2f const& uv, unsigned int mip_level) const;
+
+    Vec3f m_color;          // Color of a constant texture, or average color of a tiled texture (used when its tiles cannot be loaded)
+    int m_tiled_texture_id; // Identifier of the tiled texture file in the texture tile cache, or -1 for constant textures
 };
@@ -0,0 +1,420 @@
+#include "texture_tile_cache.h"
+
+#include <filesystem/resource_manager.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <new>
+
+namespace
+{
+
+auto constexpr max_texture_count = 4096u;                        // Maximum number of registered textures (the texture identifier is stored on 16 bits of a tile key)
+auto constexpr default_budget_in_bytes = std::size_t{256} << 20; // Default memory budget of the shared cache
+auto constexpr micro_cache_size = 8u;                            // Number of tiles kept in each thread's micro-cache
+
+/**
+ * @brief Builds the key identifying a tile in the cache.
+ * @param[in] texture_id. Identifier of the texture.
+ * @param[in] mip_level. Mip level of the tile.
+ * @param[in] tile_index. Index of the tile within its mip level.
+ * @return The key, as a 64-bit integer.
+ */
+std::uint64_t compute_tile_key(int texture_id, unsigned int mip_level, std::uint64_t tile_index) { return (static_cast<std::uint64_t>(texture_id) << 48) | (static_cast<std::uint64_t>(mip_level & 0xFF) << 40) | (tile_index & 0xFFFFFFFFFFull); }
+
+/**
+ * @brief Wraps a texture coordinate to the 0-1 range.
+ * @param[in] coordinate. The texture coordinate.
+ * @return The wrapped coordinate.
+ */
+float wrap_01(float coordinate) { return coordinate - std::floor(coordinate); }
+
+struct Micro_Cache;
+
+/**
+ * @brief Gets the micro-caches of all running threads, whose hits are added to the statistics when they are read.
+ * @param[out] out_guard. Guard protecting the list.
+ * @return The list of micro-caches.
+ */
+std::vector<Micro_Cache*>& get_micro_caches(std::mutex*& out_guard)
+{
+    static std::mutex guard;
+    static std::vector<Micro_Cache*> micro_caches;
+    out_guard = &guard;
+    return micro_caches;
+}
+
+/**
+ * @brief Small direct-mapped cache of recently used tiles, owned by a single thread.
+ * Its hits are counted without touching the shared counter, which only receives them when the thread exits or starts using another cache.
+ */
+struct Micro_Cache
+{
+    Micro_Cache()
+    {
+        std::mutex* guard;
+        auto& micro_caches = get_micro_caches(guard);
+        std::lock_guard<std::mutex> lock{*guard};
+        micro_caches.push_back(this);
+    }
+
+    ~Micro_Cache()
+    {
+        std::mutex* guard;
+        auto& micro_caches = get_micro_caches(guard);
+        std::lock_guard<std::mutex> lock{*guard};
+        micro_caches.erase(std::find(micro_caches.begin(), micro_caches.end(), this));
+        if (owner_hits != nullptr)
+            *owner_hits += pending_hits.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Counts a hit of the micro-cache. Only called by the owning thread.
+     */
+    void add_hit() { pending_hits.store(pending_hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    std::uint64_t keys[micro_cache_size] = {};                               // Keys of the cached tiles
+    std::shared_ptr<Texture_Tile_Cache::Tile const> tiles[micro_cache_size]; // Cached tiles
+    Texture_Tile_Cache const* owner = nullptr;                               // Cache whose tiles are held, or nullptr if none was used yet
+    std::atomic<std::uint64_t>* owner_hits = nullptr;                        // Shared hit counter of the owner, which receives the pending hits
+    std::atomic<std::uint64_t> pending_hits{0};                              // Hits not yet added to the owner's counter, written by the owning thread only
+};
+
+thread_local Micro_Cache t_micro_cache;
+
+} // namespace
+
+Texture_Tile_Cache::Texture_Tile_Cache()
+    : m_textures{}
+    , m_texture_count{0}
+    , m_guard{}
+    , m_index{}
+    , m_slots{}
+    , m_free_slots{}
+    , m_clock_hand{0}
+    , m_budget_in_bytes{default_budget_in_bytes}
+    , m_resident_bytes{0}
+    , m_hits{0}
+    , m_misses{0}
+    , m_evictions{0}
+    , m_failed_loads{0}
+{
+    // Reserve all texture entries upfront so that registering a texture never moves the entries being read by sampling threads
+    m_textures.reserve(max_texture_count);
+}
+
+Texture_Tile_Cache::~Texture_Tile_Cache()
+{
+    {
+        // Stop the micro-caches of the running threads from handing their hits over to this cache
+        std::mutex* guard;
+        auto& micro_caches = get_micro_caches(guard);
+        std::lock_guard<std::mutex> lock{*guard};
+        for (auto* micro_cache : micro_caches)
+            if (micro_cache->owner_hits == &m_hits)
+                micro_cache->owner_hits = nullptr;
+    }
+    for (auto const& texture : m_textures)
+        Resource_Manager::get_instance().close_file(texture.file_handle);
+}
+
+int Texture_Tile_Cache::register_texture(std::string const& filepath, Tiled_Texture_Header& out_header)
+{
+    auto& resource_manager = Resource_Manager::get_instance();
+    auto const file_handle = resource_manager.open_file_for_random_access(filepath);
+    if (file_handle < 0)
+        return -1;
+
+    // Read and validate the header
+    Texture_File texture;
+    texture.file_handle = file_handle;
+    auto const& header = texture.header;
+    auto const is_valid = resource_manager.read_file_range(file_handle, 0, sizeof(Tiled_Texture_Header), &texture.header) && std::equal(header.magic, header.magic + 4, Tiled_Texture_Header{}.magic) && header.width > 0 &&
+                          header.height > 0 && header.tile_size > 0 && header.mip_count > 0 && header.mip_count <= 32;
+    if (!is_valid)
+    {
+        resource_manager.close_file(file_handle);
+        return -1;
+    }
+
+    // Precompute the layout of each mip level in the file
+    auto const tile_bytes = std::uint64_t{header.tile_size} * header.tile_size * 3 * sizeof(float);
+    auto level_offset = std::uint64_t{sizeof(Tiled_Texture_Header)};
+    for (auto level = 0u; level < header.mip_count; level++)
+    {
+        auto const level_width = (std::max)(1u, header.width >> level);
+        auto const level_height = (std::max)(1u, header.height >> level);
+        auto const tiles_x = (level_width + header.tile_size - 1) / header.tile_size;
+        auto const tiles_y = (level_height + header.tile_size - 1) / header.tile_size;
+        texture.level_offsets.push_back(level_offset);
+        texture.level_tiles_x.push_back(tiles_x);
+        texture.level_widths.push_back(level_width);
+        texture.level_heights.push_back(level_height);
+        level_offset += std::uint64_t{tiles_x} * tiles_y * tile_bytes;
+    }
+
+    // Register the texture
+    std::lock_guard<std::mutex> lock{m_guard};
+    if (m_textures.size() >= max_texture_count)
+    {
+        resource_manager.close_file(file_handle);
+        return -1;
+    }
+    out_header = header;
+    m_textures.push_back(texture);
+    m_texture_count = static_cast<int>(m_textures.size());
+    return m_texture_count - 1;
+}
+
+Vec3f Texture_Tile_Cache::sample(int texture_id, Vec2f const& uv, unsigned int mip_level, Vec3f const& fallback_color)
+{
+    if (texture_id < 0 || texture_id >= m_texture_count)
+        return fallback_color;
+    auto const& texture = m_textures[texture_id];
+    auto const& header = texture.header;
+    auto const u = wrap_01(uv.x());
+    auto const v = wrap_01(uv.y());
+
+    // Try the requested level first, then coarser ones if its tile cannot be loaded
+    for (auto level = (std::min)(mip_level, header.mip_count - 1); level < header.mip_count; level++)
+    {
+        auto const level_width = texture.level_widths[level];
+        auto const level_height = texture.level_heights[level];
+        auto const x = (std::min)(static_cast<std::uint32_t>(u * level_width), level_width - 1);
+        auto const y = (std::min)(static_cast<std::uint32_t>((1.0f - v) * level_height), level_height - 1);
+        auto const tile_index = std::uint64_t{y / header.tile_size} * texture.level_tiles_x[level] + (x / header.tile_size);
+        auto const tile = get_tile(texture, compute_tile_key(texture_id, level, tile_index), level, tile_index);
+        if (tile != nullptr)
+        {
+            auto const texel_index = 3 * ((y % header.tile_size) * header.tile_size + (x % header.tile_size));
+            return Vec3f{tile->texels[texel_index], tile->texels[texel_index + 1], tile->texels[texel_index + 2]};
+        }
+        m_failed_loads++;
+    }
+    return fallback_color;
+}
+
+void Texture_Tile_Cache::set_memory_budget(std::size_t budget_in_bytes)
+{
+    std::lock_guard<std::mutex> lock{m_guard};
+    m_budget_in_bytes = budget_in_bytes;
+    make_room_for(0);
+}
+
+Texture_Tile_Cache_Statistics Texture_Tile_Cache::get_statistics() const
+{
+    Texture_Tile_Cache_Statistics statistics;
+    statistics.hits = m_hits;
+    {
+        // Add the hits still pending in the micro-caches of the running threads
+        std::mutex* guard;
+        auto const& micro_caches = get_micro_caches(guard);
+        std::lock_guard<std::mutex> lock{*guard};
+        for (auto const* micro_cache : micro_caches)
+            if (micro_cache->owner == this)
+                statistics.hits += micro_cache->pending_hits.load(std::memory_order_relaxed);
+    }
+    statistics.misses = m_misses;
+    statistics.evictions = m_evictions;
+    statistics.failed_loads = m_failed_loads;
+    statistics.resident_bytes = m_resident_bytes;
+    return statistics;
+}
+
+std::shared_ptr<Texture_Tile_Cache::Tile const> Texture_Tile_Cache::get_tile(Texture_File const& texture, std::uint64_t key, unsigned int mip_level, std::uint64_t tile_index)
+{
+    // Look for the tile in the calling thread's micro-cache, without taking the shared lock
+    auto& micro_cache = t_micro_cache;
+    if (micro_cache.owner != this)
+    {
+        // Hand the hits counted for the previous cache over to it, and drop its tiles
+        {
+            std::mutex* guard;
+            get_micro_caches(guard);
+            std::lock_guard<std::mutex> lock{*guard};
+            if (micro_cache.owner_hits != nullptr)
+                *micro_cache.owner_hits += micro_cache.pending_hits.load(std::memory_order_relaxed);
+            micro_cache.pending_hits.store(0, std::memory_order_relaxed);
+            micro_cache.owner = this;
+            micro_cache.owner_hits = &m_hits;
+        }
+        for (auto& micro_cache_tile : micro_cache.tiles)
+            micro_cache_tile = nullptr;
+    }
+    auto const micro_cache_index = (key ^ (key >> 40)) % micro_cache_size;
+    auto& micro_cache_tile = micro_cache.tiles[micro_cache_index];
+    if (micro_cache_tile != nullptr && micro_cache.keys[micro_cache_index] == key)
+    {
+        micro_cache_tile->referenced.store(true, std::memory_order_relaxed);
+        micro_cache.add_hit();
+        return micro_cache_tile;
+    }
+
+    // Look for the tile in the shared cache
+    {
+        std::lock_guard<std::mutex> lock{m_guard};
+        auto const it = m_index.find(key);
+        if (it != m_index.end())
+        {
+            auto const& tile = m_slots[it->second].tile;
+            tile->referenced.store(true, std::memory_order_relaxed);
+            m_hits++;
+            micro_cache.keys[micro_cache_index] = key;
+            micro_cache_tile = tile;
+            return tile;
+        }
+    }
+
+    // Read the tile from disk, outside of the lock so that other threads can keep sampling resident tiles
+    m_misses++;
+    auto const tile_size = texture.header.tile_size;
+    auto const tile_bytes = std::size_t{tile_size} * tile_size * 3 * sizeof(float);
+    if (tile_bytes > m_budget_in_bytes)
+        return nullptr;
+    std::shared_ptr<Tile> loaded_tile;
+    try
+    {
+        loaded_tile = std::make_shared<Tile>();
+        loaded_tile->texels.resize(std::size_t{tile_size} * tile_size * 3);
+    }
+    catch (std::bad_alloc const&)
+    {
+        return nullptr;
+    }
+    auto const tile_offset = texture.level_offsets[mip_level] + tile_index * tile_bytes;
+    if (!Resource_Manager::get_instance().read_file_range(texture.file_handle, tile_offset, tile_bytes, loaded_tile->texels.data()))
+        return nullptr;
+
+    // Insert the tile in the shared cache, unless another thread loaded it in the meantime
+    std::shared_ptr<Tile const> tile = loaded_tile;
+    {
+        std::lock_guard<std::mutex> lock{m_guard};
+        auto const it = m_index.find(key);
+        if (it != m_index.end())
+        {
+            tile = m_slots[it->second].tile;
+        }
+        else if (make_room_for(tile_bytes))
+        {
+            auto slot_index = m_slots.size();
+            if (!m_free_slots.empty())
+            {
+                slot_index = m_free_slots.back();
+                m_free_slots.pop_back();
+            }
+            else
+            {
+                m_slots.push_back(Slot{});
+            }
+            m_slots[slot_index] = Slot{key, tile};
+            m_index[key] = slot_index;
+            m_resident_bytes += tile_bytes;
+        }
+        // If the budget was lowered in the meantime and there is no room, the tile is only kept by the micro-cache
+    }
+    micro_cache.keys[micro_cache_index] = key;
+    micro_cache_tile = tile;
+    return tile;
+}
+
+bool Texture_Tile_Cache::make_room_for(std::size_t required_bytes)
+{
+    if (required_bytes > m_budget_in_bytes)
+        return false;
+    while (m_resident_bytes + required_bytes > m_budget_in_bytes && !m_index.empty())
+    {
+        // Advance the CLOCK hand, giving a second chance to tiles that were referenced since the last pass
+        auto const slot_index = m_clock_hand;
+        m_clock_hand = (m_clock_hand + 1) % m_slots.size();
+        auto& slot = m_slots[slot_index];
+        if (slot.tile == nullptr || slot.tile->referenced.exchange(false, std::memory_order_relaxed))
+            continue;
+        // Evict the tile
+        m_resident_bytes -= slot.tile->texels.size() * sizeof(float);
+        m_index.erase(slot.key);
+        slot.tile.reset();
+        m_free_slots.push_back(slot_index);
+        m_evictions++;
+    }
+    return (m_resident_bytes + required_bytes <= m_budget_in_bytes);
+}
+
+bool Texture_Tile_Cache::write_tiled_texture_file(std::string const& filepath, unsigned int width, unsigned int height, std::vector<Vec3f> const& texels, unsigned int tile_size)
+{
+    if (width == 0 || height == 0 || tile_size == 0 || texels.size() < std::size_t{width} * height)
+        return false;
+    std::ofstream file(filepath, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    // Build the mip chain by averaging blocks of 2x2 texels
+    std::vector<std::vector<Vec3f>> levels{texels};
+    std::vector<std::pair<unsigned int, unsigned int>> level_sizes{{width, height}};
+    while (level_sizes.back().first > 1 || level_sizes.back().second > 1)
+    {
+        auto const& previous = levels.back();
+        auto const previous_width = level_sizes.back().first;
+        auto const previous_height = level_sizes.back().second;
+        auto const level_width = (std::max)(1u, previous_width / 2);
+        auto const level_height = (std::max)(1u, previous_height / 2);
+        std::vector<Vec3f> level(std::size_t{level_width} * level_height, Vec3f::zero());
+        for (auto y = 0u; y < level_height; y++)
+        {
+            for (auto x = 0u; x < level_width; x++)
+            {
+                auto const x0 = (std::min)(2 * x, previous_width - 1);
+                auto const x1 = (std::min)(2 * x + 1, previous_width - 1);
+                auto const y0 = (std::min)(2 * y, previous_height - 1);
+                auto const y1 = (std::min)(2 * y + 1, previous_height - 1);
+                auto const sum = previous[y0 * previous_width + x0] + previous[y0 * previous_width + x1] + previous[y1 * previous_width + x0] + previous[y1 * previous_width + x1];
+                level[y * level_width + x] = sum * 0.25f;
+            }
+        }
+        levels.push_back(std::move(level));
+        level_sizes.push_back({level_width, level_height});
+    }
+
+    // Write the header
+    Tiled_Texture_Header header;
+    header.width = width;
+    header.height = height;
+    header.tile_size = tile_size;
+    header.mip_count = static_cast<std::uint32_t>(levels.size());
+    auto const& average_color = levels.back()[0];
+    header.average_color[0] = average_color.x();
+    header.average_color[1] = average_color.y();
+    header.average_color[2] = average_color.z();
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    // Write the tiles of each level, padding border tiles by repeating the last row and column
+    std::vector<float> tile(std::size_t{tile_size} * tile_size * 3);
+    for (auto level = 0u; level < levels.size(); level++)
+    {
+        auto const level_width = level_sizes[level].first;
+        auto const level_height = level_sizes[level].second;
+        auto const tiles_x = (level_width + tile_size - 1) / tile_size;
+        auto const tiles_y = (level_height + tile_size - 1) / tile_size;
+        for (auto tile_y = 0u; tile_y < tiles_y; tile_y++)
+        {
+            for (auto tile_x = 0u; tile_x < tiles_x; tile_x++)
+            {
+                for (auto y = 0u; y < tile_size; y++)
+                {
+                    for (auto x = 0u; x < tile_size; x++)
+                    {
+                        auto const source_x = (std::min)(tile_x * tile_size + x, level_width - 1);
+                        auto const source_y = (std::min)(tile_y * tile_size + y, level_height - 1);
+                        auto const& texel = levels[level][source_y * level_width + source_x];
+                        auto const tile_texel_index = 3 * (y * tile_size + x);
+                        tile[tile_texel_index] = texel.x();
+                        tile[tile_texel_index + 1] = texel.y();
+                        tile[tile_texel_index + 2] = texel.z();
+                    }
+                }
+                file.write(reinterpret_cast<char const*>(tile.data()), tile.size() * sizeof(float));
+            }
+        }
+    }
+    return file.good();
+}
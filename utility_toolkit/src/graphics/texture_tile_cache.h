@@ -0,0 +1,170 @@
+#pragma once
+
+#include <math/vec.h>
+
+#include <dll_defines.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Tiled texture files (.ttx) store an RGB float texture and its full mip chain, split into square tiles so that they can be paged in independently :
+ * - a header (see Tiled_Texture_Header),
+ * - then, for each mip level from the finest to the coarsest, the level's tiles in row-major order.
+ * Each tile stores tile_size * tile_size RGB texels in row-major order, tiles on the right and bottom borders being padded to the full tile size.
+ */
+
+/**
+ * @brief Header placed at the start of each tiled texture file.
+ */
+struct Tiled_Texture_Header
+{
+    char magic[4] = {'T', 'T', 'X', '1'}; // File identifier
+    std::uint32_t width = 0;              // Width of the finest mip level, in texels
+    std::uint32_t height = 0;             // Height of the finest mip level, in texels
+    std::uint32_t tile_size = 0;          // Width and height of a tile, in texels
+    std::uint32_t mip_count = 0;          // Number of mip levels stored in the file
+    float average_color[3] = {0, 0, 0};   // Average color of the texture, used when no tile can be loaded
+};
+
+/**
+ * @brief Snapshot of the counters of the tile cache.
+ */
+struct Texture_Tile_Cache_Statistics
+{
+    std::uint64_t hits = 0;           // Number of tile lookups served from memory (including per-thread micro-caches)
+    std::uint64_t misses = 0;         // Number of tile lookups that required reading from disk
+    std::uint64_t evictions = 0;      // Number of tiles evicted to stay within the memory budget
+    std::uint64_t failed_loads = 0;   // Number of tile lookups that fell back to a coarser level because the tile could not be loaded
+    std::uint64_t resident_bytes = 0; // Number of bytes currently held by the shared cache
+};
+
+/**
+ * @brief Fixed-budget, thread-safe cache of texture tiles, paged in on demand from tiled texture files.
+ * Tiles are evicted using the CLOCK algorithm. Each thread also keeps a small micro-cache of its most recently used tiles, so that hits do not take the shared lock.
+ * Tiles referenced by micro-caches stay alive after being evicted from the shared cache, so the actual memory use is bounded by the budget plus the micro-caches' capacity.
+ */
+class Texture_Tile_Cache
+{
+  public:
+    DECLSPECIFIER static Texture_Tile_Cache& get_instance()
+    {
+        static Texture_Tile_Cache global_tile_cache{};
+        return global_tile_cache;
+    }
+
+    DECLSPECIFIER ~Texture_Tile_Cache();
+    Texture_Tile_Cache(Texture_Tile_Cache const& other) = delete;
+    Texture_Tile_Cache& operator=(Texture_Tile_Cache const& other) = delete;
+
+    /**
+     * @brief Opens the tiled texture file at the given path and registers it for sampling.
+     * @param[in] filepath. Path to the tiled texture file (including extension).
+     * @param[out] out_header. Header read from the file.
+     * @return The identifier of the registered texture, or -1 if the file could not be opened or is not a valid tiled texture file.
+     */
+    DECLSPECIFIER int register_texture(std::string const& filepath, Tiled_Texture_Header& out_header);
+
+    /**
+     * @brief Samples a registered texture with nearest filtering. Falls back to coarser mip levels, and ultimately to the given fallback color, if tiles cannot be loaded.
+     * @param[in] texture_id. Identifier returned by register_texture.
+     * @param[in] uv. Texture coordinates, wrapped to the 0-1 range.
+     * @param[in] mip_level. Mip level at which to sample.
+     * @param[in] fallback_color. Color to return if no tile covering the given coordinates can be loaded.
+     * @return The sampled color.
+     */
+    DECLSPECIFIER Vec3f sample(int texture_id, Vec2f const& uv, unsigned int mip_level, Vec3f const& fallback_color);
+
+    /**
+     * @brief Sets the maximum number of bytes the shared cache may hold, evicting tiles if needed.
+     * @param[in] budget_in_bytes. The new memory budget.
+     */
+    DECLSPECIFIER void set_memory_budget(std::size_t budget_in_bytes);
+
+    /**
+     * @brief Gets a snapshot of the hit, miss and eviction counters.
+     * @return The cache statistics.
+     */
+    DECLSPECIFIER Texture_Tile_Cache_Statistics get_statistics() const;
+
+    /**
+     * @brief Writes an RGB float texture and its mip chain to a tiled texture file.
+     * @param[in] filepath. Path of the file to write (including extension).
+     * @param[in] width. Width of the texture, in texels.
+     * @param[in] height. Height of the texture, in texels.
+     * @param[in] texels. Texels of the texture in row-major order, starting from the top row.
+     * @param[in] tile_size. Width and height of a tile, in texels.
+     * @return True if the file was written successfully, false otherwise.
+     */
+    DECLSPECIFIER static bool write_tiled_texture_file(std::string const& filepath, unsigned int width, unsigned int height, std::vector<Vec3f> const& texels, unsigned int tile_size = 64);
+
+    /**
+     * @brief A tile of texels, shared between the cache and the micro-caches that reference it.
+     */
+    struct Tile
+    {
+        std::vector<float> texels;                  // RGB texels in row-major order
+        mutable std::atomic<bool> referenced{true}; // CLOCK reference bit, set on each access
+    };
+
+  private:
+    Texture_Tile_Cache();
+
+    /**
+     * @brief Description of a registered tiled texture file.
+     */
+    struct Texture_File
+    {
+        std::intptr_t file_handle;                // Handle of the file opened for random access
+        Tiled_Texture_Header header;              // Header of the file
+        std::vector<std::uint64_t> level_offsets; // Offset in the file of the first tile of each mip level
+        std::vector<std::uint32_t> level_tiles_x; // Number of tiles along the horizontal axis for each mip level
+        std::vector<std::uint32_t> level_widths;  // Width of each mip level, in texels
+        std::vector<std::uint32_t> level_heights; // Height of each mip level, in texels
+    };
+
+    /**
+     * @brief Entry of the CLOCK ring of the shared cache.
+     */
+    struct Slot
+    {
+        std::uint64_t key;                // Key of the cached tile
+        std::shared_ptr<Tile const> tile; // Cached tile, or nullptr if the slot is free
+    };
+
+    /**
+     * @brief Gets the tile with the given key, from the calling thread's micro-cache, the shared cache, or disk.
+     * @param[in] texture. Registered texture to which the tile belongs.
+     * @param[in] key. Key identifying the texture, mip level and tile.
+     * @param[in] mip_level. Mip level of the tile.
+     * @param[in] tile_index. Index of the tile within its mip level.
+     * @return The tile, or nullptr if it could not be loaded.
+     */
+    std::shared_ptr<Tile const> get_tile(Texture_File const& texture, std::uint64_t key, unsigned int mip_level, std::uint64_t tile_index);
+
+    /**
+     * @brief Evicts tiles, following the CLOCK algorithm, until the given number of bytes fits in the budget. The shared lock must be held.
+     * @param[in] required_bytes. Number of bytes to make room for.
+     * @return True if there is enough room, false if the budget cannot accommodate the given number of bytes.
+     */
+    bool make_room_for(std::size_t required_bytes);
+
+    std::vector<Texture_File> m_textures;                   // Registered tiled texture files
+    std::atomic<int> m_texture_count;                       // Number of registered textures that can be safely read without the lock
+    std::mutex m_guard;                                     // Guard protecting the shared cache and the list of registered textures
+    std::unordered_map<std::uint64_t, std::size_t> m_index; // Maps each cached tile's key to its slot in the CLOCK ring
+    std::vector<Slot> m_slots;                              // CLOCK ring of cached tiles
+    std::vector<std::size_t> m_free_slots;                  // Indices of free slots in the CLOCK ring
+    std::size_t m_clock_hand;                               // Current position of the CLOCK hand in the ring
+    std::atomic<std::size_t> m_budget_in_bytes;             // Maximum number of bytes the shared cache may hold
+    std::atomic<std::size_t> m_resident_bytes;              // Number of bytes currently held by the shared cache
+    std::atomic<std::uint64_t> m_hits;                      // Number of lookups served from memory, except those still pending in the micro-caches of running threads
+    std::atomic<std::uint64_t> m_misses;                    // Number of lookups that required reading from disk
+    std::atomic<std::uint64_t> m_evictions;                 // Number of evicted tiles
+    std::atomic<std::uint64_t> m_failed_loads;              // Number of tiles that could not be loaded
+};
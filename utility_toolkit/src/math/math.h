@@ -36,12 +36,12 @@ static float distance_epsilon(float base, float exponent = 1.0f, float mult_fact
 
 /**
  * @brief Generates a random floating point number in range [0,1[.
+ * Each thread uses its own random engine, seeded once, so that this can be called for each sample without contention.
  * @return The generated number, as a float.
  */
 static float generate_random_01()
 {
-    std::random_device random_device;
-    std::mt19937 random_engine(random_device());
+    thread_local std::mt19937 random_engine{std::random_device{}()};
     return std::generate_canonical<float, 10>(random_engine);
 }
 
@@ -236,6 +236,18 @@ template <class T, unsigned N> class Unit_Vec : public Vec<T, N>
      */
     Unit_Vec normalize() const override { return (*this); }
 
+    /**
+     * @brief Builds a unit vector from components that are already normalized, e.g. precomputed directions, without normalizing them again.
+     * @param[in] components. Normalized components.
+     * @return The unit vector.
+     */
+    static Unit_Vec from_normalized(std::array<T, N> const& components)
+    {
+        auto result = reference();
+        result.m_components = components;
+        return result;
+    }
+
     /**
      * @brief Gets a vector with the first component equal to one and all others equal to zero.
      * @return The default unit vector.
@@ -276,4 +288,17 @@ namespace math
 constexpr float z_direction_factor = -1.0f; // X right, Y top, Z forward
 static Vec3f cross(Vec3f a, Vec3f b) { return z_direction_factor * Vec3f{a.y() * b.z() - a.z() * b.y(), a.z() * b.x() - a.x() * b.z(), a.x() * b.y() - a.y() * b.x()}; }
 
+/**
+ * @brief Computes two unit vectors that form an orthonormal basis with the given unit vector.
+ * @param[in] direction. Unit vector to complete into a basis, e.g. a surface normal.
+ * @param[out] out_first_axis. First unit vector orthogonal to the given one.
+ * @param[out] out_second_axis. Second unit vector, orthogonal to the two others.
+ */
+static void compute_orthonormal_basis(Vec3f const& direction, Vec3f& out_first_axis, Vec3f& out_second_axis)
+{
+    auto const helper_axis = (std::abs(direction.x()) < 0.9f) ? Vec3f{1, 0, 0} : Vec3f{0, 1, 0};
+    out_first_axis = cross(direction, helper_axis).normalize();
+    out_second_axis = cross(direction, out_first_axis).normalize();
+}
+
 } // namespace math